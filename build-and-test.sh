@@ -12,7 +12,6 @@ else
     brew uninstall libtool
     brew install libtool
     brew install libyubikey
-    brew install json-c
     brew install asciidoc
     brew install docbook-xsl
     # this is required so asciidoc can find the xml catalog
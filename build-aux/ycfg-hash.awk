@@ -0,0 +1,132 @@
+# Copyright (c) 2026 Yubico AB
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#
+#     * Redistributions in binary form must reproduce the above
+#       copyright notice, this list of conditions and the following
+#       disclaimer in the documentation and/or other materials provided
+#       with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Generate the perfect hash of ycfg option names used by ykpers-ycfg.c
+# from the json_text column of the flag maps in ykpers_lcl.c, plus the
+# other names the ycfg import knows.
+#
+#   awk -f ycfg-hash.awk ykpers_lcl.c > ykpers-ycfg-hash.h
+#
+# The hash must match _ycfg_hash() in ykpers-ycfg.c:
+#   h = seed; for each c: h = (h + c) * 16777619 mod 2^32; slot = h >> (32 - bits)
+
+function mul32(h, m,    hi, lo) {
+	hi = int(h / 65536)
+	lo = h % 65536
+	return ((hi * m) % 65536 * 65536 + lo * m) % 4294967296
+}
+
+function hash(s, seed,    h, i) {
+	h = seed
+	for (i = 1; i <= length(s); i++)
+		h = mul32((h + ord[substr(s, i, 1)]) % 4294967296, 16777619)
+	return int(h / 2 ^ (32 - BITS))
+}
+
+function add(name, kind, pos) {
+	if (name in seen) {
+		print "ycfg-hash.awk: duplicate name " name > "/dev/stderr"
+		exit 1
+	}
+	seen[name] = 1
+	names[n] = name
+	kinds[n] = kind
+	indexes[n] = pos
+	n++
+}
+
+BEGIN {
+	BITS = 7
+	for (i = 32; i < 127; i++)
+		ord[sprintf("%c", i)] = i
+	n = 0
+	kind = ""
+}
+
+/^struct map_st _ticket_flags_map\[\]/ { kind = "YCFG_KEY_TICKET"; idx = 0; next }
+/^struct map_st _config_flags_map\[\]/ { kind = "YCFG_KEY_CONFIG"; idx = 0; next }
+/^struct map_st _extended_flags_map\[\]/ { kind = "YCFG_KEY_EXTENDED"; idx = 0; next }
+/^}/ { kind = "" }
+
+kind != "" && /^[ \t]*\{/ {
+	split($0, col, ",")
+	if (col[1] ~ /\{[ \t]*0[ \t]*$/) {
+		kind = ""
+		next
+	}
+	json = col[3]
+	gsub(/[ \t]/, "", json)
+	if (json ~ /^".*"$/)
+		add(substr(json, 2, length(json) - 2), kind, idx)
+	idx++
+}
+
+END {
+	add("yubiProdConfig", "YCFG_KEY_YUBIPRODCONFIG", 0)
+	add("mode", "YCFG_KEY_MODE", 0)
+	add("targetConfig", "YCFG_KEY_TARGETCONFIG", 0)
+	add("options", "YCFG_KEY_OPTIONS", 0)
+	add("oathDigits", "YCFG_KEY_OATHDIGITS", 0)
+	add("randomSeed", "YCFG_KEY_RANDOMSEED", 0)
+	add("fixedSeedvalue", "YCFG_KEY_FIXEDSEEDVALUE", 0)
+
+	size = 2 ^ BITS
+	for (seed = 1; seed < 1000000; seed++) {
+		split("", slot)
+		ok = 1
+		for (i = 0; i < n; i++) {
+			h = hash(names[i], seed)
+			if (h in slot) {
+				ok = 0
+				break
+			}
+			slot[h] = i
+		}
+		if (ok)
+			break
+	}
+	if (!ok) {
+		print "ycfg-hash.awk: no seed found" > "/dev/stderr"
+		exit 1
+	}
+
+	print "/* Generated from ykpers_lcl.c by ycfg-hash.awk, do not edit. */"
+	print ""
+	printf "#define YCFG_HASH_SEED\t%du\n", seed
+	printf "#define YCFG_HASH_BITS\t%d\n", BITS
+	print ""
+	print "static const struct ycfg_key _ycfg_keys[1 << YCFG_HASH_BITS] = {"
+	for (h = 0; h < size; h++) {
+		if (h in slot) {
+			i = slot[h]
+			printf "\t{ \"%s\", %d, %s, %d },\n", names[i], length(names[i]), kinds[i], indexes[i]
+		} else {
+			print "\t{ 0, 0, 0, 0 },"
+		}
+	}
+	print "};"
+}
@@ -0,0 +1,356 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* HMAC-SHA1 of many independent (key, text) pairs, a block of each
+ * hashed at the same time in the lanes of a vector register.
+ *
+ * With texts of at most one block, as for challenge-response, every
+ * HMAC is the same five compressions: the inner pad, the text in one
+ * or two padded blocks, the outer pad and the inner digest.  So the
+ * jobs go through in groups of as many as there are lanes, with one
+ * lanes call per step, and only the second text block needs a mask.
+ *
+ * With one key for all the texts, as for a window of OATH counters,
+ * the lanes start from the pad states of an HMACKeyed instead, and
+ * texts of one padded block take two compressions each.
+ */
+
+#include <string.h>
+
+#include "sha.h"
+#include "sha-private.h"
+#include "ykbzero.h"
+
+#define MAX_LANES	16
+
+typedef void (*lanes_fn)(uint32_t *H, const uint32_t *W);
+
+static const uint32_t _sha1_h0[5] = {
+	0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+};
+
+static int _lanes(lanes_fn *fn)
+{
+#ifdef HAVE_SHA_X86
+	unsigned int cpu = SHACPUFeatures();
+#endif /* HAVE_SHA_X86 */
+
+	*fn = NULL;
+#ifdef HAVE_SHA_X86
+	if (cpu & SHA_CPU_AVX512) {
+		*fn = SHA1ProcessLanesAVX512;
+		return 16;
+	}
+	if (cpu & SHA_CPU_AVX2) {
+		*fn = SHA1ProcessLanesAVX2;
+		return 8;
+	}
+	/* four lanes lose to the SHA extensions one at a time */
+	if ((cpu & SHA_CPU_SSSE3) && !(cpu & SHA_CPU_SHA)) {
+		*fn = SHA1ProcessLanesSSE2;
+		return 4;
+	}
+#endif /* HAVE_SHA_X86 */
+	return 1;
+}
+
+int hmacSHA1Lanes(void)
+{
+	lanes_fn fn;
+
+	return _lanes(&fn);
+}
+
+static uint32_t _be32(const uint8_t *p)
+{
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+		((uint32_t) p[2] << 8) | p[3];
+}
+
+/* A block of one lane into W. */
+static void _put_block(uint32_t *W, const uint8_t *block, int lane, int lanes)
+{
+	int t;
+
+	for (t = 0; t < 16; t++)
+		W[t * lanes + lane] = _be32(block + 4 * t);
+}
+
+static void _reset(uint32_t *H, int lanes)
+{
+	int i, j;
+
+	for (j = 0; j < 5; j++)
+		for (i = 0; i < lanes; i++)
+			H[j * lanes + i] = _sha1_h0[j];
+}
+
+/* Up to lanes jobs, the lanes past count hashing zeros. */
+static int _group(HMACSHA1Job *jobs, int count, lanes_fn fn, int lanes)
+{
+	uint32_t H[5 * MAX_LANES], saved[5 * MAX_LANES];
+	uint32_t W[16 * MAX_LANES];
+	uint8_t ipad[MAX_LANES][SHA1_Message_Block_Size];
+	uint8_t opad[MAX_LANES][SHA1_Message_Block_Size];
+	uint8_t text[MAX_LANES][2 * SHA1_Message_Block_Size];
+	uint8_t tk[SHA1HashSize];
+	SHA1Context ctx;
+	int two[MAX_LANES];
+	int any_two = 0;
+	int err = shaSuccess;
+	int i, j;
+
+	memset(ipad, 0, sizeof(ipad));
+	memset(opad, 0, sizeof(opad));
+	memset(text, 0, sizeof(text));
+	memset(two, 0, sizeof(two));
+
+	for (i = 0; i < count; i++) {
+		const unsigned char *key = jobs[i].key;
+		int key_len = jobs[i].key_len;
+		uint64_t bits;
+		int len = jobs[i].text_len;
+		int end;
+
+		/* keys longer than a block are hashed first */
+		if (key_len > SHA1_Message_Block_Size) {
+			err = SHA1Reset(&ctx) ||
+				SHA1Input(&ctx, key, (unsigned int) key_len) ||
+				SHA1Result(&ctx, tk);
+			if (err)
+				goto out;
+			key = tk;
+			key_len = SHA1HashSize;
+		}
+		if (key_len) {
+			memcpy(ipad[i], key, key_len);
+			memcpy(opad[i], key, key_len);
+		}
+		for (j = 0; j < SHA1_Message_Block_Size; j++) {
+			ipad[i][j] ^= 0x36;
+			opad[i][j] ^= 0x5c;
+		}
+
+		/* the text padded after the inner pad block */
+		if (len)
+			memcpy(text[i], jobs[i].text, len);
+		text[i][len] = 0x80;
+		two[i] = len + 9 > SHA1_Message_Block_Size;
+		any_two |= two[i];
+		end = two[i] ? 2 * SHA1_Message_Block_Size : SHA1_Message_Block_Size;
+		bits = (uint64_t) (SHA1_Message_Block_Size + len) * 8;
+		for (j = 1; j <= 8; j++, bits >>= 8)
+			text[i][end - j] = (uint8_t) bits;
+	}
+
+	/* inner hash */
+	_reset(H, lanes);
+	for (i = 0; i < lanes; i++)
+		_put_block(W, ipad[i], i, lanes);
+	fn(H, W);
+	for (i = 0; i < lanes; i++)
+		_put_block(W, text[i], i, lanes);
+	fn(H, W);
+	if (any_two) {
+		memcpy(saved, H, sizeof(saved));
+		for (i = 0; i < lanes; i++)
+			_put_block(W, text[i] + SHA1_Message_Block_Size, i, lanes);
+		fn(H, W);
+		for (i = 0; i < lanes; i++)
+			if (!two[i])
+				for (j = 0; j < 5; j++)
+					H[j * lanes + i] = saved[j * lanes + i];
+	}
+
+	/* the outer pad block, then the inner digest padded, which
+	 * is already in words */
+	for (j = 0; j < 5 * lanes; j++)
+		saved[j] = H[j];
+	_reset(H, lanes);
+	for (i = 0; i < lanes; i++)
+		_put_block(W, opad[i], i, lanes);
+	fn(H, W);
+	for (j = 0; j < 5 * lanes; j++)
+		W[j] = saved[j];
+	for (i = 0; i < lanes; i++) {
+		W[5 * lanes + i] = 0x80000000;
+		for (j = 6; j < 15; j++)
+			W[j * lanes + i] = 0;
+		W[15 * lanes + i] = (SHA1_Message_Block_Size + SHA1HashSize) * 8;
+	}
+	fn(H, W);
+
+	for (i = 0; i < count; i++)
+		for (j = 0; j < SHA1HashSize; j++)
+			jobs[i].digest[j] = (uint8_t)
+				(H[(j >> 2) * lanes + i] >> 8 * (3 - (j & 3)));
+
+out:
+	/* the pads, hashed keys and key states are as good as the keys */
+	insecure_memzero(ipad, sizeof(ipad));
+	insecure_memzero(opad, sizeof(opad));
+	insecure_memzero(text, sizeof(text));
+	insecure_memzero(tk, sizeof(tk));
+	insecure_memzero(&ctx, sizeof(ctx));
+	insecure_memzero(H, sizeof(H));
+	insecure_memzero(saved, sizeof(saved));
+	insecure_memzero(W, sizeof(W));
+	return err;
+}
+
+int hmacSHA1Multi(HMACSHA1Job *jobs, int n)
+{
+	lanes_fn fn;
+	int lanes = _lanes(&fn);
+	int i;
+
+	if (n < 0)
+		return shaBadParam;
+	if (n && !jobs)
+		return shaNull;
+	for (i = 0; i < n; i++) {
+		if (jobs[i].key_len < 0 || jobs[i].text_len < 0 ||
+		    jobs[i].text_len > SHA1_Message_Block_Size)
+			return shaBadParam;
+		if ((jobs[i].key_len && !jobs[i].key) ||
+		    (jobs[i].text_len && !jobs[i].text))
+			return shaNull;
+	}
+
+	for (i = 0; i < n; ) {
+		int count = n - i < lanes ? n - i : lanes;
+		int err;
+
+		/* a lone job is quicker on its own */
+		if (count == 1) {
+			uint8_t digest[USHAMaxHashSize];
+
+			err = hmac(SHA1, jobs[i].text, jobs[i].text_len,
+				   jobs[i].key, jobs[i].key_len, digest);
+			memcpy(jobs[i].digest, digest, SHA1HashSize);
+		} else
+			err = _group(jobs + i, count, fn, lanes);
+		if (err)
+			return err;
+		i += count;
+	}
+	return shaSuccess;
+}
+
+/* Up to lanes texts of one padded block with the same key. */
+static void _keyed_group(const HMACKeyed *keyed, const unsigned char *texts,
+                         int text_len, int count,
+                         uint8_t digests[][SHA1HashSize],
+                         lanes_fn fn, int lanes)
+{
+	const uint32_t *inner =
+		keyed->innerContext.ctx.sha1Context.Intermediate_Hash;
+	const uint32_t *outer =
+		keyed->outerContext.ctx.sha1Context.Intermediate_Hash;
+	uint32_t H[5 * MAX_LANES];
+	uint32_t W[16 * MAX_LANES];
+	uint8_t block[SHA1_Message_Block_Size];
+	uint64_t bits = (uint64_t) (SHA1_Message_Block_Size + text_len) * 8;
+	int i, j;
+
+	/* inner hash, the text after the inner pad block; the lanes
+	 * past count hash an empty text */
+	memset(block, 0, sizeof(block));
+	block[text_len] = 0x80;
+	for (j = 1; j <= 8; j++)
+		block[SHA1_Message_Block_Size - j] = (uint8_t) (bits >> 8 * (j - 1));
+	for (i = 0; i < lanes; i++) {
+		if (i < count && text_len)
+			memcpy(block, texts + (size_t) i * text_len, text_len);
+		else
+			memset(block, 0, text_len);
+		_put_block(W, block, i, lanes);
+	}
+	for (j = 0; j < 5; j++)
+		for (i = 0; i < lanes; i++)
+			H[j * lanes + i] = inner[j];
+	fn(H, W);
+
+	/* outer hash, the inner digest after the outer pad block */
+	for (j = 0; j < 5 * lanes; j++)
+		W[j] = H[j];
+	for (i = 0; i < lanes; i++) {
+		W[5 * lanes + i] = 0x80000000;
+		for (j = 6; j < 15; j++)
+			W[j * lanes + i] = 0;
+		W[15 * lanes + i] = (SHA1_Message_Block_Size + SHA1HashSize) * 8;
+	}
+	for (j = 0; j < 5; j++)
+		for (i = 0; i < lanes; i++)
+			H[j * lanes + i] = outer[j];
+	fn(H, W);
+
+	for (i = 0; i < count; i++)
+		for (j = 0; j < SHA1HashSize; j++)
+			digests[i][j] = (uint8_t)
+				(H[(j >> 2) * lanes + i] >> 8 * (3 - (j & 3)));
+}
+
+int hmacSHA1KeyedMulti(const HMACKeyed *keyed, const unsigned char *texts,
+                       int text_len, int n, uint8_t digests[][SHA1HashSize])
+{
+	lanes_fn fn;
+	int lanes = _lanes(&fn);
+	int i;
+
+	if (n < 0 || text_len < 0 || text_len > SHA1_Message_Block_Size - 9)
+		return shaBadParam;
+	if (!n)
+		return shaSuccess;
+	if (!keyed || !digests || (text_len && !texts))
+		return shaNull;
+	if (keyed->whichSha != SHA1)
+		return shaBadParam;
+
+	for (i = 0; i < n; ) {
+		int count = n - i < lanes ? n - i : lanes;
+
+		/* a lone text is quicker on its own */
+		if (count == 1) {
+			uint8_t digest[USHAMaxHashSize];
+			int err = hmacKeyedResult(keyed,
+						  texts + (size_t) i * text_len,
+						  text_len, digest);
+
+			if (err)
+				return err;
+			memcpy(digests[i], digest, SHA1HashSize);
+		} else
+			_keyed_group(keyed, texts + (size_t) i * text_len,
+				     text_len, count, digests + i, fn, lanes);
+		i += count;
+	}
+	return shaSuccess;
+}
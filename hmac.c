@@ -7,7 +7,9 @@
  *      various SHA algorithms.
  */
 
+#include <string.h>
 #include "sha.h"
+#include "ykbzero.h"
 
 /*
  *  hmac
@@ -230,3 +232,92 @@ int hmacResult(HMACContext *ctx, uint8_t *digest)
 
 
 
+
+/*
+ *  hmacKeyedReset
+ *
+ *  Description:
+ *      This function will hash the key pads once, keeping the SHA
+ *      states after the inner and outer pad blocks for
+ *      hmacKeyedResult() to start every message from.
+ *
+ *  Parameters:
+ *      keyed: [out]
+ *          The keyed context to fill in.
+ *      whichSha: [in]
+ *          One of SHA1, SHA224, SHA256, SHA384, SHA512
+ *      key: [in]
+ *          The secret shared key.
+ *      key_len: [in]
+ *          The length of the secret shared key.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacKeyedReset(HMACKeyed *keyed, enum SHAversion whichSha,
+    const unsigned char *key, int key_len)
+{
+  HMACContext ctx;
+  int err;
+
+  if (!keyed) return shaNull;
+
+  /* hmacReset() leaves the inner pad hashed and the outer one stored */
+  err = hmacReset(&ctx, whichSha, key, key_len) ||
+        USHAReset(&keyed->outerContext, whichSha) ||
+        USHAInput(&keyed->outerContext, ctx.k_opad, ctx.blockSize);
+  if (err == shaSuccess) {
+    keyed->whichSha = whichSha;
+    keyed->hashSize = ctx.hashSize;
+    keyed->innerContext = ctx.shaContext;
+  }
+
+  /* no copy of the key left behind */
+  insecure_memzero(&ctx, sizeof(ctx));
+  return err;
+}
+
+/*
+ *  hmacKeyedResult
+ *
+ *  Description:
+ *      This function will compute the HMAC of one message with a key
+ *      set up by hmacKeyedReset().  It works on copies of the states
+ *      kept there, so one keyed context may be used by many threads
+ *      at once, and costs the compressions of the message and of the
+ *      outer hash only.
+ *
+ *  Parameters:
+ *      keyed: [in]
+ *          The keyed context.
+ *      text: [in]
+ *          An array of characters representing the message.
+ *      text_len: [in]
+ *          The length of the message in text.
+ *      digest: [out]
+ *          Where the digest is returned.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacKeyedResult(const HMACKeyed *keyed, const unsigned char *text,
+    int text_len, uint8_t digest[USHAMaxHashSize])
+{
+  USHAContext ctx;
+  int err;
+
+  if (!keyed || !digest) return shaNull;
+
+  /* inner hash, from the state after K XOR ipad */
+  ctx = keyed->innerContext;
+  err = USHAInput(&ctx, text, text_len) ||
+        USHAResult(&ctx, digest);
+  if (err != shaSuccess) return err;
+
+  /* outer hash, from the state after K XOR opad */
+  ctx = keyed->outerContext;
+  return USHAInput(&ctx, digest, keyed->hashSize) ||
+         USHAResult(&ctx, digest);
+}
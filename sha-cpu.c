@@ -0,0 +1,141 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Runtime detection of the CPU features the SHA block functions can
+ * use, on x86 with a compiler that can build the kernels for them.
+ */
+
+#include "sha.h"
+#include "sha-private.h"
+
+#ifdef HAVE_SHA_X86
+
+#include <cpuid.h>
+
+/* leaf 1 ecx */
+#define CPUID_SSSE3	(1u << 9)
+#define CPUID_SSE41	(1u << 19)
+#define CPUID_OSXSAVE	(1u << 27)
+#define CPUID_AVX	(1u << 28)
+/* leaf 7 ebx */
+#define CPUID_AVX2	(1u << 5)
+#define CPUID_AVX512F	(1u << 16)
+#define CPUID_SHA	(1u << 29)
+#define CPUID_AVX512BW	(1u << 30)
+/* xcr0, the ymm and the opmask and zmm registers */
+#define XCR0_AVX	0x06u
+#define XCR0_AVX512	0xe6u
+
+/* features & mask, with SHA_CPU_KNOWN set once detected */
+#define SHA_CPU_KNOWN	0x80000000u
+static unsigned int _sha_cpu_found;
+static unsigned int _sha_cpu_mask = SHA_CPU_ALL;
+static unsigned int _sha_cpu;
+
+static unsigned int _sha_cpu_detect(void)
+{
+	unsigned int a, b, c, d, lo, hi;
+	unsigned int f = 0;
+
+	if (!__get_cpuid(1, &a, &b, &c, &d))
+		return 0;
+	if (c & CPUID_SSSE3)
+		f |= SHA_CPU_SSSE3;
+	if (c & CPUID_SSE41)
+		f |= SHA_CPU_SSE41;
+
+	if (__get_cpuid_max(0, 0) < 7)
+		return f;
+	/* the ymm and zmm registers need saving by the OS for AVX2
+	 * and AVX-512 */
+	if ((c & (CPUID_OSXSAVE | CPUID_AVX)) == (CPUID_OSXSAVE | CPUID_AVX)) {
+		__asm__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+		__cpuid_count(7, 0, a, b, c, d);
+		if ((lo & XCR0_AVX) == XCR0_AVX && (b & CPUID_AVX2))
+			f |= SHA_CPU_AVX2;
+		if ((lo & XCR0_AVX512) == XCR0_AVX512 &&
+		    (b & (CPUID_AVX512F | CPUID_AVX512BW)) ==
+		    (CPUID_AVX512F | CPUID_AVX512BW))
+			f |= SHA_CPU_AVX512;
+	} else {
+		__cpuid_count(7, 0, a, b, c, d);
+	}
+	if (b & CPUID_SHA)
+		f |= SHA_CPU_SHA;
+	return f;
+}
+
+static void _sha_cpu_init(void)
+{
+	unsigned int found = _sha_cpu_detect();
+
+	__atomic_store_n(&_sha_cpu_found, found | SHA_CPU_KNOWN,
+			 __ATOMIC_RELAXED);
+	found &= __atomic_load_n(&_sha_cpu_mask, __ATOMIC_RELAXED);
+	__atomic_store_n(&_sha_cpu, found | SHA_CPU_KNOWN, __ATOMIC_RELAXED);
+}
+
+/* The features to use; detection is idempotent, so racing first
+ * callers just store the same value. */
+unsigned int SHACPUFeatures(void)
+{
+	unsigned int f = __atomic_load_n(&_sha_cpu, __ATOMIC_RELAXED);
+
+	if (!(f & SHA_CPU_KNOWN)) {
+		_sha_cpu_init();
+		f = __atomic_load_n(&_sha_cpu, __ATOMIC_RELAXED);
+	}
+	return f & ~SHA_CPU_KNOWN;
+}
+
+unsigned int SHASetCPUFeatures(unsigned int mask)
+{
+	unsigned int found;
+
+	__atomic_store_n(&_sha_cpu_mask, mask, __ATOMIC_RELAXED);
+	_sha_cpu_init();
+	found = __atomic_load_n(&_sha_cpu_found, __ATOMIC_RELAXED);
+	return found & ~SHA_CPU_KNOWN;
+}
+
+#else /* !HAVE_SHA_X86 */
+
+unsigned int SHACPUFeatures(void)
+{
+	return 0;
+}
+
+unsigned int SHASetCPUFeatures(unsigned int mask)
+{
+	(void) mask;
+	return 0;
+}
+
+#endif /* HAVE_SHA_X86 */
@@ -25,5 +25,48 @@
 
 #define SHA_Parity(x, y, z)  ((x) ^ (y) ^ (z))
 
+/*
+ * Block functions, each adding n whole message blocks to the
+ * intermediate hash H.  The x86 ones are in sha1-x86.c,
+ * sha224-256-x86.c and sha384-512-x86.c, chosen by SHACPUFeatures().
+ */
+#include <stddef.h>
+extern void SHA1ProcessBlocksC(uint32_t H[5], const uint8_t *blocks,
+                               size_t n);
+extern void SHA256ProcessBlocksC(uint32_t H[8], const uint8_t *blocks,
+                                 size_t n);
+extern const uint32_t SHA224_256K[64];
+#ifndef USE_32BIT_ONLY
+extern void SHA512ProcessBlocksC(uint64_t H[8], const uint8_t *blocks,
+                                 size_t n);
+extern const uint64_t SHA384_512K[80];
+#endif /* USE_32BIT_ONLY */
+#ifdef HAVE_SHA_X86
+extern void SHA1ProcessBlocksSSSE3(uint32_t H[5], const uint8_t *blocks,
+                                   size_t n);
+extern void SHA1ProcessBlocksAVX2(uint32_t H[5], const uint8_t *blocks,
+                                  size_t n);
+extern void SHA1ProcessBlocksSHANI(uint32_t H[5], const uint8_t *blocks,
+                                   size_t n);
+/* one block in each of 4, 8 or 16 lanes, for hmac-multi.c */
+extern void SHA1ProcessLanesSSE2(uint32_t *H, const uint32_t *W);
+extern void SHA1ProcessLanesAVX2(uint32_t *H, const uint32_t *W);
+extern void SHA1ProcessLanesAVX512(uint32_t *H, const uint32_t *W);
+extern void SHA256ProcessBlocksSSSE3(uint32_t H[8], const uint8_t *blocks,
+                                     size_t n);
+extern void SHA256ProcessBlocksAVX2(uint32_t H[8], const uint8_t *blocks,
+                                    size_t n);
+extern void SHA256ProcessBlocksSHANI(uint32_t H[8], const uint8_t *blocks,
+                                     size_t n);
+#ifndef USE_32BIT_ONLY
+extern void SHA512ProcessBlocksSSSE3(uint64_t H[8], const uint8_t *blocks,
+                                     size_t n);
+extern void SHA512ProcessBlocksAVX2(uint64_t H[8], const uint8_t *blocks,
+                                    size_t n);
+extern void SHA512ProcessBlocksAVX512(uint64_t H[8], const uint8_t *blocks,
+                                      size_t n);
+#endif /* USE_32BIT_ONLY */
+#endif /* HAVE_SHA_X86 */
+
 #endif /* _SHA_PRIVATE__H */
 
@@ -170,6 +170,18 @@ typedef struct HMACContext {
                         /* outer padding - key XORd with opad */
 } HMACContext;
 
+/*
+ *  This structure will hold an HMAC key with its pads already
+ *  hashed, see hmacKeyedReset().  It is only read when computing,
+ *  so it may be shared between threads.
+ */
+typedef struct HMACKeyed {
+    int whichSha;               /* which SHA is being used */
+    int hashSize;               /* hash size of SHA being used */
+    USHAContext innerContext;   /* SHA context after K XOR ipad */
+    USHAContext outerContext;   /* SHA context after K XOR opad */
+} HMACKeyed;
+
 /*
  *  Function Prototypes
  */
@@ -258,4 +270,56 @@ extern int hmacFinalBits(HMACContext *ctx, const uint8_t bits,
 extern int hmacResult(HMACContext *ctx,
                       uint8_t digest[USHAMaxHashSize]);
 
+/*
+ * HMAC Keyed-Hashing for Message Authentication, RFC2104,
+ * for all SHAs.
+ * This interface hashes the key once for any number of messages.
+ */
+extern int hmacKeyedReset(HMACKeyed *keyed, enum SHAversion whichSha,
+                          const unsigned char *key, int key_len);
+extern int hmacKeyedResult(const HMACKeyed *keyed,
+                           const unsigned char *text, int text_len,
+                           uint8_t digest[USHAMaxHashSize]);
+
+/*
+ * HMAC-SHA1 of many independent (key, text) pairs with texts of at
+ * most one block, as for challenge-response, computed 4, 8 or 16 at
+ * a time in SIMD lanes where the CPU has them, see hmac-multi.c.
+ * hmacSHA1Lanes() tells how many, 1 meaning one at a time.
+ */
+typedef struct HMACSHA1Job {
+    const unsigned char *key;           /* authentication key */
+    int key_len;                        /* length of the key */
+    const unsigned char *text;          /* up to 64 octets */
+    int text_len;                       /* length of the text */
+    uint8_t digest[SHA1HashSize];       /* HMAC computed */
+} HMACSHA1Job;
+
+extern int hmacSHA1Multi(HMACSHA1Job *jobs, int n);
+extern int hmacSHA1Lanes(void);
+
+/*
+ * HMAC-SHA1 with one keyed context of n texts of text_len octets each,
+ * laid out one after the other, into digests.  Texts of at most 55
+ * octets, one block once padded, take two compressions each, in SIMD
+ * lanes as above.
+ */
+extern int hmacSHA1KeyedMulti(const HMACKeyed *keyed,
+                              const unsigned char *texts, int text_len,
+                              int n, uint8_t digests[][SHA1HashSize]);
+
+/*
+ * CPU features the block functions may use, see sha-cpu.c.
+ * SHASetCPUFeatures() limits them to those in mask, for testing
+ * the fallbacks, and returns all the features found.
+ */
+#define SHA_CPU_SSSE3   0x01
+#define SHA_CPU_SSE41   0x02
+#define SHA_CPU_AVX2    0x04
+#define SHA_CPU_SHA     0x08
+#define SHA_CPU_AVX512  0x10            /* AVX-512 F and BW */
+#define SHA_CPU_ALL     0x1f
+extern unsigned int SHACPUFeatures(void);
+extern unsigned int SHASetCPUFeatures(unsigned int mask);
+
 #endif /* _SHA_H_ */
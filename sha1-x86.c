@@ -0,0 +1,396 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* SHA-1 block functions for x86, chosen at runtime by sha1.c.
+ *
+ * The SSSE3 and AVX2 ones compute the message schedule with W + K four
+ * words at a time, for one block or for two blocks side by side, and
+ * leave the rounds to the integer unit.  The SHA one runs the whole
+ * block on the SHA extensions.
+ *
+ * The lanes functions at the end hash one block of each of 4, 8 or 16
+ * independent messages, for hmacSHA1Multi().
+ */
+
+#include "sha.h"
+#include "sha-private.h"
+
+#ifdef HAVE_SHA_X86
+
+#include <immintrin.h>
+
+#define ALWAYS_INLINE	__attribute__((always_inline)) inline
+
+#define SHA1_ROTL(bits, word) \
+	(((word) << (bits)) | ((word) >> (32 - (bits))))
+
+#define SHA1_K0		0x5A827999
+#define SHA1_K1		0x6ED9EBA1
+#define SHA1_K2		0x8F1BBCDC
+#define SHA1_K3		0xCA62C1D6
+
+#define SHA1_STEP(f, a, b, c, d, e, wk) do {				\
+		e += SHA1_ROTL(5, a) + f(b, c, d) + (wk);		\
+		b = SHA1_ROTL(30, b);					\
+	} while (0)
+
+/* The 80 rounds with a precomputed W + K, five at a time so that the
+ * variables rotate by renaming. */
+static ALWAYS_INLINE void _sha1_rounds(uint32_t H[5], const uint32_t *wk)
+{
+	uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4];
+	int t;
+
+	for (t = 0; t < 20; t += 5) {
+		SHA1_STEP(SHA_Ch, a, b, c, d, e, wk[t]);
+		SHA1_STEP(SHA_Ch, e, a, b, c, d, wk[t + 1]);
+		SHA1_STEP(SHA_Ch, d, e, a, b, c, wk[t + 2]);
+		SHA1_STEP(SHA_Ch, c, d, e, a, b, wk[t + 3]);
+		SHA1_STEP(SHA_Ch, b, c, d, e, a, wk[t + 4]);
+	}
+	for (; t < 40; t += 5) {
+		SHA1_STEP(SHA_Parity, a, b, c, d, e, wk[t]);
+		SHA1_STEP(SHA_Parity, e, a, b, c, d, wk[t + 1]);
+		SHA1_STEP(SHA_Parity, d, e, a, b, c, wk[t + 2]);
+		SHA1_STEP(SHA_Parity, c, d, e, a, b, wk[t + 3]);
+		SHA1_STEP(SHA_Parity, b, c, d, e, a, wk[t + 4]);
+	}
+	for (; t < 60; t += 5) {
+		SHA1_STEP(SHA_Maj, a, b, c, d, e, wk[t]);
+		SHA1_STEP(SHA_Maj, e, a, b, c, d, wk[t + 1]);
+		SHA1_STEP(SHA_Maj, d, e, a, b, c, wk[t + 2]);
+		SHA1_STEP(SHA_Maj, c, d, e, a, b, wk[t + 3]);
+		SHA1_STEP(SHA_Maj, b, c, d, e, a, wk[t + 4]);
+	}
+	for (; t < 80; t += 5) {
+		SHA1_STEP(SHA_Parity, a, b, c, d, e, wk[t]);
+		SHA1_STEP(SHA_Parity, e, a, b, c, d, wk[t + 1]);
+		SHA1_STEP(SHA_Parity, d, e, a, b, c, wk[t + 2]);
+		SHA1_STEP(SHA_Parity, c, d, e, a, b, wk[t + 3]);
+		SHA1_STEP(SHA_Parity, b, c, d, e, a, wk[t + 4]);
+	}
+
+	H[0] += a;
+	H[1] += b;
+	H[2] += c;
+	H[3] += d;
+	H[4] += e;
+}
+
+/* W[t..t+3] from the four groups before it.  W[t+3] needs W[t], so it
+ * is computed without it first and then fixed up. */
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+__m128i _sha1_next_ssse3(__m128i w1, __m128i w2, __m128i w3, __m128i w4)
+{
+	__m128i x, t;
+
+	x = _mm_xor_si128(_mm_xor_si128(_mm_srli_si128(w1, 4), w2),
+			  _mm_xor_si128(_mm_alignr_epi8(w3, w4, 8), w4));
+	x = _mm_or_si128(_mm_slli_epi32(x, 1), _mm_srli_epi32(x, 31));
+	t = _mm_slli_si128(x, 12);
+	return _mm_xor_si128(x, _mm_or_si128(_mm_slli_epi32(t, 1),
+					     _mm_srli_epi32(t, 31)));
+}
+
+/* The same for two blocks, one in each 128 bit lane. */
+static ALWAYS_INLINE __attribute__((target("avx2")))
+__m256i _sha1_next_avx2(__m256i w1, __m256i w2, __m256i w3, __m256i w4)
+{
+	__m256i x, t;
+
+	x = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_si256(w1, 4), w2),
+			     _mm256_xor_si256(_mm256_alignr_epi8(w3, w4, 8), w4));
+	x = _mm256_or_si256(_mm256_slli_epi32(x, 1), _mm256_srli_epi32(x, 31));
+	t = _mm256_slli_si256(x, 12);
+	return _mm256_xor_si256(x, _mm256_or_si256(_mm256_slli_epi32(t, 1),
+						   _mm256_srli_epi32(t, 31)));
+}
+
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+void _sha1_schedule_ssse3(const uint8_t *block, uint32_t *wk)
+{
+	const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					   4, 5, 6, 7, 0, 1, 2, 3);
+	const uint32_t k[4] = { SHA1_K0, SHA1_K1, SHA1_K2, SHA1_K3 };
+	__m128i w[20];
+	int j;
+
+	for (j = 0; j < 4; j++) {
+		w[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+							(block + 16 * j)), bswap);
+		_mm_storeu_si128((__m128i *)(wk + 4 * j),
+				 _mm_add_epi32(w[j], _mm_set1_epi32(k[0])));
+	}
+	for (j = 4; j < 20; j++) {
+		w[j] = _sha1_next_ssse3(w[j - 1], w[j - 2], w[j - 3], w[j - 4]);
+		_mm_storeu_si128((__m128i *)(wk + 4 * j),
+				 _mm_add_epi32(w[j], _mm_set1_epi32(k[j / 5])));
+	}
+}
+
+__attribute__((target("ssse3")))
+void SHA1ProcessBlocksSSSE3(uint32_t H[5], const uint8_t *blocks, size_t n)
+{
+	uint32_t wk[80];
+
+	for (; n > 0; n--, blocks += SHA1_Message_Block_Size) {
+		_sha1_schedule_ssse3(blocks, wk);
+		_sha1_rounds(H, wk);
+	}
+}
+
+/* Two blocks at a time, one in each 128 bit lane. */
+__attribute__((target("avx2")))
+void SHA1ProcessBlocksAVX2(uint32_t H[5], const uint8_t *blocks, size_t n)
+{
+	const __m256i bswap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					      4, 5, 6, 7, 0, 1, 2, 3,
+					      12, 13, 14, 15, 8, 9, 10, 11,
+					      4, 5, 6, 7, 0, 1, 2, 3);
+	const uint32_t k[4] = { SHA1_K0, SHA1_K1, SHA1_K2, SHA1_K3 };
+	uint32_t wk[2][80];
+	__m256i w[20];
+	int j;
+
+	for (; n >= 2; n -= 2, blocks += 2 * SHA1_Message_Block_Size) {
+		for (j = 0; j < 20; j++) {
+			__m256i v;
+
+			if (j < 4) {
+				const uint8_t *p = blocks + 16 * j;
+
+				w[j] = _mm256_shuffle_epi8(_mm256_inserti128_si256(
+					_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) p)),
+					_mm_loadu_si128((const __m128i *)(p + SHA1_Message_Block_Size)), 1),
+					bswap);
+			} else {
+				w[j] = _sha1_next_avx2(w[j - 1], w[j - 2],
+						       w[j - 3], w[j - 4]);
+			}
+			v = _mm256_add_epi32(w[j], _mm256_set1_epi32(k[j / 5]));
+			_mm_storeu_si128((__m128i *)(wk[0] + 4 * j),
+					 _mm256_castsi256_si128(v));
+			_mm_storeu_si128((__m128i *)(wk[1] + 4 * j),
+					 _mm256_extracti128_si256(v, 1));
+		}
+		_sha1_rounds(H, wk[0]);
+		_sha1_rounds(H, wk[1]);
+	}
+	if (n) {
+		_sha1_schedule_ssse3(blocks, wk[0]);
+		_sha1_rounds(H, wk[0]);
+	}
+}
+
+/* Four rounds on the SHA extensions, the message schedule of group g
+ * computed from the four groups before it in the same registers. */
+#define SHANI_SCHEDULE(g)						\
+	m[(g) & 3] = _mm_sha1msg2_epu32(_mm_xor_si128(			\
+		_mm_sha1msg1_epu32(m[(g) & 3], m[((g) - 3) & 3]),	\
+		m[((g) - 2) & 3]), m[((g) - 1) & 3])
+#define SHANI_ROUNDS(g) do {						\
+		e = _mm_sha1nexte_epu32(prev, m[(g) & 3]);		\
+		prev = abcd;						\
+		abcd = _mm_sha1rnds4_epu32(abcd, e, (g) / 5);		\
+	} while (0)
+#define SHANI_ROUNDS_S(g) do {						\
+		SHANI_SCHEDULE(g);					\
+		SHANI_ROUNDS(g);					\
+	} while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void SHA1ProcessBlocksSHANI(uint32_t H[5], const uint8_t *blocks, size_t n)
+{
+	/* whole register byte reversal: A ends up in the top lane */
+	const __m128i bswap = _mm_set_epi64x(0x0001020304050607ULL,
+					     0x08090a0b0c0d0e0fULL);
+	__m128i abcd, abcd_save, e0, e, prev;
+	__m128i m[4];
+	int j;
+
+	abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) H), 0x1b);
+	e0 = _mm_set_epi32((int) H[4], 0, 0, 0);
+
+	for (; n > 0; n--, blocks += SHA1_Message_Block_Size) {
+		abcd_save = abcd;
+		for (j = 0; j < 4; j++)
+			m[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+								(blocks + 16 * j)), bswap);
+
+		e = _mm_add_epi32(e0, m[0]);
+		prev = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+		SHANI_ROUNDS(1);
+		SHANI_ROUNDS(2);
+		SHANI_ROUNDS(3);
+		SHANI_ROUNDS_S(4);
+		SHANI_ROUNDS_S(5);
+		SHANI_ROUNDS_S(6);
+		SHANI_ROUNDS_S(7);
+		SHANI_ROUNDS_S(8);
+		SHANI_ROUNDS_S(9);
+		SHANI_ROUNDS_S(10);
+		SHANI_ROUNDS_S(11);
+		SHANI_ROUNDS_S(12);
+		SHANI_ROUNDS_S(13);
+		SHANI_ROUNDS_S(14);
+		SHANI_ROUNDS_S(15);
+		SHANI_ROUNDS_S(16);
+		SHANI_ROUNDS_S(17);
+		SHANI_ROUNDS_S(18);
+		SHANI_ROUNDS_S(19);
+
+		/* E of the next block is A of round 76, rotated, plus E */
+		e0 = _mm_sha1nexte_epu32(prev, e0);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	_mm_storeu_si128((__m128i *) H, _mm_shuffle_epi32(abcd, 0x1b));
+	H[4] = (uint32_t) _mm_extract_epi32(e0, 3);
+}
+
+/*
+ * One block of each of L messages, message i in lane i of every vector.
+ * H has H[0] of each lane, then H[1] and so on, and W the words of the
+ * blocks the same way, already in host order.  The V_ operations are
+ * defined for each vector size before use.
+ */
+#define LANES_STEP(F, k) do {						\
+		if (t < 16)						\
+			w[t] = V_LOAD(W + t * lanes);			\
+		else							\
+			w[t & 15] = V_ROL(V_XOR(V_XOR(w[(t - 3) & 15],	\
+						      w[(t - 8) & 15]),	\
+						V_XOR(w[(t - 14) & 15],	\
+						      w[t & 15])), 1);	\
+		x = V_ADD(V_ADD(V_ROL(a, 5), F(b, c, d)),		\
+			  V_ADD(V_ADD(e, k), w[t & 15]));		\
+		e = d;							\
+		d = c;							\
+		c = V_ROL(b, 30);					\
+		b = a;							\
+		a = x;							\
+	} while (0)
+
+#define LANES_CH(b, c, d)	V_XOR(V_AND(b, c), V_ANDNOT(b, d))
+#define LANES_PARITY(b, c, d)	V_XOR(V_XOR(b, c), d)
+#define LANES_MAJ(b, c, d)	V_OR(V_AND(b, c), V_AND(d, V_OR(b, c)))
+
+#define SHA1_LANES(V, L) do {						\
+		const int lanes = (L);					\
+		V a = V_LOAD(H), b = V_LOAD(H + lanes);			\
+		V c = V_LOAD(H + 2 * lanes), d = V_LOAD(H + 3 * lanes);	\
+		V e = V_LOAD(H + 4 * lanes);				\
+		V w[16], x;						\
+		int t;							\
+									\
+		for (t = 0; t < 20; t++)				\
+			LANES_STEP(LANES_CH, V_SET1(SHA1_K0));		\
+		for (; t < 40; t++)					\
+			LANES_STEP(LANES_PARITY, V_SET1(SHA1_K1));	\
+		for (; t < 60; t++)					\
+			LANES_STEP(LANES_MAJ, V_SET1(SHA1_K2));		\
+		for (; t < 80; t++)					\
+			LANES_STEP(LANES_PARITY, V_SET1(SHA1_K3));	\
+									\
+		V_STORE(H, V_ADD(V_LOAD(H), a));			\
+		V_STORE(H + lanes, V_ADD(V_LOAD(H + lanes), b));	\
+		V_STORE(H + 2 * lanes, V_ADD(V_LOAD(H + 2 * lanes), c)); \
+		V_STORE(H + 3 * lanes, V_ADD(V_LOAD(H + 3 * lanes), d)); \
+		V_STORE(H + 4 * lanes, V_ADD(V_LOAD(H + 4 * lanes), e)); \
+	} while (0)
+
+#define V_LOAD(p)	_mm_loadu_si128((const __m128i *)(p))
+#define V_STORE(p, v)	_mm_storeu_si128((__m128i *)(p), v)
+#define V_ADD		_mm_add_epi32
+#define V_XOR		_mm_xor_si128
+#define V_AND		_mm_and_si128
+#define V_ANDNOT	_mm_andnot_si128
+#define V_OR		_mm_or_si128
+#define V_ROL(v, n)	_mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+#define V_SET1(k)	_mm_set1_epi32((int) (k))
+
+__attribute__((target("sse2")))
+void SHA1ProcessLanesSSE2(uint32_t *H, const uint32_t *W)
+{
+	SHA1_LANES(__m128i, 4);
+}
+
+#undef V_LOAD
+#undef V_STORE
+#undef V_ADD
+#undef V_XOR
+#undef V_AND
+#undef V_ANDNOT
+#undef V_OR
+#undef V_ROL
+#undef V_SET1
+#define V_LOAD(p)	_mm256_loadu_si256((const __m256i *)(p))
+#define V_STORE(p, v)	_mm256_storeu_si256((__m256i *)(p), v)
+#define V_ADD		_mm256_add_epi32
+#define V_XOR		_mm256_xor_si256
+#define V_AND		_mm256_and_si256
+#define V_ANDNOT	_mm256_andnot_si256
+#define V_OR		_mm256_or_si256
+#define V_ROL(v, n)	_mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+#define V_SET1(k)	_mm256_set1_epi32((int) (k))
+
+__attribute__((target("avx2")))
+void SHA1ProcessLanesAVX2(uint32_t *H, const uint32_t *W)
+{
+	SHA1_LANES(__m256i, 8);
+}
+
+#undef V_LOAD
+#undef V_STORE
+#undef V_ADD
+#undef V_XOR
+#undef V_AND
+#undef V_ANDNOT
+#undef V_OR
+#undef V_ROL
+#undef V_SET1
+#define V_LOAD(p)	_mm512_loadu_si512(p)
+#define V_STORE(p, v)	_mm512_storeu_si512(p, v)
+#define V_ADD		_mm512_add_epi32
+#define V_XOR		_mm512_xor_si512
+#define V_AND		_mm512_and_si512
+#define V_ANDNOT	_mm512_andnot_si512
+#define V_OR		_mm512_or_si512
+#define V_ROL		_mm512_rol_epi32
+#define V_SET1(k)	_mm512_set1_epi32((int) (k))
+
+__attribute__((target("avx512f")))
+void SHA1ProcessLanesAVX512(uint32_t *H, const uint32_t *W)
+{
+	SHA1_LANES(__m512i, 16);
+}
+
+#endif /* HAVE_SHA_X86 */
@@ -35,6 +35,8 @@
  *      uses SHA1FinalBits() to hash the final few bits of the input.
  */
 
+#include <string.h>
+
 #include "sha.h"
 #include "sha-private.h"
 
@@ -45,19 +47,27 @@
                 (((word) << (bits)) | ((word) >> (32-(bits))))
 
 /*
- * add "length" to the length
+ * add "length" bits to the length, the context is corrupted
+ * once it no longer fits in 64 bits
  */
-static uint32_t addTemp;
-#define SHA1AddLength(context, length)                     \
-    (addTemp = (context)->Length_Low,                      \
-     (context)->Corrupted =                                \
-        (((context)->Length_Low += (length)) < addTemp) && \
-        (++(context)->Length_High == 0) ? 1 : 0)
+static int SHA1AddLength(SHA1Context *context, uint64_t length)
+{
+  uint64_t total = ((uint64_t)context->Length_High << 32) |
+                   context->Length_Low;
+
+  total += length;
+  context->Length_Low = (uint32_t) total;
+  context->Length_High = (uint32_t) (total >> 32);
+  context->Corrupted = (total < length) ? 1 : 0;
+  return context->Corrupted;
+}
 
 /* Local Function Prototypes */
 static void SHA1Finalize(SHA1Context *context, uint8_t Pad_Byte);
 static void SHA1PadMessage(SHA1Context *, uint8_t Pad_Byte);
 static void SHA1ProcessMessageBlock(SHA1Context *);
+static void SHA1ProcessBlocks(uint32_t H[5], const uint8_t *blocks,
+    size_t n);
 
 /*
  *  SHA1Reset
@@ -133,17 +143,39 @@ int SHA1Input(SHA1Context *context,
   if (context->Corrupted)
      return context->Corrupted;
 
-  while (length-- && !context->Corrupted) {
-    context->Message_Block[context->Message_Block_Index++] =
-      (*message_array & 0xFF);
+  if (SHA1AddLength(context, (uint64_t)length * 8))
+    return shaSuccess;
+
+  /* top up a partly filled block first */
+  if (context->Message_Block_Index) {
+    unsigned fill = SHA1_Message_Block_Size -
+                    context->Message_Block_Index;
+
+    if (fill > length)
+      fill = length;
+    memcpy(context->Message_Block + context->Message_Block_Index,
+           message_array, fill);
+    context->Message_Block_Index += fill;
+    message_array += fill;
+    length -= fill;
+
+    if (context->Message_Block_Index < SHA1_Message_Block_Size)
+      return shaSuccess;
+    SHA1ProcessMessageBlock(context);
+  }
 
-    if (!SHA1AddLength(context, 8) &&
-      (context->Message_Block_Index == SHA1_Message_Block_Size))
-      SHA1ProcessMessageBlock(context);
+  /* whole blocks straight from the message */
+  if (length >= SHA1_Message_Block_Size) {
+    size_t n = length / SHA1_Message_Block_Size;
 
-    message_array++;
+    SHA1ProcessBlocks(context->Intermediate_Hash, message_array, n);
+    message_array += n * SHA1_Message_Block_Size;
+    length -= n * SHA1_Message_Block_Size;
   }
 
+  memcpy(context->Message_Block, message_array, length);
+  context->Message_Block_Index = (int_least16_t) length;
+
   return shaSuccess;
 }
 
@@ -345,13 +377,51 @@ static void SHA1PadMessage(SHA1Context *context, uint8_t Pad_Byte)
  *
  * Returns:
  *   Nothing.
+ */
+static void SHA1ProcessMessageBlock(SHA1Context *context)
+{
+  SHA1ProcessBlocks(context->Intermediate_Hash, context->Message_Block, 1);
+  context->Message_Block_Index = 0;
+}
+
+/*
+ * SHA1ProcessBlocks
+ *
+ * Description:
+ *   This helper function will process n blocks of 512 bits with
+ *   the fastest block function the CPU has, see SHACPUFeatures().
+ */
+static void SHA1ProcessBlocks(uint32_t H[5], const uint8_t *blocks,
+    size_t n)
+{
+#ifdef HAVE_SHA_X86
+  unsigned int cpu = SHACPUFeatures();
+
+  if ((cpu & (SHA_CPU_SHA | SHA_CPU_SSE41 | SHA_CPU_SSSE3)) ==
+      (SHA_CPU_SHA | SHA_CPU_SSE41 | SHA_CPU_SSSE3))
+    SHA1ProcessBlocksSHANI(H, blocks, n);
+  else if (cpu & SHA_CPU_AVX2)
+    SHA1ProcessBlocksAVX2(H, blocks, n);
+  else if (cpu & SHA_CPU_SSSE3)
+    SHA1ProcessBlocksSSSE3(H, blocks, n);
+  else
+#endif /* HAVE_SHA_X86 */
+    SHA1ProcessBlocksC(H, blocks, n);
+}
+
+/*
+ * SHA1ProcessBlocksC
+ *
+ * Description:
+ *   This is the portable block function, processing n blocks of
+ *   512 bits into the intermediate hash H.
  *
  * Comments:
  *   Many of the variable names in this code, especially the
  *   single character names, were used because those were the
  *   names used in the publication.
  */
-static void SHA1ProcessMessageBlock(SHA1Context *context)
+void SHA1ProcessBlocksC(uint32_t H[5], const uint8_t *blocks, size_t n)
 {
   /* Constants defined in FIPS-180-2, section 4.2.1 */
   const uint32_t K[4] = {
@@ -362,66 +432,65 @@ static void SHA1ProcessMessageBlock(SHA1Context *context)
   uint32_t   W[80];           /* Word sequence */
   uint32_t   A, B, C, D, E;   /* Word buffers */
 
-  /*
-   * Initialize the first 16 words in the array W
-   */
-  for (t = 0; t < 16; t++) {
-    W[t]  = ((uint32_t)context->Message_Block[t * 4]) << 24;
-    W[t] |= ((uint32_t)context->Message_Block[t * 4 + 1]) << 16;
-    W[t] |= ((uint32_t)context->Message_Block[t * 4 + 2]) << 8;
-    W[t] |= ((uint32_t)context->Message_Block[t * 4 + 3]);
+  for (; n > 0; n--, blocks += SHA1_Message_Block_Size) {
+    /*
+     * Initialize the first 16 words in the array W
+     */
+    for (t = 0; t < 16; t++) {
+      W[t]  = ((uint32_t)blocks[t * 4]) << 24;
+      W[t] |= ((uint32_t)blocks[t * 4 + 1]) << 16;
+      W[t] |= ((uint32_t)blocks[t * 4 + 2]) << 8;
+      W[t] |= ((uint32_t)blocks[t * 4 + 3]);
+    }
+    for (t = 16; t < 80; t++)
+      W[t] = SHA1_ROTL(1, W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16]);
+
+    A = H[0];
+    B = H[1];
+    C = H[2];
+    D = H[3];
+    E = H[4];
+
+    for (t = 0; t < 20; t++) {
+      temp = SHA1_ROTL(5,A) + SHA_Ch(B, C, D) + E + W[t] + K[0];
+      E = D;
+      D = C;
+      C = SHA1_ROTL(30,B);
+      B = A;
+      A = temp;
+    }
+
+    for (t = 20; t < 40; t++) {
+      temp = SHA1_ROTL(5,A) + SHA_Parity(B, C, D) + E + W[t] + K[1];
+      E = D;
+      D = C;
+      C = SHA1_ROTL(30,B);
+      B = A;
+      A = temp;
+    }
+
+    for (t = 40; t < 60; t++) {
+      temp = SHA1_ROTL(5,A) + SHA_Maj(B, C, D) + E + W[t] + K[2];
+      E = D;
+      D = C;
+      C = SHA1_ROTL(30,B);
+      B = A;
+      A = temp;
+    }
+
+    for (t = 60; t < 80; t++) {
+      temp = SHA1_ROTL(5,A) + SHA_Parity(B, C, D) + E + W[t] + K[3];
+      E = D;
+      D = C;
+      C = SHA1_ROTL(30,B);
+      B = A;
+      A = temp;
+    }
+
+    H[0] += A;
+    H[1] += B;
+    H[2] += C;
+    H[3] += D;
+    H[4] += E;
   }
-  for (t = 16; t < 80; t++)
-    W[t] = SHA1_ROTL(1, W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16]);
-
-  A = context->Intermediate_Hash[0];
-  B = context->Intermediate_Hash[1];
-  C = context->Intermediate_Hash[2];
-  D = context->Intermediate_Hash[3];
-  E = context->Intermediate_Hash[4];
-
-  for (t = 0; t < 20; t++) {
-    temp = SHA1_ROTL(5,A) + SHA_Ch(B, C, D) + E + W[t] + K[0];
-    E = D;
-    D = C;
-    C = SHA1_ROTL(30,B);
-    B = A;
-    A = temp;
-  }
-
-  for (t = 20; t < 40; t++) {
-    temp = SHA1_ROTL(5,A) + SHA_Parity(B, C, D) + E + W[t] + K[1];
-    E = D;
-    D = C;
-    C = SHA1_ROTL(30,B);
-    B = A;
-    A = temp;
-  }
-
-  for (t = 40; t < 60; t++) {
-    temp = SHA1_ROTL(5,A) + SHA_Maj(B, C, D) + E + W[t] + K[2];
-    E = D;
-    D = C;
-    C = SHA1_ROTL(30,B);
-    B = A;
-    A = temp;
-  }
-
-  for (t = 60; t < 80; t++) {
-    temp = SHA1_ROTL(5,A) + SHA_Parity(B, C, D) + E + W[t] + K[3];
-    E = D;
-    D = C;
-    C = SHA1_ROTL(30,B);
-    B = A;
-    A = temp;
-  }
-
-  context->Intermediate_Hash[0] += A;
-  context->Intermediate_Hash[1] += B;
-  context->Intermediate_Hash[2] += C;
-  context->Intermediate_Hash[3] += D;
-  context->Intermediate_Hash[4] += E;
-
-  context->Message_Block_Index = 0;
 }
-
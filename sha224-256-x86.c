@@ -0,0 +1,301 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* SHA-224/256 block functions for x86, chosen at runtime by
+ * sha224-256.c.
+ *
+ * As for SHA-1, the SSSE3 and AVX2 ones compute the message schedule
+ * with W + K four words at a time, for one block or for two blocks
+ * side by side, and the SHA one runs the whole block on the SHA
+ * extensions.
+ */
+
+#include "sha.h"
+#include "sha-private.h"
+
+#ifdef HAVE_SHA_X86
+
+#include <immintrin.h>
+
+#define ALWAYS_INLINE	__attribute__((always_inline)) inline
+
+#define ROTR(bits, word) \
+	(((word) >> (bits)) | ((word) << (32 - (bits))))
+#define SIGMA0(w)	(ROTR(2, w) ^ ROTR(13, w) ^ ROTR(22, w))
+#define SIGMA1(w)	(ROTR(6, w) ^ ROTR(11, w) ^ ROTR(25, w))
+
+#define SHA256_STEP(a, b, c, d, e, f, g, h, wk) do {			\
+		uint32_t _t = h + SIGMA1(e) + SHA_Ch(e, f, g) + (wk);	\
+		d += _t;						\
+		h = _t + SIGMA0(a) + SHA_Maj(a, b, c);			\
+	} while (0)
+
+/* The 64 rounds with a precomputed W + K, eight at a time so that the
+ * variables rotate by renaming. */
+static ALWAYS_INLINE void _sha256_rounds(uint32_t H[8], const uint32_t *wk)
+{
+	uint32_t a = H[0], b = H[1], c = H[2], d = H[3];
+	uint32_t e = H[4], f = H[5], g = H[6], h = H[7];
+	int t;
+
+	for (t = 0; t < 64; t += 8) {
+		SHA256_STEP(a, b, c, d, e, f, g, h, wk[t]);
+		SHA256_STEP(h, a, b, c, d, e, f, g, wk[t + 1]);
+		SHA256_STEP(g, h, a, b, c, d, e, f, wk[t + 2]);
+		SHA256_STEP(f, g, h, a, b, c, d, e, wk[t + 3]);
+		SHA256_STEP(e, f, g, h, a, b, c, d, wk[t + 4]);
+		SHA256_STEP(d, e, f, g, h, a, b, c, wk[t + 5]);
+		SHA256_STEP(c, d, e, f, g, h, a, b, wk[t + 6]);
+		SHA256_STEP(b, c, d, e, f, g, h, a, wk[t + 7]);
+	}
+
+	H[0] += a;
+	H[1] += b;
+	H[2] += c;
+	H[3] += d;
+	H[4] += e;
+	H[5] += f;
+	H[6] += g;
+	H[7] += h;
+}
+
+#define VROTR(x, n, srl, sll, or) or(srl(x, n), sll(x, 32 - (n)))
+
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+__m128i _sha256_sigma0_ssse3(__m128i x)
+{
+	return _mm_xor_si128(_mm_xor_si128(
+		VROTR(x, 7, _mm_srli_epi32, _mm_slli_epi32, _mm_or_si128),
+		VROTR(x, 18, _mm_srli_epi32, _mm_slli_epi32, _mm_or_si128)),
+		_mm_srli_epi32(x, 3));
+}
+
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+__m128i _sha256_sigma1_ssse3(__m128i x)
+{
+	return _mm_xor_si128(_mm_xor_si128(
+		VROTR(x, 17, _mm_srli_epi32, _mm_slli_epi32, _mm_or_si128),
+		VROTR(x, 19, _mm_srli_epi32, _mm_slli_epi32, _mm_or_si128)),
+		_mm_srli_epi32(x, 10));
+}
+
+/* W[t..t+3] from the four groups before it.  W[t+2] and W[t+3] need
+ * W[t] and W[t+1], so sigma1 is added for the low half first. */
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+__m128i _sha256_next_ssse3(__m128i w1, __m128i w2, __m128i w3, __m128i w4)
+{
+	__m128i x, s;
+
+	x = _mm_add_epi32(_mm_add_epi32(w4, _mm_alignr_epi8(w1, w2, 4)),
+			  _sha256_sigma0_ssse3(_mm_alignr_epi8(w3, w4, 4)));
+	/* sigma1(W[t-2]), sigma1(W[t-1]) in the low half */
+	s = _sha256_sigma1_ssse3(_mm_shuffle_epi32(w1, 0xfe));
+	x = _mm_add_epi32(x, _mm_move_epi64(s));
+	/* sigma1(W[t]), sigma1(W[t+1]) in the high half */
+	s = _sha256_sigma1_ssse3(x);
+	return _mm_add_epi32(x, _mm_slli_si128(s, 8));
+}
+
+static ALWAYS_INLINE __attribute__((target("avx2")))
+__m256i _sha256_sigma0_avx2(__m256i x)
+{
+	return _mm256_xor_si256(_mm256_xor_si256(
+		VROTR(x, 7, _mm256_srli_epi32, _mm256_slli_epi32, _mm256_or_si256),
+		VROTR(x, 18, _mm256_srli_epi32, _mm256_slli_epi32, _mm256_or_si256)),
+		_mm256_srli_epi32(x, 3));
+}
+
+static ALWAYS_INLINE __attribute__((target("avx2")))
+__m256i _sha256_sigma1_avx2(__m256i x)
+{
+	return _mm256_xor_si256(_mm256_xor_si256(
+		VROTR(x, 17, _mm256_srli_epi32, _mm256_slli_epi32, _mm256_or_si256),
+		VROTR(x, 19, _mm256_srli_epi32, _mm256_slli_epi32, _mm256_or_si256)),
+		_mm256_srli_epi32(x, 10));
+}
+
+/* The same for two blocks, one in each 128 bit lane. */
+static ALWAYS_INLINE __attribute__((target("avx2")))
+__m256i _sha256_next_avx2(__m256i w1, __m256i w2, __m256i w3, __m256i w4)
+{
+	__m256i x, s;
+
+	x = _mm256_add_epi32(_mm256_add_epi32(w4, _mm256_alignr_epi8(w1, w2, 4)),
+			     _sha256_sigma0_avx2(_mm256_alignr_epi8(w3, w4, 4)));
+	s = _sha256_sigma1_avx2(_mm256_shuffle_epi32(w1, 0xfe));
+	x = _mm256_add_epi32(x, _mm256_blend_epi32(s, _mm256_setzero_si256(), 0xcc));
+	s = _sha256_sigma1_avx2(x);
+	return _mm256_add_epi32(x, _mm256_slli_si256(s, 8));
+}
+
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+void _sha256_schedule_ssse3(const uint8_t *block, uint32_t *wk)
+{
+	const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					   4, 5, 6, 7, 0, 1, 2, 3);
+	__m128i w[16];
+	int j;
+
+	for (j = 0; j < 16; j++) {
+		if (j < 4)
+			w[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+								(block + 16 * j)), bswap);
+		else
+			w[j] = _sha256_next_ssse3(w[j - 1], w[j - 2],
+						  w[j - 3], w[j - 4]);
+		_mm_storeu_si128((__m128i *)(wk + 4 * j), _mm_add_epi32(w[j],
+			_mm_loadu_si128((const __m128i *)(SHA224_256K + 4 * j))));
+	}
+}
+
+__attribute__((target("ssse3")))
+void SHA256ProcessBlocksSSSE3(uint32_t H[8], const uint8_t *blocks, size_t n)
+{
+	uint32_t wk[64];
+
+	for (; n > 0; n--, blocks += SHA256_Message_Block_Size) {
+		_sha256_schedule_ssse3(blocks, wk);
+		_sha256_rounds(H, wk);
+	}
+}
+
+/* Two blocks at a time, one in each 128 bit lane. */
+__attribute__((target("avx2")))
+void SHA256ProcessBlocksAVX2(uint32_t H[8], const uint8_t *blocks, size_t n)
+{
+	const __m256i bswap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					      4, 5, 6, 7, 0, 1, 2, 3,
+					      12, 13, 14, 15, 8, 9, 10, 11,
+					      4, 5, 6, 7, 0, 1, 2, 3);
+	uint32_t wk[2][64];
+	__m256i w[16];
+	int j;
+
+	for (; n >= 2; n -= 2, blocks += 2 * SHA256_Message_Block_Size) {
+		for (j = 0; j < 16; j++) {
+			__m256i v;
+
+			if (j < 4) {
+				const uint8_t *p = blocks + 16 * j;
+
+				w[j] = _mm256_shuffle_epi8(_mm256_inserti128_si256(
+					_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) p)),
+					_mm_loadu_si128((const __m128i *)(p + SHA256_Message_Block_Size)), 1),
+					bswap);
+			} else {
+				w[j] = _sha256_next_avx2(w[j - 1], w[j - 2],
+							 w[j - 3], w[j - 4]);
+			}
+			v = _mm256_add_epi32(w[j], _mm256_broadcastsi128_si256(
+				_mm_loadu_si128((const __m128i *)(SHA224_256K + 4 * j))));
+			_mm_storeu_si128((__m128i *)(wk[0] + 4 * j),
+					 _mm256_castsi256_si128(v));
+			_mm_storeu_si128((__m128i *)(wk[1] + 4 * j),
+					 _mm256_extracti128_si256(v, 1));
+		}
+		_sha256_rounds(H, wk[0]);
+		_sha256_rounds(H, wk[1]);
+	}
+	if (n) {
+		_sha256_schedule_ssse3(blocks, wk[0]);
+		_sha256_rounds(H, wk[0]);
+	}
+}
+
+/* Four rounds on the SHA extensions, two per sha256rnds2, with the
+ * message schedule of group g computed from the four groups before
+ * it in the same registers. */
+#define SHANI_SCHEDULE(g)						\
+	m[(g) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(		\
+		_mm_sha256msg1_epu32(m[(g) & 3], m[((g) - 3) & 3]),	\
+		_mm_alignr_epi8(m[((g) - 1) & 3], m[((g) - 2) & 3], 4)), \
+		m[((g) - 1) & 3])
+#define SHANI_ROUNDS(g) do {						\
+		__m128i _wk = _mm_add_epi32(m[(g) & 3], _mm_loadu_si128( \
+			(const __m128i *)(SHA224_256K + 4 * (g))));	\
+		cdgh = _mm_sha256rnds2_epu32(cdgh, abef, _wk);		\
+		abef = _mm_sha256rnds2_epu32(abef, cdgh,		\
+					     _mm_shuffle_epi32(_wk, 0x0e)); \
+	} while (0)
+#define SHANI_ROUNDS_S(g) do {						\
+		SHANI_SCHEDULE(g);					\
+		SHANI_ROUNDS(g);					\
+	} while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void SHA256ProcessBlocksSHANI(uint32_t H[8], const uint8_t *blocks, size_t n)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					     0x0405060700010203ULL);
+	__m128i abef, cdgh, abef_save, cdgh_save, t;
+	__m128i m[4];
+	int j;
+
+	/* the state as the instructions want it, ABEF and CDGH */
+	t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) H), 0xb1);
+	cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(H + 4)), 0x1b);
+	abef = _mm_alignr_epi8(t, cdgh, 8);
+	cdgh = _mm_blend_epi16(cdgh, t, 0xf0);
+
+	for (; n > 0; n--, blocks += SHA256_Message_Block_Size) {
+		abef_save = abef;
+		cdgh_save = cdgh;
+		for (j = 0; j < 4; j++)
+			m[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+								(blocks + 16 * j)), bswap);
+
+		SHANI_ROUNDS(0);
+		SHANI_ROUNDS(1);
+		SHANI_ROUNDS(2);
+		SHANI_ROUNDS(3);
+		SHANI_ROUNDS_S(4);
+		SHANI_ROUNDS_S(5);
+		SHANI_ROUNDS_S(6);
+		SHANI_ROUNDS_S(7);
+		SHANI_ROUNDS_S(8);
+		SHANI_ROUNDS_S(9);
+		SHANI_ROUNDS_S(10);
+		SHANI_ROUNDS_S(11);
+		SHANI_ROUNDS_S(12);
+		SHANI_ROUNDS_S(13);
+		SHANI_ROUNDS_S(14);
+		SHANI_ROUNDS_S(15);
+
+		abef = _mm_add_epi32(abef, abef_save);
+		cdgh = _mm_add_epi32(cdgh, cdgh_save);
+	}
+
+	t = _mm_shuffle_epi32(abef, 0x1b);
+	cdgh = _mm_shuffle_epi32(cdgh, 0xb1);
+	_mm_storeu_si128((__m128i *) H, _mm_blend_epi16(t, cdgh, 0xf0));
+	_mm_storeu_si128((__m128i *)(H + 4), _mm_alignr_epi8(cdgh, t, 8));
+}
+
+#endif /* HAVE_SHA_X86 */
@@ -36,6 +36,8 @@
  *   final few bits of the input.
  */
 
+#include <string.h>
+
 #include "sha.h"
 #include "sha-private.h"
 /* Define the SHA shift, rotate left and rotate right macro */
@@ -56,13 +58,20 @@
   (SHA256_ROTR(17,word) ^ SHA256_ROTR(19,word) ^ SHA256_SHR(10,word))
 
 /*
- * add "length" to the length
+ * add "length" bits to the length, the context is corrupted
+ * once it no longer fits in 64 bits
  */
-static uint32_t addTemp;
-#define SHA224_256AddLength(context, length)               \
-  (addTemp = (context)->Length_Low, (context)->Corrupted = \
-    (((context)->Length_Low += (length)) < addTemp) &&     \
-    (++(context)->Length_High == 0) ? 1 : 0)
+static int SHA224_256AddLength(SHA256Context *context, uint64_t length)
+{
+  uint64_t total = ((uint64_t)context->Length_High << 32) |
+                   context->Length_Low;
+
+  total += length;
+  context->Length_Low = (uint32_t) total;
+  context->Length_High = (uint32_t) (total >> 32);
+  context->Corrupted = (total < length) ? 1 : 0;
+  return context->Corrupted;
+}
 
 /* Local Function Prototypes */
 static void SHA224_256Finalize(SHA256Context *context,
@@ -70,18 +79,20 @@ static void SHA224_256Finalize(SHA256Context *context,
 static void SHA224_256PadMessage(SHA256Context *context,
   uint8_t Pad_Byte);
 static void SHA224_256ProcessMessageBlock(SHA256Context *context);
-static int SHA224_256Reset(SHA256Context *context, uint32_t *H0);
+static void SHA224_256ProcessBlocks(uint32_t H[8], const uint8_t *blocks,
+  size_t n);
+static int SHA224_256Reset(SHA256Context *context, const uint32_t *H0);
 static int SHA224_256ResultN(SHA256Context *context,
   uint8_t Message_Digest[], int HashSize);
 
 /* Initial Hash Values: FIPS-180-2 Change Notice 1 */
-static uint32_t SHA224_H0[SHA256HashSize/4] = {
+static const uint32_t SHA224_H0[SHA256HashSize/4] = {
     0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
     0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4
 };
 
 /* Initial Hash Values: FIPS-180-2 section 5.3.2 */
-static uint32_t SHA256_H0[SHA256HashSize/4] = {
+static const uint32_t SHA256_H0[SHA256HashSize/4] = {
   0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
   0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
 };
@@ -235,17 +246,39 @@ int SHA256Input(SHA256Context *context, const uint8_t *message_array,
   if (context->Corrupted)
      return context->Corrupted;
 
-  while (length-- && !context->Corrupted) {
-    context->Message_Block[context->Message_Block_Index++] =
-            (*message_array & 0xFF);
+  if (SHA224_256AddLength(context, (uint64_t)length * 8))
+    return shaSuccess;
 
-    if (!SHA224_256AddLength(context, 8) &&
-      (context->Message_Block_Index == SHA256_Message_Block_Size))
-      SHA224_256ProcessMessageBlock(context);
+  /* top up a partly filled block first */
+  if (context->Message_Block_Index) {
+    unsigned int fill = SHA256_Message_Block_Size -
+                        context->Message_Block_Index;
+
+    if (fill > length)
+      fill = length;
+    memcpy(context->Message_Block + context->Message_Block_Index,
+           message_array, fill);
+    context->Message_Block_Index += fill;
+    message_array += fill;
+    length -= fill;
+
+    if (context->Message_Block_Index < SHA256_Message_Block_Size)
+      return shaSuccess;
+    SHA224_256ProcessMessageBlock(context);
+  }
+
+  /* whole blocks straight from the message */
+  if (length >= SHA256_Message_Block_Size) {
+    size_t n = length / SHA256_Message_Block_Size;
 
-    message_array++;
+    SHA224_256ProcessBlocks(context->Intermediate_Hash, message_array, n);
+    message_array += n * SHA256_Message_Block_Size;
+    length -= n * SHA256_Message_Block_Size;
   }
 
+  memcpy(context->Message_Block, message_array, length);
+  context->Message_Block_Index = (int_least16_t) length;
+
   return shaSuccess;
 
 }
@@ -432,80 +465,121 @@ static void SHA224_256PadMessage(SHA256Context *context,
  *
  * Returns:
  *   Nothing.
+ */
+static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+{
+  SHA224_256ProcessBlocks(context->Intermediate_Hash,
+                          context->Message_Block, 1);
+  context->Message_Block_Index = 0;
+}
+
+/*
+ * SHA224_256ProcessBlocks
+ *
+ * Description:
+ *   This function will process n blocks of 512 bits with the
+ *   fastest block function the CPU has, see SHACPUFeatures().
+ */
+static void SHA224_256ProcessBlocks(uint32_t H[8], const uint8_t *blocks,
+  size_t n)
+{
+#ifdef HAVE_SHA_X86
+  unsigned int cpu = SHACPUFeatures();
+
+  if ((cpu & (SHA_CPU_SHA | SHA_CPU_SSE41 | SHA_CPU_SSSE3)) ==
+      (SHA_CPU_SHA | SHA_CPU_SSE41 | SHA_CPU_SSSE3))
+    SHA256ProcessBlocksSHANI(H, blocks, n);
+  else if (cpu & SHA_CPU_AVX2)
+    SHA256ProcessBlocksAVX2(H, blocks, n);
+  else if (cpu & SHA_CPU_SSSE3)
+    SHA256ProcessBlocksSSSE3(H, blocks, n);
+  else
+#endif /* HAVE_SHA_X86 */
+    SHA256ProcessBlocksC(H, blocks, n);
+}
+
+/* Constants defined in FIPS-180-2, section 4.2.2 */
+const uint32_t SHA224_256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+    0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+    0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+    0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+    0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+    0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+    0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+    0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+ * SHA256ProcessBlocksC
+ *
+ * Description:
+ *   This is the portable block function, processing n blocks of
+ *   512 bits into the intermediate hash Hash.
  *
  * Comments:
  *   Many of the variable names in this code, especially the
  *   single character names, were used because those were the
  *   names used in the publication.
  */
-static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+void SHA256ProcessBlocksC(uint32_t Hash[8], const uint8_t *blocks, size_t n)
 {
-  /* Constants defined in FIPS-180-2, section 4.2.2 */
-  static const uint32_t K[64] = {
-      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-      0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-      0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-      0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-      0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-      0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-      0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-      0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-      0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-      0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-      0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-      0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-  };
+  const uint32_t *K = SHA224_256K;
   int        t, t4;                   /* Loop counter */
   uint32_t   temp1, temp2;            /* Temporary word value */
   uint32_t   W[64];                   /* Word sequence */
   uint32_t   A, B, C, D, E, F, G, H;  /* Word buffers */
 
-  /*
-   * Initialize the first 16 words in the array W
-   */
-  for (t = t4 = 0; t < 16; t++, t4 += 4)
-    W[t] = (((uint32_t)context->Message_Block[t4]) << 24) |
-           (((uint32_t)context->Message_Block[t4 + 1]) << 16) |
-           (((uint32_t)context->Message_Block[t4 + 2]) << 8) |
-           (((uint32_t)context->Message_Block[t4 + 3]));
-
-  for (t = 16; t < 64; t++)
-    W[t] = SHA256_sigma1(W[t-2]) + W[t-7] +
-        SHA256_sigma0(W[t-15]) + W[t-16];
-
-  A = context->Intermediate_Hash[0];
-  B = context->Intermediate_Hash[1];
-  C = context->Intermediate_Hash[2];
-  D = context->Intermediate_Hash[3];
-  E = context->Intermediate_Hash[4];
-  F = context->Intermediate_Hash[5];
-  G = context->Intermediate_Hash[6];
-  H = context->Intermediate_Hash[7];
-
-  for (t = 0; t < 64; t++) {
-    temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E,F,G) + K[t] + W[t];
-    temp2 = SHA256_SIGMA0(A) + SHA_Maj(A,B,C);
-    H = G;
-    G = F;
-    F = E;
-    E = D + temp1;
-    D = C;
-    C = B;
-    B = A;
-    A = temp1 + temp2;
+  for (; n > 0; n--, blocks += SHA256_Message_Block_Size) {
+    /*
+     * Initialize the first 16 words in the array W
+     */
+    for (t = t4 = 0; t < 16; t++, t4 += 4)
+      W[t] = (((uint32_t)blocks[t4]) << 24) |
+             (((uint32_t)blocks[t4 + 1]) << 16) |
+             (((uint32_t)blocks[t4 + 2]) << 8) |
+             (((uint32_t)blocks[t4 + 3]));
+
+    for (t = 16; t < 64; t++)
+      W[t] = SHA256_sigma1(W[t-2]) + W[t-7] +
+          SHA256_sigma0(W[t-15]) + W[t-16];
+
+    A = Hash[0];
+    B = Hash[1];
+    C = Hash[2];
+    D = Hash[3];
+    E = Hash[4];
+    F = Hash[5];
+    G = Hash[6];
+    H = Hash[7];
+
+    for (t = 0; t < 64; t++) {
+      temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E,F,G) + K[t] + W[t];
+      temp2 = SHA256_SIGMA0(A) + SHA_Maj(A,B,C);
+      H = G;
+      G = F;
+      F = E;
+      E = D + temp1;
+      D = C;
+      C = B;
+      B = A;
+      A = temp1 + temp2;
+    }
+
+    Hash[0] += A;
+    Hash[1] += B;
+    Hash[2] += C;
+    Hash[3] += D;
+    Hash[4] += E;
+    Hash[5] += F;
+    Hash[6] += G;
+    Hash[7] += H;
   }
-
-  context->Intermediate_Hash[0] += A;
-  context->Intermediate_Hash[1] += B;
-  context->Intermediate_Hash[2] += C;
-  context->Intermediate_Hash[3] += D;
-  context->Intermediate_Hash[4] += E;
-  context->Intermediate_Hash[5] += F;
-  context->Intermediate_Hash[6] += G;
-  context->Intermediate_Hash[7] += H;
-
-  context->Message_Block_Index = 0;
 }
 
 /*
@@ -524,7 +598,7 @@ static void SHA224_256ProcessMessageBlock(SHA256Context *context)
  * Returns:
  *   sha Error Code.
  */
-static int SHA224_256Reset(SHA256Context *context, uint32_t *H0)
+static int SHA224_256Reset(SHA256Context *context, const uint32_t *H0)
 {
   if (!context)
     return shaNull;
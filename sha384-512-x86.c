@@ -0,0 +1,243 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* SHA-384/512 block functions for x86, chosen at runtime by
+ * sha384-512.c.
+ *
+ * There are no SHA-512 instructions to use, so these compute the
+ * message schedule with W + K two words at a time, for one block in
+ * an xmm register, two blocks side by side in a ymm register or four
+ * in a zmm register, and run the rounds on the general registers.
+ * Two words per block also means W[t-2] and W[t-1] for sigma1 are
+ * the whole previous group.
+ */
+
+#include "sha.h"
+#include "sha-private.h"
+
+#if defined(HAVE_SHA_X86) && !defined(USE_32BIT_ONLY)
+
+#include <immintrin.h>
+
+#define ALWAYS_INLINE	__attribute__((always_inline)) inline
+
+#define ROTR(bits, word) \
+	(((word) >> (bits)) | ((word) << (64 - (bits))))
+#define SIGMA0(w)	(ROTR(28, w) ^ ROTR(34, w) ^ ROTR(39, w))
+#define SIGMA1(w)	(ROTR(14, w) ^ ROTR(18, w) ^ ROTR(41, w))
+
+#define SHA512_STEP(a, b, c, d, e, f, g, h, wk) do {			\
+		uint64_t _t = h + SIGMA1(e) + SHA_Ch(e, f, g) + (wk);	\
+		d += _t;						\
+		h = _t + SIGMA0(a) + SHA_Maj(a, b, c);			\
+	} while (0)
+
+/* The 80 rounds with a precomputed W + K, eight at a time so that the
+ * variables rotate by renaming.  The schedule of several blocks is
+ * stored as computed, two words of each block in turn, so W[t] + K[t]
+ * of this one is at WK(t). */
+#define WK(t)	wk[((t) >> 1) * 2 * lanes + ((t) & 1)]
+
+static ALWAYS_INLINE void _sha512_rounds(uint64_t H[8], const uint64_t *wk,
+					 const int lanes)
+{
+	uint64_t a = H[0], b = H[1], c = H[2], d = H[3];
+	uint64_t e = H[4], f = H[5], g = H[6], h = H[7];
+	int t;
+
+	for (t = 0; t < 80; t += 8) {
+		SHA512_STEP(a, b, c, d, e, f, g, h, WK(t));
+		SHA512_STEP(h, a, b, c, d, e, f, g, WK(t + 1));
+		SHA512_STEP(g, h, a, b, c, d, e, f, WK(t + 2));
+		SHA512_STEP(f, g, h, a, b, c, d, e, WK(t + 3));
+		SHA512_STEP(e, f, g, h, a, b, c, d, WK(t + 4));
+		SHA512_STEP(d, e, f, g, h, a, b, c, WK(t + 5));
+		SHA512_STEP(c, d, e, f, g, h, a, b, WK(t + 6));
+		SHA512_STEP(b, c, d, e, f, g, h, a, WK(t + 7));
+	}
+
+	H[0] += a;
+	H[1] += b;
+	H[2] += c;
+	H[3] += d;
+	H[4] += e;
+	H[5] += f;
+	H[6] += g;
+	H[7] += h;
+}
+
+/* W[2g], W[2g+1] from the groups before, w[0] being group g - 8:
+ * W[t-16] + sigma0(W[t-15]) + W[t-7] + sigma1(W[t-2]). */
+#define SHA512_NEXT(w, add, xor, srl, ror, alignr)		\
+	add(add(w[0], add(alignr(w[5], w[4], 8),			\
+			  xor(xor(ror(w[7], 19), ror(w[7], 61)),	\
+			      srl(w[7], 6)))),				\
+	    xor(xor(ror(alignr(w[1], w[0], 8), 1),			\
+		    ror(alignr(w[1], w[0], 8), 8)),			\
+		srl(alignr(w[1], w[0], 8), 7)))
+
+#define VROR_SSE(x, n)	\
+	_mm_or_si128(_mm_srli_epi64(x, n), _mm_slli_epi64(x, 64 - (n)))
+#define VROR_AVX2(x, n)	\
+	_mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+__m128i _sha512_next_ssse3(const __m128i *w)
+{
+	return SHA512_NEXT(w, _mm_add_epi64, _mm_xor_si128, _mm_srli_epi64,
+			   VROR_SSE, _mm_alignr_epi8);
+}
+
+static ALWAYS_INLINE __attribute__((target("avx2")))
+__m256i _sha512_next_avx2(const __m256i *w)
+{
+	return SHA512_NEXT(w, _mm256_add_epi64, _mm256_xor_si256,
+			   _mm256_srli_epi64, VROR_AVX2, _mm256_alignr_epi8);
+}
+
+static ALWAYS_INLINE __attribute__((target("avx512f,avx512bw")))
+__m512i _sha512_next_avx512(const __m512i *w)
+{
+	return SHA512_NEXT(w, _mm512_add_epi64, _mm512_xor_si512,
+			   _mm512_srli_epi64, _mm512_ror_epi64,
+			   _mm512_alignr_epi8);
+}
+
+#define BSWAP64	8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7
+
+static ALWAYS_INLINE __attribute__((target("ssse3")))
+void _sha512_schedule_ssse3(const uint8_t *block, uint64_t *wk)
+{
+	const __m128i bswap = _mm_set_epi8(BSWAP64);
+	__m128i w[40];
+	int j;
+
+	for (j = 0; j < 40; j++) {
+		if (j < 8)
+			w[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+								(block + 16 * j)), bswap);
+		else
+			w[j] = _sha512_next_ssse3(w + j - 8);
+		_mm_storeu_si128((__m128i *)(wk + 2 * j), _mm_add_epi64(w[j],
+			_mm_loadu_si128((const __m128i *)(SHA384_512K + 2 * j))));
+	}
+}
+
+__attribute__((target("ssse3")))
+void SHA512ProcessBlocksSSSE3(uint64_t H[8], const uint8_t *blocks, size_t n)
+{
+	uint64_t wk[80];
+
+	for (; n > 0; n--, blocks += SHA512_Message_Block_Size) {
+		_sha512_schedule_ssse3(blocks, wk);
+		_sha512_rounds(H, wk, 1);
+	}
+}
+
+/* Two blocks at a time, one in each 128 bit lane. */
+__attribute__((target("avx2")))
+void SHA512ProcessBlocksAVX2(uint64_t H[8], const uint8_t *blocks, size_t n)
+{
+	const __m256i bswap = _mm256_set_epi8(BSWAP64, BSWAP64);
+	uint64_t wk[2 * 80];
+	__m256i w[40];
+	int j;
+
+	for (; n >= 2; n -= 2, blocks += 2 * SHA512_Message_Block_Size) {
+		for (j = 0; j < 40; j++) {
+			__m256i v;
+
+			if (j < 8) {
+				const uint8_t *p = blocks + 16 * j;
+
+				w[j] = _mm256_shuffle_epi8(_mm256_inserti128_si256(
+					_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) p)),
+					_mm_loadu_si128((const __m128i *)(p + SHA512_Message_Block_Size)), 1),
+					bswap);
+			} else {
+				w[j] = _sha512_next_avx2(w + j - 8);
+			}
+			v = _mm256_add_epi64(w[j], _mm256_broadcastsi128_si256(
+				_mm_loadu_si128((const __m128i *)(SHA384_512K + 2 * j))));
+			_mm256_storeu_si256((__m256i *)(wk + 4 * j), v);
+		}
+		_sha512_rounds(H, wk, 2);
+		_sha512_rounds(H, wk + 2, 2);
+	}
+	if (n) {
+		_sha512_schedule_ssse3(blocks, wk);
+		_sha512_rounds(H, wk, 1);
+	}
+}
+
+/* Four blocks at a time, one in each 128 bit lane, with the AVX-512
+ * rotate; the rest go through the AVX2 function. */
+#define LOAD_LANE(p, b) \
+	_mm_loadu_si128((const __m128i *)((p) + (b) * SHA512_Message_Block_Size))
+
+__attribute__((target("avx512f,avx512bw,avx2")))
+void SHA512ProcessBlocksAVX512(uint64_t H[8], const uint8_t *blocks, size_t n)
+{
+	const __m512i bswap = _mm512_set_epi64(
+		0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+		0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+		0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+		0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+	uint64_t wk[4 * 80];
+	__m512i w[40];
+	int j, b;
+
+	for (; n >= 4; n -= 4, blocks += 4 * SHA512_Message_Block_Size) {
+		for (j = 0; j < 40; j++) {
+			__m512i v;
+
+			if (j < 8) {
+				const uint8_t *p = blocks + 16 * j;
+
+				v = _mm512_castsi128_si512(LOAD_LANE(p, 0));
+				v = _mm512_inserti32x4(v, LOAD_LANE(p, 1), 1);
+				v = _mm512_inserti32x4(v, LOAD_LANE(p, 2), 2);
+				v = _mm512_inserti32x4(v, LOAD_LANE(p, 3), 3);
+				w[j] = _mm512_shuffle_epi8(v, bswap);
+			} else {
+				w[j] = _sha512_next_avx512(w + j - 8);
+			}
+			v = _mm512_add_epi64(w[j], _mm512_broadcast_i32x4(
+				_mm_loadu_si128((const __m128i *)(SHA384_512K + 2 * j))));
+			_mm512_storeu_si512(wk + 8 * j, v);
+		}
+		for (b = 0; b < 4; b++)
+			_sha512_rounds(H, wk + 2 * b, 4);
+	}
+	if (n)
+		SHA512ProcessBlocksAVX2(H, blocks, n);
+}
+
+#endif /* HAVE_SHA_X86 && !USE_32BIT_ONLY */
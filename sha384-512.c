@@ -39,6 +39,8 @@
  *
  */
 
+#include <string.h>
+
 #include "sha.h"
 #include "sha-private.h"
 
@@ -107,85 +109,106 @@
     (ret)[1] = (word1)[1], (ret)[1] += (word2)[1],             \
     (ret)[0] = (word1)[0] + (word2)[0] + ((ret)[1] < (word1)[1]) )
 
+/*
+ * The helpers below are functions with their temporaries on the
+ * stack, rather than macros sharing file-scope ones, so that any
+ * number of contexts may be hashed at once from different threads.
+ */
+
 /*
  * Add the 4word value in word2 to word1.
  */
-static uint32_t ADDTO4_temp, ADDTO4_temp2;
-#define SHA512_ADDTO4(word1, word2) (                          \
-    ADDTO4_temp = (word1)[3],                                  \
-    (word1)[3] += (word2)[3],                                  \
-    ADDTO4_temp2 = (word1)[2],                                 \
-    (word1)[2] += (word2)[2] + ((word1)[3] < ADDTO4_temp),     \
-    ADDTO4_temp = (word1)[1],                                  \
-    (word1)[1] += (word2)[1] + ((word1)[2] < ADDTO4_temp2),    \
-    (word1)[0] += (word2)[0] + ((word1)[1] < ADDTO4_temp) )
+static void SHA512_ADDTO4(uint32_t word1[4], const uint32_t word2[4])
+{
+  uint32_t temp = word1[3], temp2;
+
+  word1[3] += word2[3];
+  temp2 = word1[2];
+  word1[2] += word2[2] + (word1[3] < temp);
+  temp = word1[1];
+  word1[1] += word2[1] + (word1[2] < temp2);
+  word1[0] += word2[0] + (word1[1] < temp);
+}
 
 /*
  * Add the 2word value in word2 to word1.
  */
-static uint32_t ADDTO2_temp;
-#define SHA512_ADDTO2(word1, word2) (                          \
-    ADDTO2_temp = (word1)[1],                                  \
-    (word1)[1] += (word2)[1],                                  \
-    (word1)[0] += (word2)[0] + ((word1)[1] < ADDTO2_temp) )
+static void SHA512_ADDTO2(uint32_t word1[2], const uint32_t word2[2])
+{
+  uint32_t temp = word1[1];
+
+  word1[1] += word2[1];
+  word1[0] += word2[0] + (word1[1] < temp);
+}
 
 /*
  * SHA rotate   ((word >> bits) | (word << (64-bits)))
  */
-static uint32_t ROTR_temp1[2], ROTR_temp2[2];
-#define SHA512_ROTR(bits, word, ret) (                         \
-    SHA512_SHR((bits), (word), ROTR_temp1),                    \
-    SHA512_SHL(64-(bits), (word), ROTR_temp2),                 \
-    SHA512_OR(ROTR_temp1, ROTR_temp2, (ret)) )
+static void SHA512_ROTR(int bits, const uint32_t word[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2];
+
+  SHA512_SHR(bits, word, temp1);
+  SHA512_SHL(64-bits, word, temp2);
+  SHA512_OR(temp1, temp2, ret);
+}
 
 /*
- * Define the SHA SIGMA and sigma macros
+ * Define the SHA SIGMA and sigma functions
  *  SHA512_ROTR(28,word) ^ SHA512_ROTR(34,word) ^ SHA512_ROTR(39,word)
  */
-static uint32_t SIGMA0_temp1[2], SIGMA0_temp2[2],
-  SIGMA0_temp3[2], SIGMA0_temp4[2];
-#define SHA512_SIGMA0(word, ret) (                             \
-    SHA512_ROTR(28, (word), SIGMA0_temp1),                     \
-    SHA512_ROTR(34, (word), SIGMA0_temp2),                     \
-    SHA512_ROTR(39, (word), SIGMA0_temp3),                     \
-    SHA512_XOR(SIGMA0_temp2, SIGMA0_temp3, SIGMA0_temp4),      \
-    SHA512_XOR(SIGMA0_temp1, SIGMA0_temp4, (ret)) )
+static void SHA512_SIGMA0(const uint32_t word[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2], temp3[2], temp4[2];
+
+  SHA512_ROTR(28, word, temp1);
+  SHA512_ROTR(34, word, temp2);
+  SHA512_ROTR(39, word, temp3);
+  SHA512_XOR(temp2, temp3, temp4);
+  SHA512_XOR(temp1, temp4, ret);
+}
 
 /*
  * SHA512_ROTR(14,word) ^ SHA512_ROTR(18,word) ^ SHA512_ROTR(41,word)
  */
-static uint32_t SIGMA1_temp1[2], SIGMA1_temp2[2],
-  SIGMA1_temp3[2], SIGMA1_temp4[2];
-#define SHA512_SIGMA1(word, ret) (                             \
-    SHA512_ROTR(14, (word), SIGMA1_temp1),                     \
-    SHA512_ROTR(18, (word), SIGMA1_temp2),                     \
-    SHA512_ROTR(41, (word), SIGMA1_temp3),                     \
-    SHA512_XOR(SIGMA1_temp2, SIGMA1_temp3, SIGMA1_temp4),      \
-    SHA512_XOR(SIGMA1_temp1, SIGMA1_temp4, (ret)) )
+static void SHA512_SIGMA1(const uint32_t word[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2], temp3[2], temp4[2];
+
+  SHA512_ROTR(14, word, temp1);
+  SHA512_ROTR(18, word, temp2);
+  SHA512_ROTR(41, word, temp3);
+  SHA512_XOR(temp2, temp3, temp4);
+  SHA512_XOR(temp1, temp4, ret);
+}
 
 /*
  * (SHA512_ROTR( 1,word) ^ SHA512_ROTR( 8,word) ^ SHA512_SHR( 7,word))
  */
-static uint32_t sigma0_temp1[2], sigma0_temp2[2],
-  sigma0_temp3[2], sigma0_temp4[2];
-#define SHA512_sigma0(word, ret) (                             \
-    SHA512_ROTR( 1, (word), sigma0_temp1),                     \
-    SHA512_ROTR( 8, (word), sigma0_temp2),                     \
-    SHA512_SHR( 7, (word), sigma0_temp3),                      \
-    SHA512_XOR(sigma0_temp2, sigma0_temp3, sigma0_temp4),      \
-    SHA512_XOR(sigma0_temp1, sigma0_temp4, (ret)) )
+static void SHA512_sigma0(const uint32_t word[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2], temp3[2], temp4[2];
+
+  SHA512_ROTR( 1, word, temp1);
+  SHA512_ROTR( 8, word, temp2);
+  SHA512_SHR( 7, word, temp3);
+  SHA512_XOR(temp2, temp3, temp4);
+  SHA512_XOR(temp1, temp4, ret);
+}
 
 /*
  * (SHA512_ROTR(19,word) ^ SHA512_ROTR(61,word) ^ SHA512_SHR( 6,word))
  */
-static uint32_t sigma1_temp1[2], sigma1_temp2[2],
-  sigma1_temp3[2], sigma1_temp4[2];
-#define SHA512_sigma1(word, ret) (                             \
-    SHA512_ROTR(19, (word), sigma1_temp1),                     \
-    SHA512_ROTR(61, (word), sigma1_temp2),                     \
-    SHA512_SHR( 6, (word), sigma1_temp3),                      \
-    SHA512_XOR(sigma1_temp2, sigma1_temp3, sigma1_temp4),      \
-    SHA512_XOR(sigma1_temp1, sigma1_temp4, (ret)) )
+static void SHA512_sigma1(const uint32_t word[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2], temp3[2], temp4[2];
+
+  SHA512_ROTR(19, word, temp1);
+  SHA512_ROTR(61, word, temp2);
+  SHA512_SHR( 6, word, temp3);
+  SHA512_XOR(temp2, temp3, temp4);
+  SHA512_XOR(temp1, temp4, ret);
+}
 
 #undef SHA_Ch
 #undef SHA_Maj
@@ -195,23 +218,31 @@ static uint32_t sigma1_temp1[2], sigma1_temp2[2],
  * These definitions are the ones used in FIPS-180-2, section 4.1.3
  *  Ch(x,y,z)   ((x & y) ^ (~x & z))
  */
-static uint32_t Ch_temp1[2], Ch_temp2[2], Ch_temp3[2];
-#define SHA_Ch(x, y, z, ret) (                                 \
-    SHA512_AND(x, y, Ch_temp1),                                \
-    SHA512_TILDA(x, Ch_temp2),                                 \
-    SHA512_AND(Ch_temp2, z, Ch_temp3),                         \
-    SHA512_XOR(Ch_temp1, Ch_temp3, (ret)) )
+static void SHA_Ch(const uint32_t x[2], const uint32_t y[2],
+  const uint32_t z[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2], temp3[2];
+
+  SHA512_AND(x, y, temp1);
+  SHA512_TILDA(x, temp2);
+  SHA512_AND(temp2, z, temp3);
+  SHA512_XOR(temp1, temp3, ret);
+}
+
 /*
  *  Maj(x,y,z)  (((x)&(y)) ^ ((x)&(z)) ^ ((y)&(z)))
  */
-static uint32_t Maj_temp1[2], Maj_temp2[2],
-  Maj_temp3[2], Maj_temp4[2];
-#define SHA_Maj(x, y, z, ret) (                                \
-    SHA512_AND(x, y, Maj_temp1),                               \
-    SHA512_AND(x, z, Maj_temp2),                               \
-    SHA512_AND(y, z, Maj_temp3),                               \
-    SHA512_XOR(Maj_temp2, Maj_temp3, Maj_temp4),               \
-    SHA512_XOR(Maj_temp1, Maj_temp4, (ret)) )
+static void SHA_Maj(const uint32_t x[2], const uint32_t y[2],
+  const uint32_t z[2], uint32_t ret[2])
+{
+  uint32_t temp1[2], temp2[2], temp3[2], temp4[2];
+
+  SHA512_AND(x, y, temp1);
+  SHA512_AND(x, z, temp2);
+  SHA512_AND(y, z, temp3);
+  SHA512_XOR(temp2, temp3, temp4);
+  SHA512_XOR(temp1, temp4, ret);
+}
 
 #else /* !USE_32BIT_ONLY */
 /*
@@ -236,12 +267,16 @@ static uint32_t Maj_temp1[2], Maj_temp2[2],
 /*
  * add "length" to the length
  */
-static uint32_t addTemp[4] = { 0, 0, 0, 0 };
-#define SHA384_512AddLength(context, length) (                        \
-    addTemp[3] = (length), SHA512_ADDTO4((context)->Length, addTemp), \
-    (context)->Corrupted = (((context)->Length[3] == 0) &&            \
-       ((context)->Length[2] == 0) && ((context)->Length[1] == 0) &&  \
-       ((context)->Length[0] < 8)) ? 1 : 0 )
+static int SHA384_512AddLength(SHA512Context *context, uint32_t length)
+{
+  uint32_t addTemp[4] = { 0, 0, 0, 0 };
+
+  addTemp[3] = length;
+  SHA512_ADDTO4(context->Length, addTemp);
+  return context->Corrupted = ((context->Length[3] == 0) &&
+    (context->Length[2] == 0) && (context->Length[1] == 0) &&
+    (context->Length[0] < 8)) ? 1 : 0;
+}
 
 /* Local Function Prototypes */
 static void SHA384_512Finalize(SHA512Context *context,
@@ -249,19 +284,19 @@ static void SHA384_512Finalize(SHA512Context *context,
 static void SHA384_512PadMessage(SHA512Context *context,
   uint8_t Pad_Byte);
 static void SHA384_512ProcessMessageBlock(SHA512Context *context);
-static int SHA384_512Reset(SHA512Context *context, uint32_t H0[]);
+static int SHA384_512Reset(SHA512Context *context, const uint32_t H0[]);
 static int SHA384_512ResultN( SHA512Context *context,
   uint8_t Message_Digest[], int HashSize);
 
 /* Initial Hash Values: FIPS-180-2 sections 5.3.3 and 5.3.4 */
-static uint32_t SHA384_H0[SHA512HashSize/4] = {
+static const uint32_t SHA384_H0[SHA512HashSize/4] = {
     0xCBBB9D5D, 0xC1059ED8, 0x629A292A, 0x367CD507, 0x9159015A,
     0x3070DD17, 0x152FECD8, 0xF70E5939, 0x67332667, 0xFFC00B31,
     0x8EB44A87, 0x68581511, 0xDB0C2E0D, 0x64F98FA7, 0x47B5481D,
     0xBEFA4FA4
 };
 
-static uint32_t SHA512_H0[SHA512HashSize/4] = {
+static const uint32_t SHA512_H0[SHA512HashSize/4] = {
     0x6A09E667, 0xF3BCC908, 0xBB67AE85, 0x84CAA73B, 0x3C6EF372,
     0xFE94F82B, 0xA54FF53A, 0x5F1D36F1, 0x510E527F, 0xADE682D1,
     0x9B05688C, 0x2B3E6C1F, 0x1F83D9AB, 0xFB41BD6B, 0x5BE0CD19,
@@ -286,13 +321,14 @@ static uint32_t SHA512_H0[SHA512HashSize/4] = {
  (SHA512_ROTR(19,word) ^ SHA512_ROTR(61,word) ^ SHA512_SHR( 6,word))
 
 /*
- * add "length" to the length
+ * add "length" bits to the length
  */
-static uint64_t addTemp;
-#define SHA384_512AddLength(context, length)                   \
-   (addTemp = context->Length_Low, context->Corrupted =        \
-    ((context->Length_Low += length) < addTemp) &&             \
-    (++context->Length_High == 0) ? 1 : 0)
+static int SHA384_512AddLength(SHA512Context *context, uint64_t length)
+{
+  context->Corrupted = ((context->Length_Low += length) < length) &&
+                       (++context->Length_High == 0) ? 1 : 0;
+  return context->Corrupted;
+}
 
 /* Local Function Prototypes */
 static void SHA384_512Finalize(SHA512Context *context,
@@ -300,17 +336,19 @@ static void SHA384_512Finalize(SHA512Context *context,
 static void SHA384_512PadMessage(SHA512Context *context,
   uint8_t Pad_Byte);
 static void SHA384_512ProcessMessageBlock(SHA512Context *context);
-static int SHA384_512Reset(SHA512Context *context, uint64_t H0[]);
+static void SHA384_512ProcessBlocks(uint64_t H[8], const uint8_t *blocks,
+  size_t n);
+static int SHA384_512Reset(SHA512Context *context, const uint64_t H0[]);
 static int SHA384_512ResultN(SHA512Context *context,
   uint8_t Message_Digest[], int HashSize);
 
 /* Initial Hash Values: FIPS-180-2 sections 5.3.3 and 5.3.4 */
-static uint64_t SHA384_H0[] = {
+static const uint64_t SHA384_H0[] = {
     0xCBBB9D5DC1059ED8ll, 0x629A292A367CD507ll, 0x9159015A3070DD17ll,
     0x152FECD8F70E5939ll, 0x67332667FFC00B31ll, 0x8EB44A8768581511ll,
     0xDB0C2E0D64F98FA7ll, 0x47B5481DBEFA4FA4ll
 };
-static uint64_t SHA512_H0[] = {
+static const uint64_t SHA512_H0[] = {
     0x6A09E667F3BCC908ll, 0xBB67AE8584CAA73Bll, 0x3C6EF372FE94F82Bll,
     0xA54FF53A5F1D36F1ll, 0x510E527FADE682D1ll, 0x9B05688C2B3E6C1Fll,
     0x1F83D9ABFB41BD6Bll, 0x5BE0CD19137E2179ll
@@ -473,6 +511,7 @@ int SHA512Input(SHA512Context *context,
   if (context->Corrupted)
      return context->Corrupted;
 
+#ifdef USE_32BIT_ONLY
   while (length-- && !context->Corrupted) {
     context->Message_Block[context->Message_Block_Index++] =
             (*message_array & 0xFF);
@@ -483,6 +522,40 @@ int SHA512Input(SHA512Context *context,
 
     message_array++;
   }
+#else /* !USE_32BIT_ONLY */
+  if (SHA384_512AddLength(context, (uint64_t)length * 8))
+    return shaSuccess;
+
+  /* top up a partly filled block first */
+  if (context->Message_Block_Index) {
+    unsigned int fill = SHA512_Message_Block_Size -
+                        context->Message_Block_Index;
+
+    if (fill > length)
+      fill = length;
+    memcpy(context->Message_Block + context->Message_Block_Index,
+           message_array, fill);
+    context->Message_Block_Index += fill;
+    message_array += fill;
+    length -= fill;
+
+    if (context->Message_Block_Index < SHA512_Message_Block_Size)
+      return shaSuccess;
+    SHA384_512ProcessMessageBlock(context);
+  }
+
+  /* whole blocks straight from the message */
+  if (length >= SHA512_Message_Block_Size) {
+    size_t n = length / SHA512_Message_Block_Size;
+
+    SHA384_512ProcessBlocks(context->Intermediate_Hash, message_array, n);
+    message_array += n * SHA512_Message_Block_Size;
+    length -= n * SHA512_Message_Block_Size;
+  }
+
+  memcpy(context->Message_Block, message_array, length);
+  context->Message_Block_Index = (int_least16_t) length;
+#endif /* USE_32BIT_ONLY */
 
   return shaSuccess;
 }
@@ -841,91 +914,140 @@ static void SHA384_512ProcessMessageBlock(SHA512Context *context)
   SHA512_ADDTO2(&context->Intermediate_Hash[14], H);
 
 #else /* !USE_32BIT_ONLY */
-  static const uint64_t K[80] = {
-      0x428A2F98D728AE22ll, 0x7137449123EF65CDll, 0xB5C0FBCFEC4D3B2Fll,
-      0xE9B5DBA58189DBBCll, 0x3956C25BF348B538ll, 0x59F111F1B605D019ll,
-      0x923F82A4AF194F9Bll, 0xAB1C5ED5DA6D8118ll, 0xD807AA98A3030242ll,
-      0x12835B0145706FBEll, 0x243185BE4EE4B28Cll, 0x550C7DC3D5FFB4E2ll,
-      0x72BE5D74F27B896Fll, 0x80DEB1FE3B1696B1ll, 0x9BDC06A725C71235ll,
-      0xC19BF174CF692694ll, 0xE49B69C19EF14AD2ll, 0xEFBE4786384F25E3ll,
-      0x0FC19DC68B8CD5B5ll, 0x240CA1CC77AC9C65ll, 0x2DE92C6F592B0275ll,
-      0x4A7484AA6EA6E483ll, 0x5CB0A9DCBD41FBD4ll, 0x76F988DA831153B5ll,
-      0x983E5152EE66DFABll, 0xA831C66D2DB43210ll, 0xB00327C898FB213Fll,
-      0xBF597FC7BEEF0EE4ll, 0xC6E00BF33DA88FC2ll, 0xD5A79147930AA725ll,
-      0x06CA6351E003826Fll, 0x142929670A0E6E70ll, 0x27B70A8546D22FFCll,
-      0x2E1B21385C26C926ll, 0x4D2C6DFC5AC42AEDll, 0x53380D139D95B3DFll,
-      0x650A73548BAF63DEll, 0x766A0ABB3C77B2A8ll, 0x81C2C92E47EDAEE6ll,
-      0x92722C851482353Bll, 0xA2BFE8A14CF10364ll, 0xA81A664BBC423001ll,
-      0xC24B8B70D0F89791ll, 0xC76C51A30654BE30ll, 0xD192E819D6EF5218ll,
-      0xD69906245565A910ll, 0xF40E35855771202All, 0x106AA07032BBD1B8ll,
-      0x19A4C116B8D2D0C8ll, 0x1E376C085141AB53ll, 0x2748774CDF8EEB99ll,
-      0x34B0BCB5E19B48A8ll, 0x391C0CB3C5C95A63ll, 0x4ED8AA4AE3418ACBll,
-      0x5B9CCA4F7763E373ll, 0x682E6FF3D6B2B8A3ll, 0x748F82EE5DEFB2FCll,
-      0x78A5636F43172F60ll, 0x84C87814A1F0AB72ll, 0x8CC702081A6439ECll,
-      0x90BEFFFA23631E28ll, 0xA4506CEBDE82BDE9ll, 0xBEF9A3F7B2C67915ll,
-      0xC67178F2E372532Bll, 0xCA273ECEEA26619Cll, 0xD186B8C721C0C207ll,
-      0xEADA7DD6CDE0EB1Ell, 0xF57D4F7FEE6ED178ll, 0x06F067AA72176FBAll,
-      0x0A637DC5A2C898A6ll, 0x113F9804BEF90DAEll, 0x1B710B35131C471Bll,
-      0x28DB77F523047D84ll, 0x32CAAB7B40C72493ll, 0x3C9EBE0A15C9BEBCll,
-      0x431D67C49C100D4Cll, 0x4CC5D4BECB3E42B6ll, 0x597F299CFC657E2All,
-      0x5FCB6FAB3AD6FAECll, 0x6C44198C4A475817ll
-  };
+  SHA384_512ProcessBlocks(context->Intermediate_Hash,
+                          context->Message_Block, 1);
+#endif /* USE_32BIT_ONLY */
+
+  context->Message_Block_Index = 0;
+}
+
+#ifndef USE_32BIT_ONLY
+/*
+ * SHA384_512ProcessBlocks
+ *
+ * Description:
+ *   This function will process n blocks of 1024 bits with the
+ *   fastest block function the CPU has, see SHACPUFeatures().
+ */
+static void SHA384_512ProcessBlocks(uint64_t H[8], const uint8_t *blocks,
+  size_t n)
+{
+#ifdef HAVE_SHA_X86
+  unsigned int cpu = SHACPUFeatures();
+
+  if (cpu & SHA_CPU_AVX512)
+    SHA512ProcessBlocksAVX512(H, blocks, n);
+  else if (cpu & SHA_CPU_AVX2)
+    SHA512ProcessBlocksAVX2(H, blocks, n);
+  else if (cpu & SHA_CPU_SSSE3)
+    SHA512ProcessBlocksSSSE3(H, blocks, n);
+  else
+#endif /* HAVE_SHA_X86 */
+    SHA512ProcessBlocksC(H, blocks, n);
+}
+
+/* Constants defined in FIPS-180-2, section 4.2.3 */
+const uint64_t SHA384_512K[80] = {
+    0x428A2F98D728AE22ll, 0x7137449123EF65CDll, 0xB5C0FBCFEC4D3B2Fll,
+    0xE9B5DBA58189DBBCll, 0x3956C25BF348B538ll, 0x59F111F1B605D019ll,
+    0x923F82A4AF194F9Bll, 0xAB1C5ED5DA6D8118ll, 0xD807AA98A3030242ll,
+    0x12835B0145706FBEll, 0x243185BE4EE4B28Cll, 0x550C7DC3D5FFB4E2ll,
+    0x72BE5D74F27B896Fll, 0x80DEB1FE3B1696B1ll, 0x9BDC06A725C71235ll,
+    0xC19BF174CF692694ll, 0xE49B69C19EF14AD2ll, 0xEFBE4786384F25E3ll,
+    0x0FC19DC68B8CD5B5ll, 0x240CA1CC77AC9C65ll, 0x2DE92C6F592B0275ll,
+    0x4A7484AA6EA6E483ll, 0x5CB0A9DCBD41FBD4ll, 0x76F988DA831153B5ll,
+    0x983E5152EE66DFABll, 0xA831C66D2DB43210ll, 0xB00327C898FB213Fll,
+    0xBF597FC7BEEF0EE4ll, 0xC6E00BF33DA88FC2ll, 0xD5A79147930AA725ll,
+    0x06CA6351E003826Fll, 0x142929670A0E6E70ll, 0x27B70A8546D22FFCll,
+    0x2E1B21385C26C926ll, 0x4D2C6DFC5AC42AEDll, 0x53380D139D95B3DFll,
+    0x650A73548BAF63DEll, 0x766A0ABB3C77B2A8ll, 0x81C2C92E47EDAEE6ll,
+    0x92722C851482353Bll, 0xA2BFE8A14CF10364ll, 0xA81A664BBC423001ll,
+    0xC24B8B70D0F89791ll, 0xC76C51A30654BE30ll, 0xD192E819D6EF5218ll,
+    0xD69906245565A910ll, 0xF40E35855771202All, 0x106AA07032BBD1B8ll,
+    0x19A4C116B8D2D0C8ll, 0x1E376C085141AB53ll, 0x2748774CDF8EEB99ll,
+    0x34B0BCB5E19B48A8ll, 0x391C0CB3C5C95A63ll, 0x4ED8AA4AE3418ACBll,
+    0x5B9CCA4F7763E373ll, 0x682E6FF3D6B2B8A3ll, 0x748F82EE5DEFB2FCll,
+    0x78A5636F43172F60ll, 0x84C87814A1F0AB72ll, 0x8CC702081A6439ECll,
+    0x90BEFFFA23631E28ll, 0xA4506CEBDE82BDE9ll, 0xBEF9A3F7B2C67915ll,
+    0xC67178F2E372532Bll, 0xCA273ECEEA26619Cll, 0xD186B8C721C0C207ll,
+    0xEADA7DD6CDE0EB1Ell, 0xF57D4F7FEE6ED178ll, 0x06F067AA72176FBAll,
+    0x0A637DC5A2C898A6ll, 0x113F9804BEF90DAEll, 0x1B710B35131C471Bll,
+    0x28DB77F523047D84ll, 0x32CAAB7B40C72493ll, 0x3C9EBE0A15C9BEBCll,
+    0x431D67C49C100D4Cll, 0x4CC5D4BECB3E42B6ll, 0x597F299CFC657E2All,
+    0x5FCB6FAB3AD6FAECll, 0x6C44198C4A475817ll
+};
+
+/*
+ * SHA512ProcessBlocksC
+ *
+ * Description:
+ *   This is the portable block function, processing n blocks of
+ *   1024 bits into the intermediate hash Hash.
+ *
+ * Comments:
+ *   Many of the variable names in this code, especially the
+ *   single character names, were used because those were the
+ *   names used in the publication.
+ */
+void SHA512ProcessBlocksC(uint64_t Hash[8], const uint8_t *blocks, size_t n)
+{
+  const uint64_t *K = SHA384_512K;
   int        t, t8;                   /* Loop counter */
   uint64_t   temp1, temp2;            /* Temporary word value */
   uint64_t   W[80];                   /* Word sequence */
   uint64_t   A, B, C, D, E, F, G, H;  /* Word buffers */
 
-  /*
-   * Initialize the first 16 words in the array W
-   */
-  for (t = t8 = 0; t < 16; t++, t8 += 8)
-    W[t] = ((uint64_t)(context->Message_Block[t8  ]) << 56) |
-           ((uint64_t)(context->Message_Block[t8 + 1]) << 48) |
-           ((uint64_t)(context->Message_Block[t8 + 2]) << 40) |
-           ((uint64_t)(context->Message_Block[t8 + 3]) << 32) |
-           ((uint64_t)(context->Message_Block[t8 + 4]) << 24) |
-           ((uint64_t)(context->Message_Block[t8 + 5]) << 16) |
-           ((uint64_t)(context->Message_Block[t8 + 6]) << 8) |
-           ((uint64_t)(context->Message_Block[t8 + 7]));
-
-  for (t = 16; t < 80; t++)
-    W[t] = SHA512_sigma1(W[t-2]) + W[t-7] +
-        SHA512_sigma0(W[t-15]) + W[t-16];
-
-  A = context->Intermediate_Hash[0];
-  B = context->Intermediate_Hash[1];
-  C = context->Intermediate_Hash[2];
-  D = context->Intermediate_Hash[3];
-  E = context->Intermediate_Hash[4];
-  F = context->Intermediate_Hash[5];
-  G = context->Intermediate_Hash[6];
-  H = context->Intermediate_Hash[7];
-
-  for (t = 0; t < 80; t++) {
-    temp1 = H + SHA512_SIGMA1(E) + SHA_Ch(E,F,G) + K[t] + W[t];
-    temp2 = SHA512_SIGMA0(A) + SHA_Maj(A,B,C);
-    H = G;
-    G = F;
-    F = E;
-    E = D + temp1;
-    D = C;
-    C = B;
-    B = A;
-    A = temp1 + temp2;
+  for (; n > 0; n--, blocks += SHA512_Message_Block_Size) {
+    /*
+     * Initialize the first 16 words in the array W
+     */
+    for (t = t8 = 0; t < 16; t++, t8 += 8)
+      W[t] = ((uint64_t)(blocks[t8  ]) << 56) |
+             ((uint64_t)(blocks[t8 + 1]) << 48) |
+             ((uint64_t)(blocks[t8 + 2]) << 40) |
+             ((uint64_t)(blocks[t8 + 3]) << 32) |
+             ((uint64_t)(blocks[t8 + 4]) << 24) |
+             ((uint64_t)(blocks[t8 + 5]) << 16) |
+             ((uint64_t)(blocks[t8 + 6]) << 8) |
+             ((uint64_t)(blocks[t8 + 7]));
+
+    for (t = 16; t < 80; t++)
+      W[t] = SHA512_sigma1(W[t-2]) + W[t-7] +
+          SHA512_sigma0(W[t-15]) + W[t-16];
+
+    A = Hash[0];
+    B = Hash[1];
+    C = Hash[2];
+    D = Hash[3];
+    E = Hash[4];
+    F = Hash[5];
+    G = Hash[6];
+    H = Hash[7];
+
+    for (t = 0; t < 80; t++) {
+      temp1 = H + SHA512_SIGMA1(E) + SHA_Ch(E,F,G) + K[t] + W[t];
+      temp2 = SHA512_SIGMA0(A) + SHA_Maj(A,B,C);
+      H = G;
+      G = F;
+      F = E;
+      E = D + temp1;
+      D = C;
+      C = B;
+      B = A;
+      A = temp1 + temp2;
+    }
+
+    Hash[0] += A;
+    Hash[1] += B;
+    Hash[2] += C;
+    Hash[3] += D;
+    Hash[4] += E;
+    Hash[5] += F;
+    Hash[6] += G;
+    Hash[7] += H;
   }
-
-  context->Intermediate_Hash[0] += A;
-  context->Intermediate_Hash[1] += B;
-  context->Intermediate_Hash[2] += C;
-  context->Intermediate_Hash[3] += D;
-  context->Intermediate_Hash[4] += E;
-  context->Intermediate_Hash[5] += F;
-  context->Intermediate_Hash[6] += G;
-  context->Intermediate_Hash[7] += H;
-#endif /* USE_32BIT_ONLY */
-
-  context->Message_Block_Index = 0;
 }
+#endif /* USE_32BIT_ONLY */
 
 /*
  * SHA384_512Reset
@@ -946,9 +1068,9 @@ static void SHA384_512ProcessMessageBlock(SHA512Context *context)
  *
  */
 #ifdef USE_32BIT_ONLY
-static int SHA384_512Reset(SHA512Context *context, uint32_t H0[])
+static int SHA384_512Reset(SHA512Context *context, const uint32_t H0[])
 #else /* !USE_32BIT_ONLY */
-static int SHA384_512Reset(SHA512Context *context, uint64_t H0[])
+static int SHA384_512Reset(SHA512Context *context, const uint64_t H0[])
 #endif /* USE_32BIT_ONLY */
 {
   int i;
@@ -0,0 +1,96 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+/* Throughput of putting configurations together with the setters, run
+   with "make bench". */
+
+#define ROUNDS 1000000
+
+int main(int argc, char **argv)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	unsigned char uid[] = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16};
+	long rounds = ROUNDS;
+	long i;
+	clock_t start;
+	double secs;
+
+	if (argc > 1)
+		rounds = atol(argv[1]);
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+
+	start = clock();
+	for (i = 0; i < rounds; i++) {
+		YKP_CONFIG *cfg = ykp_alloc();
+
+		if (!cfg || !ykp_configure_for(cfg, 1, st) ||
+		    !ykp_set_fixed(cfg, fixed, sizeof(fixed)) ||
+		    !ykp_set_uid(cfg, uid, sizeof(uid)) ||
+		    ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") != 0 ||
+		    !ykp_set_tktflag_APPEND_CR(cfg, true) ||
+		    !ykp_set_tktflag_TAB_FIRST(cfg, true) ||
+		    !ykp_set_tktflag_PROTECT_CFG2(cfg, true) ||
+		    !ykp_set_cfgflag_PACING_10MS(cfg, true) ||
+		    !ykp_set_cfgflag_SHORT_TICKET(cfg, true) ||
+		    !ykp_set_cfgflag_STRONG_PW1(cfg, true) ||
+		    !ykp_set_extflag_SERIAL_BTN_VISIBLE(cfg, true) ||
+		    !ykp_set_extflag_SERIAL_API_VISIBLE(cfg, true) ||
+		    !ykp_set_extflag_ALLOW_UPDATE(cfg, true) ||
+		    !ykp_set_extflag_FAST_TRIG(cfg, true) ||
+		    !ykp_set_extflag_DORMANT(cfg, true) ||
+		    !ykp_set_extflag_LED_INV(cfg, true))
+			return 1;
+		ykp_free_config(cfg);
+	}
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (secs <= 0)
+		secs = 1e-9;
+
+	printf("config build: %ld configs in %.3f s, %.0f configs/s\n",
+	       rounds, secs, rounds / secs);
+
+	ykds_free(st);
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+/* Throughput of the legacy format import, run with "make bench". */
+
+#define ROUNDS 200000
+
+int main(int argc, char **argv)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	char buf[1024];
+	long rounds = ROUNDS;
+	long i;
+	int len;
+	clock_t start;
+	double secs;
+
+	if (argc > 1)
+		rounds = atol(argv[1]);
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+	assert(ykp_set_extflag_SERIAL_API_VISIBLE(cfg, true) == 1);
+	len = ykp_export_config(cfg, buf, sizeof(buf), YKP_FORMAT_LEGACY);
+	assert(len > 0);
+
+	start = clock();
+	for (i = 0; i < rounds; i++) {
+		if (!ykp_import_config(cfg, buf, (size_t)len, YKP_FORMAT_LEGACY))
+			return 1;
+	}
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (secs <= 0)
+		secs = 1e-9;
+
+	printf("legacy import: %ld configs in %.3f s, %.0f configs/s, %.1f MB/s\n",
+	       rounds, secs, rounds / secs, rounds * (double)len / secs / 1e6);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+
+	return 0;
+}
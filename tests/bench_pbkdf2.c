@@ -0,0 +1,113 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ykpbkdf2.h>
+
+/* yk_pbkdf2() as ykp_AES_key_from_passphrase() runs it, with the
+ * HMAC pads hashed once per passphrase and, through a method it does
+ * not know, once per iteration.  Then a long key on one thread and
+ * on all CPUs.  Run with "make bench". */
+
+static int per_call_hmac_sha1(const char *key, size_t key_len,
+			      const char *text, size_t text_len,
+			      uint8_t *output, size_t output_size)
+{
+	return yk_hmac_sha1(key, key_len, text, text_len, output, output_size);
+}
+
+static double _secs(clock_t start)
+{
+	double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return secs > 0 ? secs : 1e-9;
+}
+
+/* wall clock, the threads' CPU time adds up */
+static double _now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+	YK_PRF_METHOD methods[] = {
+		{ 20, per_call_hmac_sha1 },
+		{ 20, yk_hmac_sha1 },
+	};
+	const char *names[] = { "per call", "keyed" };
+	const unsigned char salt[8] = "saltsalt";
+	unsigned char dk[20];
+	unsigned char long_dk[320];
+	YK_PRF_CTX *ctx;
+	unsigned int threads[] = { 1, 0 };
+	const char *thread_names[] = { "1 thread", "all CPUs" };
+	double wall;
+	long keys = 1000;
+	long i;
+	size_t m;
+	clock_t start;
+	double secs;
+
+	if (argc > 1)
+		keys = atol(argv[1]);
+
+	for (m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+		start = clock();
+		for (i = 0; i < keys; i++)
+			yk_pbkdf2("passphrase", salt, sizeof(salt), 1024,
+				  dk, sizeof(dk), &methods[m]);
+		secs = _secs(start);
+		printf("pbkdf2-sha1 1024 iterations, %s: %ld keys in %.3f s, "
+		       "%.0f/s (%02x)\n", names[m], keys, secs, keys / secs,
+		       dk[0]);
+	}
+
+	ctx = yk_prf_init(&methods[1], "passphrase", 10);
+	for (m = 0; m < sizeof(threads) / sizeof(threads[0]); m++) {
+		wall = _now();
+		for (i = 0; i < keys / 16; i++)
+			yk_pbkdf2_parallel(ctx, salt, sizeof(salt), 1024,
+					   long_dk, sizeof(long_dk), threads[m]);
+		wall = _now() - wall;
+		printf("pbkdf2-sha1 1024 iterations, %d bytes, %s: "
+		       "%ld keys in %.3f s, %.0f/s (%02x)\n",
+		       (int)sizeof(long_dk), thread_names[m], keys / 16,
+		       wall, keys / 16 / wall, long_dk[0]);
+	}
+	yk_prf_free(ctx);
+
+	return 0;
+}
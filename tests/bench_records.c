@@ -0,0 +1,118 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+/* Appends to and scans of a record file, run with "make bench". */
+
+#define RECORDS 1000000
+#define RECORD_FILE "bench_records.tmp"
+
+static double _secs(clock_t start)
+{
+	double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return secs > 0 ? secs : 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+	YKP_RECORD_FILE *file;
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	long records = RECORDS;
+	unsigned int serial, sum = 0;
+	long i;
+	clock_t start;
+	double secs;
+
+	if (argc > 1)
+		records = atol(argv[1]);
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+
+	remove(RECORD_FILE);
+	file = ykp_record_file_open(RECORD_FILE);
+	assert(file != NULL);
+
+	start = clock();
+	for (i = 0; i < records; i++) {
+		if (!ykp_record_file_append(file, cfg, (unsigned int)i))
+			return 1;
+	}
+	assert(ykp_record_file_close(file) == 1);
+	secs = _secs(start);
+	printf("record append: %ld records in %.3f s, %.0f records/s\n",
+	       records, secs, records / secs);
+
+	file = ykp_record_file_open(RECORD_FILE);
+	assert(file != NULL);
+	start = clock();
+	for (i = 0; i < records; i++) {
+		if (!ykp_record_file_get(file, (size_t)i, &serial, cfg))
+			return 1;
+		sum += serial;
+	}
+	secs = _secs(start);
+	printf("record scan: %ld records in %.3f s, %.0f records/s (%u)\n",
+	       records, secs, records / secs, sum);
+
+	srand(1);
+	start = clock();
+	for (i = 0; i < records; i++) {
+		size_t index = ((size_t)rand() * 65536 + rand()) % records;
+		if (!ykp_record_file_get(file, index, &serial, cfg))
+			return 1;
+		sum += serial;
+	}
+	secs = _secs(start);
+	printf("record random get: %ld records in %.3f s, %.0f records/s (%u)\n",
+	       records, secs, records / secs, sum);
+
+	assert(ykp_record_file_close(file) == 1);
+	remove(RECORD_FILE);
+	ykp_free_config(cfg);
+	ykds_free(st);
+
+	return 0;
+}
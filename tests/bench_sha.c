@@ -0,0 +1,175 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES()	__rdtsc()
+#else
+#define CYCLES()	0
+#endif
+
+#include "sha.h"
+
+/* Hashing and HMAC with each kernel the CPU has, run with "make bench".
+ * Cycles per byte are from the time stamp counter where there is one. */
+
+#define BUFSIZE 65536
+#define BATCH 64
+
+static const struct {
+	unsigned int mask;
+	const char *name;
+} kernels[] = {
+	{ 0, "c" },
+	{ SHA_CPU_SSSE3, "ssse3" },
+	{ SHA_CPU_SSSE3 | SHA_CPU_AVX2, "avx2" },
+	{ SHA_CPU_SSSE3 | SHA_CPU_AVX2 | SHA_CPU_AVX512, "avx512" },
+	{ SHA_CPU_ALL, "sha" },
+};
+
+static const struct {
+	SHAversion which;
+	const char *name;
+} hashes[] = {
+	{ SHA1, "sha1" },
+	{ SHA256, "sha256" },
+	{ SHA512, "sha512" },
+};
+
+static double _secs(clock_t start)
+{
+	double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return secs > 0 ? secs : 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t buf[BUFSIZE];
+	static HMACSHA1Job jobs[BATCH];
+	HMACKeyed keyed;
+	static uint8_t digests[BATCH][SHA1HashSize];
+	uint8_t digest[USHAMaxHashSize];
+	unsigned int found = SHASetCPUFeatures(SHA_CPU_ALL);
+	long megabytes = 256;
+	long macs;
+	long i;
+	int j;
+	size_t k, h;
+	clock_t start;
+	double secs;
+
+	if (argc > 1)
+		megabytes = atol(argv[1]);
+	macs = megabytes * 4096;
+	for (i = 0; i < BUFSIZE; i++)
+		buf[i] = (uint8_t) i;
+
+	for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+		if ((found & kernels[k].mask) != kernels[k].mask)
+			continue;
+		SHASetCPUFeatures(kernels[k].mask);
+
+		for (h = 0; h < sizeof(hashes) / sizeof(hashes[0]); h++) {
+			USHAContext ctx;
+			unsigned long long cycles;
+
+			start = clock();
+			cycles = CYCLES();
+			USHAReset(&ctx, hashes[h].which);
+			for (i = 0; i < megabytes * (1048576 / BUFSIZE); i++)
+				USHAInput(&ctx, buf, BUFSIZE);
+			USHAResult(&ctx, digest);
+			cycles = CYCLES() - cycles;
+			secs = _secs(start);
+			printf("%s %s: %ld MB in %.3f s, %.1f MB/s, %.2f cycles/byte (%02x)\n",
+			       hashes[h].name, kernels[k].name, megabytes, secs,
+			       megabytes / secs,
+			       (double) cycles / ((double) megabytes * 1048576),
+			       digest[0]);
+
+			start = clock();
+			for (i = 0; i < macs; i++)
+				hmac(hashes[h].which, buf, 20, buf + 64, 20, digest);
+			secs = _secs(start);
+			printf("hmac-%s %s: %ld in %.3f s, %.0f/s (%02x)\n",
+			       hashes[h].name, kernels[k].name, macs, secs,
+			       macs / secs, digest[0]);
+		}
+
+		/* challenge-response shaped, one at a time and in lanes */
+		start = clock();
+		for (i = 0; i < macs; i++)
+			hmac(SHA1, buf + (i & 1023), 64, buf + 2048, 20, digest);
+		secs = _secs(start);
+		printf("hmac-sha1 64 byte %s: %ld in %.3f s, %.0f/s (%02x)\n",
+		       kernels[k].name, macs, secs, macs / secs, digest[0]);
+
+		hmacKeyedReset(&keyed, SHA1, buf + 2048, 20);
+		start = clock();
+		for (i = 0; i < macs; i++)
+			hmacKeyedResult(&keyed, buf + (i & 1023), 64, digest);
+		secs = _secs(start);
+		printf("hmac-sha1 64 byte %s, keyed: %ld in %.3f s, %.0f/s (%02x)\n",
+		       kernels[k].name, macs, secs, macs / secs, digest[0]);
+
+		for (j = 0; j < BATCH; j++) {
+			jobs[j].key = buf + 2048;
+			jobs[j].key_len = 20;
+			jobs[j].text_len = 64;
+		}
+		start = clock();
+		for (i = 0; i < macs; i += BATCH) {
+			for (j = 0; j < BATCH; j++)
+				jobs[j].text = buf + ((i + j) & 1023);
+			hmacSHA1Multi(jobs, BATCH);
+		}
+		secs = _secs(start);
+		printf("hmac-sha1 64 byte %s, %d lanes: %ld in %.3f s, %.0f/s (%02x)\n",
+		       kernels[k].name, hmacSHA1Lanes(), macs, secs, macs / secs,
+		       jobs[BATCH - 1].digest[0]);
+
+		/* OATH shaped, 8 byte counters with one key */
+		start = clock();
+		for (i = 0; i < macs; i += BATCH)
+			hmacSHA1KeyedMulti(&keyed, buf + (i & 1023), 8, BATCH,
+					   digests);
+		secs = _secs(start);
+		printf("hmac-sha1 8 byte %s, keyed, %d lanes: %ld in %.3f s, %.0f/s (%02x)\n",
+		       kernels[k].name, hmacSHA1Lanes(), macs, secs, macs / secs,
+		       digests[BATCH - 1][0]);
+	}
+
+	return 0;
+}
@@ -1,6 +1,6 @@
 /* -*- mode:C; c-file-style: "bsd" -*- */
 /*
- * Copyright (c) 2013 Yubico AB
+ * Copyright (c) 2026 Yubico AB
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,20 +28,60 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "ykpers_lcl.h"
-#include "ykpers-json.h"
-
-#include <yubikey.h>
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <assert.h>
 
-int _ykp_json_export_cfg(const YKP_CONFIG *cfg, char *json, size_t len) {
-	ykp_errno = YKP_EINVAL;
-	return 0;
-}
+#include <ykpers.h>
+#include <ykdef.h>
+
+/* Throughput of the ycfg import, run with "make bench". */
+
+#define ROUNDS 200000
+
+int main(int argc, char **argv)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	char buf[2048];
+	long rounds = ROUNDS;
+	long i;
+	int len;
+	clock_t start;
+	double secs;
+
+	if (argc > 1)
+		rounds = atol(argv[1]);
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_set_extflag_SERIAL_API_VISIBLE(cfg, true) == 1);
+	len = ykp_export_config(cfg, buf, sizeof(buf), YKP_FORMAT_YCFG);
+	assert(len > 0);
+
+	start = clock();
+	for (i = 0; i < rounds; i++) {
+		if (!ykp_import_config(cfg, buf, (size_t)len, YKP_FORMAT_YCFG))
+			return 1;
+	}
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (secs <= 0)
+		secs = 1e-9;
+
+	printf("ycfg import: %ld configs in %.3f s, %.0f configs/s, %.1f MB/s\n",
+	       rounds, secs, rounds / secs, rounds * (double)len / secs / 1e6);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
 
-int _ykp_json_import_cfg(YKP_CONFIG *cfg, const char *json, size_t len) {
-	ykp_errno = YKP_EINVAL;
 	return 0;
 }
-
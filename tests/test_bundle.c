@@ -0,0 +1,213 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ykpers_lcl.h"
+#include <ykpers.h>
+#include <ykdef.h>
+
+#define BUNDLE_FILE "test_bundle.tmp"
+
+/* the scope string has braces and a quote in it, to show that indexing
+ * doesn't count those */
+#define CONFIG(slot, tab) "{\"yubiProdConfig\":{\"scope\":\"}{[\\\"\"," \
+	"\"mode\":\"oathHOTP\",\"targetConfig\":" slot "," \
+	"\"options\":{\"tabFirst\":" tab "}}}"
+
+static YK_STATUS *_test_init_st(void)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+
+	return st;
+}
+
+static YKP_BUNDLE *_test_open(const char *data)
+{
+	FILE *f = fopen(BUNDLE_FILE, "wb");
+
+	assert(f != NULL);
+	assert(fwrite(data, 1, strlen(data), f) == strlen(data));
+	assert(fclose(f) == 0);
+
+	return ykp_bundle_open(BUNDLE_FILE);
+}
+
+/* Fetch a configuration into a fresh YKP_CONFIG, the slot it targets
+ * can only be set once. */
+static void _test_get(YKP_BUNDLE *bundle, size_t index, int command,
+		      unsigned char tkt)
+{
+	YK_STATUS *st = _test_init_st();
+	YKP_CONFIG *cfg = ykp_alloc();
+
+	ykp_configure_version(cfg, st);
+	assert(ykp_bundle_get(bundle, index, cfg) == 1);
+	assert(ykp_command(cfg) == command);
+	assert(cfg->ykcore_config.tktFlags == tkt);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+}
+
+/* Every layout holds the same three configurations. */
+static void _test_layout(const char *data)
+{
+	YKP_CONFIG *cfg = ykp_alloc();
+	YKP_BUNDLE *bundle = _test_open(data);
+
+	assert(bundle != NULL);
+
+	/* out of order, before the bundle has been counted */
+	_test_get(bundle, 2, SLOT_CONFIG, TKTFLAG_OATH_HOTP | TKTFLAG_TAB_FIRST);
+	_test_get(bundle, 0, SLOT_CONFIG, TKTFLAG_OATH_HOTP);
+	_test_get(bundle, 1, SLOT_CONFIG2, TKTFLAG_OATH_HOTP | TKTFLAG_TAB_FIRST);
+
+	assert(ykp_bundle_count(bundle) == 3);
+	ykp_errno = 0;
+	assert(ykp_bundle_get(bundle, 3, cfg) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	assert(ykp_bundle_close(bundle) == 1);
+	ykp_free_config(cfg);
+}
+
+static void _test_layouts(void)
+{
+	/* one per line */
+	_test_layout(CONFIG("1", "false") "\n"
+		     CONFIG("2", "true") "\n"
+		     CONFIG("1", "true") "\n");
+	/* pretty printed, one after the other, no trailing newline */
+	_test_layout("{\n  \"yubiProdConfig\":{\n    \"mode\":\"oathHOTP\",\n"
+		     "    \"targetConfig\":1,\n    \"options\":{\n      \"tabFirst\":false\n    }\n  }\n}"
+		     CONFIG("2", "true") "\r\n\t" CONFIG("1", "true"));
+	/* an array */
+	_test_layout(" [ " CONFIG("1", "false") ",\n"
+		     CONFIG("2", "true") " , "
+		     CONFIG("1", "true") "\n]\n");
+}
+
+static void _test_empty(void)
+{
+	const char *empty[] = { "", " \n", "[]", "[\n]\n", NULL };
+	YKP_CONFIG *cfg = ykp_alloc();
+	int i;
+
+	for (i = 0; empty[i]; i++) {
+		YKP_BUNDLE *bundle = _test_open(empty[i]);
+
+		assert(bundle != NULL);
+		assert(ykp_bundle_count(bundle) == 0);
+		ykp_errno = 0;
+		assert(ykp_bundle_get(bundle, 0, cfg) == 0);
+		assert(ykp_errno == YKP_EINVAL);
+		assert(ykp_bundle_close(bundle) == 1);
+	}
+	ykp_free_config(cfg);
+}
+
+/* Configurations before something that isn't one can still be used. */
+static void _test_malformed(void)
+{
+	const char *bad[] = {
+		CONFIG("1", "false") "\n" CONFIG("2", "true") "\n{\"yubiProdConfig\":{",
+		CONFIG("1", "false") "\n" CONFIG("2", "true") "\n\"string\"",
+		CONFIG("1", "false") "\n" CONFIG("2", "true") "\n{\"a\":\"}",
+		"[" CONFIG("1", "false") "," CONFIG("2", "true") "",
+		"[" CONFIG("1", "false") "," CONFIG("2", "true") ",]",
+		"[" CONFIG("1", "false") "," CONFIG("2", "true") "] x",
+		"[" CONFIG("1", "false") "," CONFIG("2", "true") " 1]",
+		NULL
+	};
+	YKP_CONFIG *cfg = ykp_alloc();
+	int i;
+
+	for (i = 0; bad[i]; i++) {
+		YKP_BUNDLE *bundle = _test_open(bad[i]);
+
+		assert(bundle != NULL);
+		assert(ykp_bundle_count(bundle) == 2);
+		_test_get(bundle, 1, SLOT_CONFIG2, TKTFLAG_OATH_HOTP | TKTFLAG_TAB_FIRST);
+		ykp_errno = 0;
+		assert(ykp_bundle_get(bundle, 2, cfg) == 0);
+		assert(ykp_errno == YKP_EINVAL);
+		assert(ykp_bundle_close(bundle) == 1);
+	}
+	ykp_free_config(cfg);
+}
+
+static void _test_invalid(void)
+{
+	YKP_CONFIG *cfg = ykp_alloc();
+	YKP_BUNDLE *bundle;
+
+	remove(BUNDLE_FILE);
+	ykp_errno = 0;
+	assert(ykp_bundle_open(BUNDLE_FILE) == NULL);
+	assert(ykp_errno == YKP_EIO);
+
+	assert(ykp_bundle_close(NULL) == 0);
+	assert(ykp_bundle_count(NULL) == 0);
+	ykp_errno = 0;
+	assert(ykp_bundle_get(NULL, 0, cfg) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	/* found as a configuration, but not a valid one */
+	bundle = _test_open("{\"yubiProdConfig\":{}}");
+	assert(bundle != NULL);
+	assert(ykp_bundle_count(bundle) == 1);
+	ykp_errno = 0;
+	assert(ykp_bundle_get(bundle, 0, cfg) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	assert(ykp_bundle_close(bundle) == 1);
+
+	ykp_free_config(cfg);
+}
+
+int main(void)
+{
+	_test_layouts();
+	_test_empty();
+	_test_malformed();
+	_test_invalid();
+
+	remove(BUNDLE_FILE);
+
+	return 0;
+}
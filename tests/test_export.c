@@ -0,0 +1,194 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+struct output {
+	char buf[4096];
+	size_t len;
+	int calls;
+};
+
+static int _test_writer(const char *buf, size_t count, void *userdata)
+{
+	struct output *out = userdata;
+
+	assert(out->len + count < sizeof(out->buf));
+	memcpy(out->buf + out->len, buf, count);
+	out->len += count;
+	out->buf[out->len] = '\0';
+	out->calls++;
+	return (int)count;
+}
+
+static int _test_short_writer(const char *buf, size_t count, void *userdata)
+{
+	(void) buf;
+	(void) userdata;
+	return (int)count - 1;
+}
+
+static YKP_CONFIG *_test_config(void)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	ykds_free(st);
+
+	return cfg;
+}
+
+static void _test_ksm(void)
+{
+	struct output out;
+	YKP_CONFIG *cfg = _test_config();
+	unsigned char fixed[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+	unsigned char uid[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	unsigned char acc[] = {0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6};
+	const char *expect =
+		"# ykksm 1\n"
+		"4711,cccccccccccb,010203040506,00112233445566778899aabbccddeeff,a1a2a3a4a5a6,";
+
+	memset(&out, 0, sizeof(out));
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_set_uid(cfg, uid, sizeof(uid)) == 1);
+	assert(ykp_set_access_code(cfg, acc, sizeof(acc)) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+
+	assert(ykp_export_server_begin(YKP_FORMAT_KSM, _test_writer, &out) == 1);
+	assert(ykp_export_server_config(YKP_FORMAT_KSM, cfg, 4711, _test_writer, &out) == 1);
+	assert(ykp_export_server_end(YKP_FORMAT_KSM, _test_writer, &out) == 1);
+	fputs(out.buf, stdout);
+
+	/* one write per record, and a timestamp for created */
+	assert(out.calls == 2);
+	assert(strncmp(out.buf, expect, strlen(expect)) == 0);
+	assert(strlen(out.buf) == strlen(expect) + strlen("2019-02-22T00:00:00,\n"));
+
+	/* no Yubico OTP in PSKC */
+	assert(ykp_export_server_config(YKP_FORMAT_PSKC, cfg, 4711, _test_writer, &out) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	/* a failing writer is reported */
+	assert(ykp_export_server_config(YKP_FORMAT_KSM, cfg, 4711, _test_short_writer, NULL) == 0);
+	assert(ykp_errno == YKP_EIO);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_pskc_hotp(void)
+{
+	struct output out;
+	YKP_CONFIG *cfg = _test_config();
+	const char *expect =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<KeyContainer Version=\"1.0\" xmlns=\"urn:ietf:params:xml:ns:keyprov:pskc\">\n"
+		"  <KeyPackage>\n"
+		"    <DeviceInfo>\n"
+		"      <Manufacturer>oath.UB</Manufacturer>\n"
+		"      <SerialNo>4711</SerialNo>\n"
+		"    </DeviceInfo>\n"
+		"    <Key Id=\"4711:1\" Algorithm=\"urn:ietf:params:xml:ns:keyprov:pskc:hotp\">\n"
+		"      <AlgorithmParameters>\n"
+		"        <ResponseFormat Encoding=\"DECIMAL\" Length=\"8\"/>\n"
+		"      </AlgorithmParameters>\n"
+		"      <Data>\n"
+		"        <Secret>\n"
+		"          <PlainValue>MTIzNDU2Nzg5MDEyMzQ1Njc4OTA=</PlainValue>\n"
+		"        </Secret>\n"
+		"        <Counter>\n"
+		"          <PlainValue>32</PlainValue>\n"
+		"        </Counter>\n"
+		"      </Data>\n"
+		"    </Key>\n"
+		"  </KeyPackage>\n"
+		"</KeyContainer>\n";
+
+	memset(&out, 0, sizeof(out));
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_OATH_HOTP8(cfg, true) == 1);
+	/* RFC 4226 test key, "12345678901234567890" */
+	assert(ykp_HMAC_key_from_hex(cfg, "3132333435363738393031323334353637383930") == 0);
+	assert(ykp_set_oath_imf(cfg, 32) == 1);
+
+	assert(ykp_export_server_begin(YKP_FORMAT_PSKC, _test_writer, &out) == 1);
+	assert(ykp_export_server_config(YKP_FORMAT_PSKC, cfg, 4711, _test_writer, &out) == 1);
+	assert(ykp_export_server_end(YKP_FORMAT_PSKC, _test_writer, &out) == 1);
+	fputs(out.buf, stdout);
+	assert(strcmp(out.buf, expect) == 0);
+
+	/* no OATH-HOTP in the KSM format */
+	assert(ykp_export_server_config(YKP_FORMAT_KSM, cfg, 4711, _test_writer, &out) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_pskc_chal_hmac(void)
+{
+	struct output out;
+	YKP_CONFIG *cfg = _test_config();
+
+	memset(&out, 0, sizeof(out));
+	assert(ykp_set_tktflag_CHAL_RESP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_CHAL_HMAC(cfg, true) == 1);
+	assert(ykp_HMAC_key_from_hex(cfg, "3132333435363738393031323334353637383930") == 0);
+
+	assert(ykp_export_server_config(YKP_FORMAT_PSKC, cfg, 4711, _test_writer, &out) == 1);
+	fputs(out.buf, stdout);
+	assert(strstr(out.buf, "urn:ietf:params:xml:ns:keyprov:pskc:totp") != NULL);
+	assert(strstr(out.buf, "<PlainValue>MTIzNDU2Nzg5MDEyMzQ1Njc4OTA=</PlainValue>") != NULL);
+	assert(strstr(out.buf, "<TimeInterval>\n          <PlainValue>30</PlainValue>") != NULL);
+	assert(strstr(out.buf, "Length=\"6\"") != NULL);
+
+	assert(ykp_export_server_begin(0, _test_writer, &out) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	ykp_free_config(cfg);
+}
+
+int main(void)
+{
+	_test_ksm();
+	_test_pskc_hotp();
+	_test_pskc_chal_hmac();
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+#define NCONFIGS 8
+
+/* what malloc() would align to */
+#define ALIGN 16
+#define STRIDE(size) (((size) + ALIGN - 1) & ~(size_t)(ALIGN - 1))
+
+static void _test_configs(void)
+{
+	size_t stride = STRIDE(ykp_config_sizeof());
+	unsigned char *arena = malloc(stride * NCONFIGS);
+	unsigned char stmem[64];
+	YK_STATUS *st = ykds_init(stmem);
+	struct status_st *t = (struct status_st *) st;
+	char buf[1024], expected[1024];
+	int i;
+
+	assert(ykds_sizeof() <= sizeof(stmem));
+	assert(arena != NULL && st != NULL);
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+
+	for (i = 0; i < NCONFIGS; i++) {
+		YKP_CONFIG *cfg = ykp_config_init(arena + i * stride);
+		YKP_CONFIG *heap = ykp_alloc();
+		unsigned char fixed[6] = { 0, 0, 0, 0, 0, i };
+
+		assert(cfg == (YKP_CONFIG *) (arena + i * stride));
+		assert(ykp_configure_for(cfg, 1 + i % 2, st) == 1);
+		assert(ykp_configure_for(heap, 1 + i % 2, st) == 1);
+		assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+		assert(ykp_set_fixed(heap, fixed, sizeof(fixed)) == 1);
+		assert(ykp_export_config(cfg, buf, sizeof(buf), YKP_FORMAT_LEGACY) > 0);
+		assert(ykp_export_config(heap, expected, sizeof(expected), YKP_FORMAT_LEGACY) > 0);
+		assert(strcmp(buf, expected) == 0);
+		ykp_free_config(heap);
+	}
+
+	/* a reused slot starts over */
+	assert(ykp_config_init(arena) == (YKP_CONFIG *) arena);
+	assert(ykp_command((YKP_CONFIG *) arena) == 0);
+	assert(ykp_config_init_default(arena) == (YKP_CONFIG *) arena);
+	assert(ykp_command((YKP_CONFIG *) arena) == SLOT_CONFIG);
+
+	assert(ykp_config_init(NULL) == NULL);
+	assert(ykds_init(NULL) == NULL);
+	free(arena);
+}
+
+static void _test_ndef_device(void)
+{
+	size_t ndef_size = ykp_ndef_sizeof();
+	size_t dev_size = ykp_device_config_sizeof();
+	unsigned char *mem = malloc(STRIDE(ndef_size) + dev_size);
+	YK_NDEF *ndef;
+	YK_DEVICE_CONFIG *dev;
+	char text[256];
+
+	assert(mem != NULL);
+	memset(mem, 0xa5, STRIDE(ndef_size) + dev_size);
+	ndef = ykp_ndef_init(mem);
+	dev = ykp_device_config_init(mem + STRIDE(ndef_size));
+	assert(ndef != NULL && dev != NULL);
+
+	assert(ykp_construct_ndef_uri(ndef, "https://example.com/") == 1);
+	assert(ykp_ndef_as_text(ndef, text, sizeof(text)) == 1);
+	assert(strcmp(text, "https://example.com/") == 0);
+	assert(ykp_set_device_mode(dev, 0x02) == 1);
+
+	free(mem);
+}
+
+int main(void)
+{
+	_test_configs();
+	_test_ndef_device();
+
+	return 0;
+}
@@ -0,0 +1,260 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+#define JOURNAL_FILE "test_journal.tmp"
+
+static YK_STATUS *_test_init_st(int pgm_seq, int touch_level)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+	t->pgmSeq = pgm_seq;
+	t->touchLevel = touch_level;
+
+	return st;
+}
+
+static YKP_CONFIG *_test_config(int confnum)
+{
+	YK_STATUS *st = _test_init_st(1, 0);
+	YKP_CONFIG *cfg = ykp_alloc();
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+	assert(ykp_configure_for(cfg, confnum, st) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+	ykds_free(st);
+
+	return cfg;
+}
+
+static void _test_fingerprint(void)
+{
+	YKP_CONFIG *cfg = _test_config(1);
+	YKP_CONFIG *cfg2 = _test_config(1);
+	unsigned char fp[YKP_FINGERPRINT_SIZE];
+	unsigned char fp2[YKP_FINGERPRINT_SIZE];
+	unsigned char fps[YKP_FINGERPRINT_SIZE];
+	unsigned char fps2[YKP_FINGERPRINT_SIZE];
+
+	assert(ykp_config_fingerprint(cfg, 0, fp, sizeof(fp) - 1) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	assert(ykp_config_fingerprint(NULL, 0, fp, sizeof(fp)) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+
+	/* same configuration gives the same fingerprints */
+	assert(ykp_config_fingerprint(cfg, 0, fp, sizeof(fp)) == 1);
+	assert(ykp_config_fingerprint(cfg2, 0, fp2, sizeof(fp2)) == 1);
+	assert(memcmp(fp, fp2, sizeof(fp)) == 0);
+	assert(ykp_config_fingerprint(cfg, YKP_FINGERPRINT_SECRETS, fps, sizeof(fps)) == 1);
+	assert(ykp_config_fingerprint(cfg2, YKP_FINGERPRINT_SECRETS, fps2, sizeof(fps2)) == 1);
+	assert(memcmp(fps, fps2, sizeof(fps)) == 0);
+	assert(memcmp(fp, fps, sizeof(fp)) != 0);
+
+	/* a different key only shows in the secrets variant */
+	assert(ykp_AES_key_from_hex(cfg2, "ffeeddccbbaa99887766554433221100") == 0);
+	assert(ykp_config_fingerprint(cfg2, 0, fp2, sizeof(fp2)) == 1);
+	assert(memcmp(fp, fp2, sizeof(fp)) == 0);
+	assert(ykp_config_fingerprint(cfg2, YKP_FINGERPRINT_SECRETS, fps2, sizeof(fps2)) == 1);
+	assert(memcmp(fps, fps2, sizeof(fps)) != 0);
+
+	/* flags and the slot show in both */
+	assert(ykp_set_tktflag_APPEND_TAB1(cfg2, true) == 1);
+	assert(ykp_config_fingerprint(cfg2, 0, fp2, sizeof(fp2)) == 1);
+	assert(memcmp(fp, fp2, sizeof(fp)) != 0);
+	ykp_free_config(cfg2);
+	cfg2 = _test_config(2);
+	assert(ykp_config_fingerprint(cfg2, 0, fp2, sizeof(fp2)) == 1);
+	assert(memcmp(fp, fp2, sizeof(fp)) != 0);
+
+	ykp_free_config(cfg);
+	ykp_free_config(cfg2);
+}
+
+/* Flip a byte of the journal file. */
+static void _test_corrupt(long offset)
+{
+	FILE *f = fopen(JOURNAL_FILE, "r+b");
+	int c;
+
+	assert(f != NULL);
+	assert(fseek(f, offset, SEEK_SET) == 0);
+	c = fgetc(f);
+	assert(c != EOF);
+	assert(fseek(f, offset, SEEK_SET) == 0);
+	fputc(c ^ 0xff, f);
+	fclose(f);
+}
+
+static long _test_size(void)
+{
+	FILE *f = fopen(JOURNAL_FILE, "rb");
+	long size;
+
+	assert(f != NULL);
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+static void _test_journal(void)
+{
+	YKP_JOURNAL *journal;
+	YKP_CONFIG *cfg1 = _test_config(1);
+	YKP_CONFIG *cfg2 = _test_config(2);
+	YKP_CONFIG *cfg;
+	YK_STATUS *st;
+	unsigned int serial;
+	FILE *f;
+
+	remove(JOURNAL_FILE);
+	journal = ykp_journal_open(JOURNAL_FILE);
+	assert(journal != NULL);
+
+	st = _test_init_st(5, CONFIG1_VALID);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == false);
+	assert(ykp_journal_record(journal, 4711, cfg1, st) == 1);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == true);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, YKP_FINGERPRINT_SECRETS) == true);
+	assert(ykp_journal_is_current(journal, 4712, cfg1, st, 0) == false);
+	assert(ykp_journal_is_current(journal, 4711, cfg2, st, 0) == false);
+	ykds_free(st);
+
+	/* the key has been written to since */
+	st = _test_init_st(6, CONFIG1_VALID);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == false);
+	ykds_free(st);
+	st = _test_init_st(5, 0);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == false);
+	ykds_free(st);
+
+	/* writing slot 2 keeps slot 1 current */
+	st = _test_init_st(6, CONFIG1_VALID | CONFIG2_VALID);
+	assert(ykp_journal_record(journal, 4711, cfg2, st) == 1);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == true);
+	assert(ykp_journal_is_current(journal, 4711, cfg2, st, 0) == true);
+	assert(ykp_journal_close(journal) == 1);
+
+	/* an interrupted record at the end is dropped */
+	f = fopen(JOURNAL_FILE, "ab");
+	assert(f != NULL);
+	fwrite("\x01\x01\x01\x07", 1, 4, f);
+	fclose(f);
+
+	/* and everything survives a reopen */
+	journal = ykp_journal_open(JOURNAL_FILE);
+	assert(journal != NULL);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == true);
+	assert(ykp_journal_is_current(journal, 4711, cfg2, st, 0) == true);
+
+	/* a new key means the secrets no longer match */
+	assert(ykp_AES_key_from_hex(cfg1, "ffeeddccbbaa99887766554433221100") == 0);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == true);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, YKP_FINGERPRINT_SECRETS) == false);
+	ykds_free(st);
+
+	/* the records, secrets included, can be read back */
+	assert(ykp_journal_count(journal) == 2);
+	cfg = ykp_alloc();
+	assert(ykp_journal_get(journal, 2, &serial, cfg) == 0);
+	assert(ykp_journal_get(journal, 1, &serial, cfg) == 1);
+	assert(serial == 4711);
+	assert(ykp_command(cfg) == SLOT_CONFIG2);
+	assert(memcmp(ykp_core_config(cfg), ykp_core_config(cfg2),
+		      offsetof(struct config_st, crc)) == 0);
+	ykp_free_config(cfg);
+
+	assert(ykp_journal_close(journal) == 1);
+
+	/* only complete records are left */
+	f = fopen(JOURNAL_FILE, "rb");
+	assert(f != NULL);
+	fseek(f, 0, SEEK_END);
+	assert(ftell(f) == 2 * 128);
+	fclose(f);
+
+	/* records are kept with a sync interval as well */
+	journal = ykp_journal_open(JOURNAL_FILE);
+	assert(journal != NULL);
+	assert(ykp_journal_set_sync_interval(journal, 16) == 1);
+	st = _test_init_st(7, CONFIG1_VALID | CONFIG2_VALID);
+	for (serial = 1; serial <= 20; serial++)
+		assert(ykp_journal_record(journal, serial, cfg1, st) == 1);
+	assert(ykp_journal_sync(journal) == 1);
+	assert(ykp_journal_close(journal) == 1);
+	journal = ykp_journal_open(JOURNAL_FILE);
+	assert(journal != NULL);
+	assert(ykp_journal_count(journal) == 22);
+	assert(ykp_journal_is_current(journal, 20, cfg1, st, YKP_FINGERPRINT_SECRETS) == true);
+	assert(ykp_journal_is_current(journal, 4711, cfg1, st, 0) == false);
+	ykds_free(st);
+	assert(ykp_journal_close(journal) == 1);
+
+	/* a bad last record is dropped like a partial one */
+	_test_corrupt(21 * 128 + 40);
+	journal = ykp_journal_open(JOURNAL_FILE);
+	assert(journal != NULL);
+	assert(ykp_journal_count(journal) == 21);
+	assert(ykp_journal_close(journal) == 1);
+	assert(_test_size() == 21 * 128);
+
+	/* a bad record before the last one fails the open, and the good
+	 * records after it stay in the file */
+	_test_corrupt(5 * 128 + 40);
+	ykp_errno = 0;
+	assert(ykp_journal_open(JOURNAL_FILE) == NULL);
+	assert(ykp_errno == YKP_EIO);
+	assert(_test_size() == 21 * 128);
+	remove(JOURNAL_FILE);
+
+	ykp_free_config(cfg1);
+	ykp_free_config(cfg2);
+}
+
+int main(void)
+{
+	_test_fingerprint();
+	_test_journal();
+
+	return 0;
+}
@@ -76,11 +76,179 @@ static void _test_ykp_import_ycfg_simple(void) {
 	ykds_free(st);
 }
 
+/* Export a configuration with every flag the mode has set, import it into
+ * an empty one and check that it exports the same, which needs every
+ * option name to be found. */
+static void _test_roundtrip(int mode_tkt, int mode_cfg, int tkt, int cfgflags) {
+	YK_STATUS *st = init_status(3,4,3);
+	YKP_CONFIG *cfg = ykp_alloc();
+	YKP_CONFIG *cfg2 = ykp_alloc();
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	char out[2048];
+	char out2[2048];
+
+	assert(ykp_configure_for(cfg, 2, st) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	cfg->ykcore_config.tktFlags = mode_tkt | tkt;
+	cfg->ykcore_config.cfgFlags = mode_cfg | cfgflags;
+	cfg->ykcore_config.extFlags = 0xff;
+	assert(ykp_export_config(cfg, out, sizeof(out), YKP_FORMAT_YCFG) > 0);
+	assert(strstr(out, "true") != NULL);
+
+	ykp_configure_version(cfg2, st);
+	assert(ykp_import_config(cfg2, out, strlen(out), YKP_FORMAT_YCFG) == 1);
+	assert(ykp_command(cfg2) == SLOT_CONFIG2);
+	cfg2->ykcore_config.fixedSize = sizeof(fixed);
+	memcpy(cfg2->ykcore_config.fixed, fixed, sizeof(fixed));
+	assert(ykp_export_config(cfg2, out2, sizeof(out2), YKP_FORMAT_YCFG) > 0);
+	assert(strcmp(out, out2) == 0);
+
+	ykp_free_config(cfg);
+	ykp_free_config(cfg2);
+	ykds_free(st);
+}
+
+static void _test_ykp_import_ycfg_roundtrip(void) {
+	/* Yubico OTP */
+	_test_roundtrip(0, 0, 0xbf, 0xdf);
+	/* static */
+	_test_roundtrip(0, CFGFLAG_STATIC_TICKET, 0xbf, 0xff);
+	/* OATH-HOTP, eight digits */
+	_test_roundtrip(TKTFLAG_OATH_HOTP, 0, 0xbf, CFGFLAG_OATH_HOTP8);
+	/* challenge-response */
+	_test_roundtrip(TKTFLAG_CHAL_RESP, CFGFLAG_CHAL_HMAC, 0x80, CFGFLAG_HMAC_LT64 | CFGFLAG_CHAL_BTN_TRIG);
+	_test_roundtrip(TKTFLAG_CHAL_RESP, CFGFLAG_CHAL_YUBICO, 0x80, CFGFLAG_CHAL_BTN_TRIG);
+}
+
+static void _test_ykp_import_ycfg_order(void) {
+	YK_STATUS *st = init_status(3,4,3);
+	YKP_CONFIG *cfg = ykp_alloc();
+	YK_CONFIG ycfg;
+	/* options first, escaped names, unknown members of all kinds, and
+	 * yubiProdConfig and mode where they don't count */
+	char data[] = "\r\n{\"other\":{\"yubiProdConfig\":{\"mode\":\"hmacCR\"}},"
+		"\"yubiProdConfig\" : {\"options\":{\"tab\\u0046irst\":true,"
+		"\"appendCR\":true,\"appendCR\":false,\"mode\":\"hmacCR\","
+		"\"list\":[1,-2.5e3,\"x\\n\",null,{\"a\":[]},[]],\"oathDigits\":8.0,"
+		"\"randomSeed\":false,\"fixedSeedvalue\":32},"
+		"\"scope\":\"\\u00e5\",\"targetConfig\":1,\"mode\":\"oathHOTP\"}}\t";
+
+	ykp_configure_version(cfg, st);
+	assert(ykp_import_config(cfg, data, strlen(data), YKP_FORMAT_YCFG) == 1);
+	ycfg = cfg->ykcore_config;
+	assert(ykp_command(cfg) == SLOT_CONFIG);
+	assert(ycfg.tktFlags == (TKTFLAG_OATH_HOTP | TKTFLAG_TAB_FIRST));
+	assert(ycfg.cfgFlags == CFGFLAG_OATH_HOTP8);
+	assert(ykp_get_oath_imf(cfg) == 32);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+}
+
+static void _test_ykp_import_ycfg_trailing(void) {
+	YK_STATUS *st = init_status(3,4,3);
+	YKP_CONFIG *cfg = ykp_alloc();
+	/* what follows the object is ignored, as json-c did */
+	char data[] = "{\"yubiProdConfig\":{\"mode\":\"oathHOTP\",\"options\":{}}}"
+		" x{\"yubiProdConfig\":{\"mode\":\"hmacCR\"";
+
+	ykp_configure_version(cfg, st);
+	assert(ykp_import_config(cfg, data, strlen(data), YKP_FORMAT_YCFG) == 1);
+	assert(cfg->ykcore_config.tktFlags == TKTFLAG_OATH_HOTP);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+}
+
+static void _test_ykp_import_ycfg_invalid(void) {
+	YK_STATUS *st = init_status(3,4,3);
+	YKP_CONFIG *cfg = ykp_alloc();
+	const char *bad[] = {
+		"",
+		"[]",
+		"{}",
+		"{\"yubiProdConfig\":{\"options\":{}}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\"}}",
+		"{\"yubiProdConfig\":[{\"mode\":\"hmacCR\",\"options\":{}}]}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\",\"options\":[]}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\",\"options\":{}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\",\"options\":{},}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\",\"options\":{\"a\":01}}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\",\"options\":{\"a\":tru}}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmac\\xCR\",\"options\":{}}}",
+		"{\"yubiProdConfig\":{\"mode\":\"hmacCR\",\"options\":{},\"targetConfig\":3}}",
+		"{\"a\":[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]}",
+		NULL
+	};
+	const char *random = "{\"yubiProdConfig\":{\"mode\":\"oathHOTP\",\"options\":{\"randomSeed\":true}}}";
+	int i;
+
+	ykp_configure_version(cfg, st);
+	for (i = 0; bad[i]; i++) {
+		ykp_errno = 0;
+		assert(ykp_import_config(cfg, bad[i], strlen(bad[i]), YKP_FORMAT_YCFG) == 0);
+		assert(ykp_errno == YKP_EINVAL);
+	}
+	ykp_errno = 0;
+	assert(ykp_import_config(cfg, random, strlen(random), YKP_FORMAT_YCFG) == 0);
+	assert(ykp_errno == YKP_ENORANDOM);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+}
+
+static void _test_mode(const YKP_CONFIG *cfg, const char *mode) {
+	char json[1024];
+	char member[64];
+
+	snprintf(member, sizeof(member), "\"mode\":\"%s\"", mode);
+	assert(ykp_export_config(cfg, json, sizeof(json), YKP_FORMAT_YCFG) > 0);
+	assert(strstr(json, member) != NULL);
+}
+
+/* the decoded view follows writes through the setters and the core config */
+static void _test_config_view(void) {
+	YK_STATUS *st = init_status(3,4,3);
+	YKP_CONFIG *cfg = ykp_alloc();
+	YK_CONFIG *ycfg = ykp_core_config(cfg);
+	char json[1024];
+
+	ykp_configure_version(cfg, st);
+	_test_mode(cfg, "yubicoOTP");
+	assert(ykp_get_supported_key_length(cfg) == 16);
+
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_oath_imf(cfg, 16) == 1);
+	_test_mode(cfg, "oathHOTP");
+	assert(ykp_get_supported_key_length(cfg) == 20);
+	assert(ykp_export_config(cfg, json, sizeof(json), YKP_FORMAT_YCFG) > 0);
+	assert(strstr(json, "\"fixedSeedvalue\":16") != NULL);
+
+	ycfg->uid[4] = 0x01;
+	assert(ykp_get_oath_imf(cfg) == 0x1010);
+	assert(ykp_export_config(cfg, json, sizeof(json), YKP_FORMAT_YCFG) > 0);
+	assert(strstr(json, "\"randomSeed\":true") != NULL);
+
+	ycfg->cfgFlags |= CFGFLAG_CHAL_YUBICO;
+	_test_mode(cfg, "yubicoCR");
+	assert(ykp_get_supported_key_length(cfg) == 16);
+	ycfg->tktFlags = 0;
+	ycfg->cfgFlags = CFGFLAG_STATIC_TICKET;
+	_test_mode(cfg, "staticTicket");
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+}
 
 int main(void)
 {
 	_test_ykp_export_ycfg_empty();
 	_test_ykp_import_ycfg_simple();
+	_test_ykp_import_ycfg_roundtrip();
+	_test_ykp_import_ycfg_order();
+	_test_ykp_import_ycfg_trailing();
+	_test_ykp_import_ycfg_invalid();
+	_test_config_view();
 
 	return 0;
 }
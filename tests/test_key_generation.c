@@ -67,6 +67,29 @@ static void _test_160_bits_key(YKP_CONFIG *ykp, struct config_st *cfg)
 	assert(memcmp(cfg->uid, empty, sizeof(cfg->uid)) != 0);
 }
 
+static void _test_key_prf(YKP_CONFIG *ykp, struct config_st *cfg)
+{
+	YK_PRF_METHOD hmac_sha256 = { 32, yk_hmac_sha256 };
+	unsigned char key[sizeof(cfg->key)], uid[sizeof(cfg->uid)];
+
+	memset (cfg, 0, sizeof(struct config_st));
+	cfg->tktFlags = TKTFLAG_APPEND_CR | TKTFLAG_OATH_HOTP;
+
+	/* the defaults are what ykp_AES_key_from_passphrase uses */
+	assert(ykp_AES_key_from_passphrase(ykp, "test", "ABCDEF") == 1);
+	memcpy(key, cfg->key, sizeof(key));
+	memcpy(uid, cfg->uid, sizeof(uid));
+	assert(ykp_key_from_passphrase(ykp, "test", "ABCDEF", NULL, 0) == 1);
+	assert(memcmp(cfg->key, key, sizeof(key)) == 0);
+	assert(memcmp(cfg->uid, uid, sizeof(uid)) == 0);
+
+	assert(ykp_key_from_passphrase(ykp, "test", "ABCDEF", NULL, 1000) == 1);
+	assert(memcmp(cfg->key, key, sizeof(key)) != 0);
+	assert(ykp_key_from_passphrase(ykp, "test", "ABCDEF",
+				       &hmac_sha256, 0) == 1);
+	assert(memcmp(cfg->key, key, sizeof(key)) != 0);
+}
+
 int main (void)
 {
 	YKP_CONFIG *ykp;
@@ -84,6 +107,7 @@ int main (void)
 
 	_test_128_bits_key(ykp, ycfg);
 	_test_160_bits_key(ykp, ycfg);
+	_test_key_prf(ykp, ycfg);
 
 	rc = ykp_free_config(ykp);
 	if (!rc)
@@ -0,0 +1,249 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+static YKP_CONFIG *_test_config(int major, int minor, int build)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+
+	t->versionMajor = major;
+	t->versionMinor = minor;
+	t->versionBuild = build;
+	ykp_configure_version(cfg, st);
+	ykds_free(st);
+
+	return cfg;
+}
+
+/* export cfg, import it into a fresh config for the same firmware and
+ * check that the core configuration survived and exports the same way */
+static void _test_roundtrip(YKP_CONFIG *cfg)
+{
+	YKP_CONFIG *imported = _test_config(3, 4, 3);
+	char buf[1024];
+	char buf2[1024];
+	int len;
+
+	len = ykp_export_config(cfg, buf, sizeof(buf), YKP_FORMAT_LEGACY);
+	assert(len > 0);
+	assert(ykp_import_config(imported, buf, (size_t)len, YKP_FORMAT_LEGACY) == 1);
+	assert(memcmp(ykp_core_config(imported), ykp_core_config(cfg),
+		      offsetof(struct config_st, crc)) == 0);
+	assert(ykp_export_config(imported, buf2, sizeof(buf2), YKP_FORMAT_LEGACY) == len);
+	assert(strcmp(buf, buf2) == 0);
+
+	ykp_free_config(imported);
+}
+
+static void _test_yubico_otp(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	unsigned char uid[] = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16};
+	unsigned char acc_code[] = {0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6};
+
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_set_uid(cfg, uid, sizeof(uid)) == 1);
+	assert(ykp_set_access_code(cfg, acc_code, sizeof(acc_code)) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+	assert(ykp_set_tktflag_APPEND_CR(cfg, true) == 1);
+	assert(ykp_set_tktflag_TAB_FIRST(cfg, true) == 1);
+	assert(ykp_set_cfgflag_PACING_20MS(cfg, true) == 1);
+	assert(ykp_set_extflag_SERIAL_API_VISIBLE(cfg, true) == 1);
+	assert(ykp_set_extflag_ALLOW_UPDATE(cfg, true) == 1);
+	_test_roundtrip(cfg);
+
+	/* no fixed part */
+	assert(ykp_set_fixed(cfg, fixed, 0) == 1);
+	_test_roundtrip(cfg);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_oath_hotp(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_OATH_HOTP8(cfg, true) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_HMAC_key_from_hex(cfg, "303132333435363738393a3b3c3d3e3f40414243") == 0);
+	assert(ykp_set_oath_imf(cfg, 0x1230) == 1);
+	_test_roundtrip(cfg);
+
+	/* each part of the OATH id in modhex */
+	assert(ykp_set_cfgflag_OATH_FIXED_MODHEX1(cfg, true) == 1);
+	_test_roundtrip(cfg);
+	assert(ykp_set_cfgflag_OATH_FIXED_MODHEX1(cfg, false) == 1);
+	assert(ykp_set_cfgflag_OATH_FIXED_MODHEX2(cfg, true) == 1);
+	_test_roundtrip(cfg);
+	assert(ykp_set_cfgflag_OATH_FIXED_MODHEX(cfg, true) == 1);
+	_test_roundtrip(cfg);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_chal_resp(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+
+	assert(ykp_set_tktflag_CHAL_RESP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_CHAL_HMAC(cfg, true) == 1);
+	assert(ykp_set_cfgflag_HMAC_LT64(cfg, true) == 1);
+	assert(ykp_set_cfgflag_CHAL_BTN_TRIG(cfg, true) == 1);
+	assert(ykp_HMAC_key_from_hex(cfg, "303132333435363738393a3b3c3d3e3f40414243") == 0);
+	_test_roundtrip(cfg);
+
+	assert(ykp_set_cfgflag_CHAL_HMAC(cfg, false) == 1);
+	assert(ykp_set_cfgflag_HMAC_LT64(cfg, false) == 1);
+	assert(ykp_set_cfgflag_CHAL_YUBICO(cfg, true) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+	_test_roundtrip(cfg);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_static(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+	unsigned char fixed[FIXED_SIZE];
+
+	memset(fixed, 0x5a, sizeof(fixed));
+	assert(ykp_set_cfgflag_STATIC_TICKET(cfg, true) == 1);
+	assert(ykp_set_cfgflag_STRONG_PW1(cfg, true) == 1);
+	assert(ykp_set_cfgflag_MAN_UPDATE(cfg, true) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	_test_roundtrip(cfg);
+
+	ykp_free_config(cfg);
+}
+
+struct reader_st {
+	const char *data;
+	size_t pos;
+};
+
+/* hand out the data a few bytes at a time */
+static int _reader(char *buf, size_t count, void *userdata)
+{
+	struct reader_st *r = userdata;
+	size_t left = strlen(r->data) - r->pos;
+
+	if (count > 7)
+		count = 7;
+	if (count > left)
+		count = left;
+	memcpy(buf, r->data + r->pos, count);
+	r->pos += count;
+	return (int)count;
+}
+
+static void _test_read_config(void)
+{
+	YKP_CONFIG *cfg = _test_config(2, 2, 3);
+	struct config_st *ycfg = (struct config_st *) ykp_core_config(cfg);
+	struct reader_st r;
+
+	r.data =
+		"fixed: m:cbdefghijklnrtuv\r\n"
+		"uid: 0102030405a6\r\n"
+		"key: h:000102030405060708090a0b0c0d0e0f\r\n"
+		"acc_code: h:000000000000\r\n"
+		"\r\n"
+		"ticket_flags: APPEND_CR|TAB_FIRST\r\n"
+		"config_flags: \r\n"
+		"extended_flags: SERIAL_BTN_VISIBLE\r\n";
+	r.pos = 0;
+	assert(ykp_read_config(cfg, _reader, &r) == 1);
+	assert(ycfg->fixedSize == 8);
+	assert(memcmp(ycfg->fixed, "\x01\x23\x45\x67\x89\xab\xcd\xef", 8) == 0);
+	assert(memcmp(ycfg->uid, "\x01\x02\x03\x04\x05\xa6", UID_SIZE) == 0);
+	assert(ycfg->key[15] == 0x0f);
+	assert(ycfg->tktFlags == (TKTFLAG_APPEND_CR | TKTFLAG_TAB_FIRST));
+	assert(ycfg->cfgFlags == 0);
+	assert(ycfg->extFlags == EXTFLAG_SERIAL_BTN_VISIBLE);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_invalid(void)
+{
+	YKP_CONFIG *cfg = _test_config(2, 2, 3);
+	const char *bad[] = {
+		"fixed: cbdefghijklnrtuv\n",
+		"fixed: m:cbdefghijklnrtu\n",
+		"fixed: m:0123\n",
+		"uid: 01020304\n",
+		"key: h:00010203\n",
+		"acc_code: h:0000000000zz\n",
+		"OATH IMF: h:\n",
+		"ticket_flags: APPEND_CR|NO_SUCH_FLAG\n",
+		"bogus: 1\n",
+		"fixed m:cbdefghijklnrtuv\n",
+		NULL
+	};
+	int i;
+
+	for (i = 0; bad[i]; i++) {
+		ykp_errno = 0;
+		assert(ykp_import_config(cfg, bad[i], strlen(bad[i]), YKP_FORMAT_LEGACY) == 0);
+		assert(ykp_errno == YKP_EINVAL);
+	}
+
+	/* flags the firmware does not have */
+	ykp_errno = 0;
+	assert(ykp_import_config(cfg, "extended_flags: LED_INV\n", 24, YKP_FORMAT_LEGACY) == 0);
+	assert(ykp_errno == YKP_EYUBIKEYVER);
+
+	ykp_free_config(cfg);
+}
+
+int main(void)
+{
+	_test_yubico_otp();
+	_test_oath_hotp();
+	_test_chal_resp();
+	_test_static();
+	_test_read_config();
+	_test_invalid();
+
+	return 0;
+}
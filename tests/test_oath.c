@@ -0,0 +1,160 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+
+static const unsigned char secret[] = "12345678901234567890";
+#define SECRET_LEN 20
+
+/* RFC 4226 appendix D */
+static const unsigned int hotp[] = {
+	755224, 287082, 359152, 969429, 338314,
+	254676, 287922, 162583, 399871, 520489,
+};
+
+/* RFC 6238 appendix B, SHA-1 */
+static const struct {
+	uint64_t time;
+	unsigned int code;
+} totp[] = {
+	{ 59, 94287082 },
+	{ 1111111109, 7081804 },
+	{ 1111111111, 14050471 },
+	{ 1234567890, 89005924 },
+	{ 2000000000, 69279037 },
+	{ 20000000000ULL, 65353130 },
+};
+
+static void _test_hotp(void)
+{
+	unsigned int codes[200], one;
+	uint64_t matched;
+	size_t i;
+
+	assert(ykp_oath_hotp_codes(secret, SECRET_LEN, 0, 10, 6, codes) == 1);
+	for (i = 0; i < 10; i++)
+		assert(codes[i] == hotp[i]);
+
+	/* windows across batches agree with one code at a time */
+	assert(ykp_oath_hotp_codes(secret, SECRET_LEN, 1000, 200, 8,
+				   codes) == 1);
+	for (i = 0; i < 200; i += 13) {
+		assert(ykp_oath_hotp_codes(secret, SECRET_LEN, 1000 + i, 1, 8,
+					   &one) == 1);
+		assert(codes[i] == one);
+	}
+
+	assert(ykp_oath_hotp_validate(secret, SECRET_LEN, 0, 10, 6,
+				      hotp[7], &matched) == 1);
+	assert(matched == 7);
+	assert(ykp_oath_hotp_validate(secret, SECRET_LEN, 8, 2, 6,
+				      hotp[7], &matched) == 0);
+	assert(ykp_errno == 0);
+	/* a drifted token a few batches ahead */
+	assert(ykp_oath_hotp_validate(secret, SECRET_LEN, 1000, 200, 8,
+				      codes[150], &matched) == 1);
+	assert(matched == 1150);
+
+	assert(ykp_oath_hotp_codes(secret, SECRET_LEN, 0, 10, 5, codes) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	assert(ykp_oath_hotp_validate(secret, SECRET_LEN, 0, 10, 6,
+				      hotp[0], NULL) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+}
+
+static void _test_totp(void)
+{
+	int offset;
+	size_t i;
+
+	for (i = 0; i < sizeof(totp) / sizeof(totp[0]); i++) {
+		assert(ykp_oath_totp_validate(secret, SECRET_LEN, totp[i].time,
+					      30, 0, 8, totp[i].code,
+					      &offset) == 1);
+		assert(offset == 0);
+		/* seen from a clock two steps behind or ahead */
+		if (totp[i].time >= 60) {
+			assert(ykp_oath_totp_validate(secret, SECRET_LEN,
+						      totp[i].time - 60, 30, 2,
+						      8, totp[i].code,
+						      &offset) == 1);
+			assert(offset == 2);
+		}
+		assert(ykp_oath_totp_validate(secret, SECRET_LEN,
+					      totp[i].time + 60, 30, 3, 8,
+					      totp[i].code, &offset) == 1);
+		assert(offset == -2);
+		assert(ykp_oath_totp_validate(secret, SECRET_LEN,
+					      totp[i].time + 60, 30, 1, 8,
+					      totp[i].code, &offset) == 0);
+		assert(ykp_errno == 0);
+	}
+
+	/* a window wider than a batch, and one clipped at step 0 */
+	assert(ykp_oath_totp_validate(secret, SECRET_LEN, 59 + 30 * 100, 30,
+				      100, 8, totp[0].code, &offset) == 1);
+	assert(offset == -100);
+	assert(ykp_oath_totp_validate(secret, SECRET_LEN, 0, 30, 5, 6,
+				      hotp[1], &offset) == 1);
+	assert(offset == 1);
+
+	assert(ykp_oath_totp_validate(secret, SECRET_LEN, 59, 0, 1, 8,
+				      totp[0].code, &offset) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+}
+
+static void _test_truncate(void)
+{
+	/* RFC 4226 section 5.4 */
+	const unsigned char hmac[20] = {
+		0x1f, 0x86, 0x98, 0x69, 0x0e, 0x02, 0xca, 0x16, 0x61, 0x85,
+		0x50, 0xef, 0x7f, 0x19, 0xda, 0x8e, 0x94, 0x5b, 0x55, 0x5a,
+	};
+	unsigned int code;
+
+	assert(ykp_oath_truncate(hmac, 6, &code) == 1);
+	assert(code == 872921);
+	assert(ykp_oath_truncate(hmac, 8, &code) == 1);
+	assert(code == 57872921);
+	assert(ykp_oath_truncate(hmac, 9, &code) == 0);
+}
+
+int main(void)
+{
+	_test_truncate();
+	_test_hotp();
+	_test_totp();
+
+	return 0;
+}
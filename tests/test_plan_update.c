@@ -0,0 +1,182 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+static YKP_CONFIG *_test_config(int major, int minor, int build, int confnum)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+	unsigned char acc_code[] = {0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6};
+
+	t->versionMajor = major;
+	t->versionMinor = minor;
+	t->versionBuild = build;
+	assert(ykp_configure_for(cfg, confnum, st) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_set_access_code(cfg, acc_code, sizeof(acc_code)) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+	if (major > 2 || (major == 2 && minor >= 3))
+		assert(ykp_set_extflag_ALLOW_UPDATE(cfg, true) == 1);
+	ykds_free(st);
+
+	return cfg;
+}
+
+static void _test_plan(void)
+{
+	YKP_CONFIG *current = _test_config(3, 4, 3, 2);
+	YKP_CONFIG *target = _test_config(3, 4, 3, 2);
+	YKP_CONFIG *plan = ykp_alloc();
+	unsigned char acc_code[ACC_CODE_SIZE];
+	unsigned char empty[KEY_SIZE];
+	YK_CONFIG *ycfg = ykp_core_config(plan);
+	struct config_st *pcfg = (struct config_st *) ycfg;
+
+	memset(empty, 0, sizeof(empty));
+
+	/* nothing changed */
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_NONE);
+	assert(ykp_command(plan) == SLOT_CONFIG2);
+	assert(memcmp(acc_code, "\xa1\xa2\xa3\xa4\xa5\xa6", ACC_CODE_SIZE) == 0);
+
+	/* a flag in the update mask changed */
+	assert(ykp_set_extflag_FAST_TRIG(target, true) == 1);
+	assert(ykp_set_tktflag_APPEND_CR(target, false) == 1);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_UPDATE);
+	assert(ykp_command(plan) == SLOT_UPDATE2);
+	assert(pcfg->extFlags == (EXTFLAG_FAST_TRIG | EXTFLAG_ALLOW_UPDATE));
+	assert(pcfg->tktFlags == 0);
+	/* the non-updatable flags and the secrets are not sent */
+	assert(pcfg->cfgFlags == 0);
+	assert(memcmp(pcfg->key, empty, KEY_SIZE) == 0);
+	assert(memcmp(pcfg->accCode, "\xa1\xa2\xa3\xa4\xa5\xa6", ACC_CODE_SIZE) == 0);
+	assert(memcmp(acc_code, "\xa1\xa2\xa3\xa4\xa5\xa6", ACC_CODE_SIZE) == 0);
+
+	/* so does the access code, the old one is used for the write */
+	assert(ykp_set_access_code(target, (unsigned char *)"\xb1\xb2\xb3\xb4\xb5\xb6", ACC_CODE_SIZE) == 1);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_UPDATE);
+	assert(memcmp(pcfg->accCode, "\xb1\xb2\xb3\xb4\xb5\xb6", ACC_CODE_SIZE) == 0);
+	assert(memcmp(acc_code, "\xa1\xa2\xa3\xa4\xa5\xa6", ACC_CODE_SIZE) == 0);
+
+	/* a flag outside the mask needs a full write */
+	assert(ykp_set_cfgflag_SHORT_TICKET(target, true) == 1);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_CONFIG);
+	assert(ykp_command(plan) == SLOT_CONFIG2);
+	assert(memcmp(ycfg, ykp_core_config(target), sizeof(struct config_st)) == 0);
+	assert(ykp_set_cfgflag_SHORT_TICKET(target, false) == 1);
+
+	/* and so does a new key */
+	assert(ykp_AES_key_from_hex(target, "ffeeddccbbaa99887766554433221100") == 0);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_CONFIG);
+	assert(ykp_AES_key_from_hex(target, "00112233445566778899aabbccddeeff") == 0);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_UPDATE);
+
+	/* or a key that does not allow updates */
+	assert(ykp_set_extflag_ALLOW_UPDATE(current, false) == 1);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_CONFIG);
+
+	ykp_free_config(current);
+	ykp_free_config(target);
+	ykp_free_config(plan);
+}
+
+static void _test_plan_in_place(void)
+{
+	YKP_CONFIG *current = _test_config(3, 4, 3, 1);
+	YKP_CONFIG *target = _test_config(3, 4, 3, 1);
+	unsigned char acc_code[ACC_CODE_SIZE];
+	struct config_st *tcfg = (struct config_st *) ykp_core_config(target);
+
+	/* the plan may replace the target */
+	assert(ykp_set_extflag_FAST_TRIG(target, true) == 1);
+	assert(ykp_set_access_code(target, (unsigned char *)"\xb1\xb2\xb3\xb4\xb5\xb6", ACC_CODE_SIZE) == 1);
+	assert(ykp_plan_update(current, target, target, acc_code) == YKP_PLAN_UPDATE);
+	assert(ykp_command(target) == SLOT_UPDATE1);
+	assert(tcfg->extFlags == (EXTFLAG_FAST_TRIG | EXTFLAG_ALLOW_UPDATE));
+	assert(tcfg->tktFlags == TKTFLAG_APPEND_CR);
+	assert(memcmp(tcfg->accCode, "\xb1\xb2\xb3\xb4\xb5\xb6", ACC_CODE_SIZE) == 0);
+	assert(memcmp(acc_code, "\xa1\xa2\xa3\xa4\xa5\xa6", ACC_CODE_SIZE) == 0);
+
+	/* or the current configuration */
+	assert(ykp_AES_key_from_hex(target, "ffeeddccbbaa99887766554433221100") == 0);
+	assert(ykp_plan_update(current, target, current, acc_code) == YKP_PLAN_CONFIG);
+	assert(ykp_command(current) == SLOT_CONFIG);
+	assert(memcmp(acc_code, "\xa1\xa2\xa3\xa4\xa5\xa6", ACC_CODE_SIZE) == 0);
+	assert(memcmp(ykp_core_config(current), tcfg, sizeof(struct config_st)) == 0);
+
+	ykp_free_config(current);
+	ykp_free_config(target);
+}
+
+static void _test_plan_invalid(void)
+{
+	YKP_CONFIG *current = _test_config(2, 2, 3, 1);
+	YKP_CONFIG *target = _test_config(2, 2, 3, 1);
+	YKP_CONFIG *other = _test_config(2, 2, 3, 2);
+	YKP_CONFIG *plan = ykp_alloc();
+	unsigned char acc_code[ACC_CODE_SIZE];
+
+	/* firmware before 2.3 can not update */
+	((struct config_st *) ykp_core_config(current))->extFlags |= EXTFLAG_ALLOW_UPDATE;
+	((struct config_st *) ykp_core_config(target))->extFlags |= EXTFLAG_ALLOW_UPDATE;
+	assert(ykp_set_tktflag_TAB_FIRST(target, true) == 1);
+	assert(ykp_plan_update(current, target, plan, acc_code) == YKP_PLAN_CONFIG);
+	assert(ykp_command(plan) == SLOT_CONFIG);
+
+	assert(ykp_plan_update(current, other, plan, acc_code) == 0);
+	assert(ykp_errno == YKP_EINVCONFNUM);
+	assert(ykp_plan_update(current, NULL, plan, acc_code) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+	ykp_errno = 0;
+	assert(ykp_plan_update(current, target, plan, NULL) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+
+	ykp_free_config(current);
+	ykp_free_config(target);
+	ykp_free_config(other);
+	ykp_free_config(plan);
+}
+
+int main(void)
+{
+	_test_plan();
+	_test_plan_in_place();
+	_test_plan_invalid();
+
+	return 0;
+}
@@ -0,0 +1,222 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ykpers_lcl.h"
+#include <ykpers.h>
+#include <ykdef.h>
+#include <yubikey.h>
+
+#define RECORD_FILE "test_records.tmp"
+
+static YKP_CONFIG *_test_config(int n)
+{
+	YKP_CONFIG *cfg = ykp_alloc();
+	YK_CONFIG *ycfg = &cfg->ykcore_config;
+	int i;
+
+	cfg->yk_major_version = 3;
+	cfg->yk_minor_version = 4;
+	cfg->yk_build_version = n & 0xff;
+	cfg->command = n & 1 ? SLOT_CONFIG2 : SLOT_CONFIG;
+	cfg->ykp_acccode_type = YKP_ACCCODE_SERIAL;
+	for (i = 0; i < (int)sizeof(*ycfg); i++)
+		((unsigned char *)ycfg)[i] = (unsigned char)(n + i);
+	ycfg->crc = 0;
+
+	return cfg;
+}
+
+static void _test_same(const YKP_CONFIG *a, const YKP_CONFIG *b)
+{
+	assert(a->yk_major_version == b->yk_major_version);
+	assert(a->yk_minor_version == b->yk_minor_version);
+	assert(a->yk_build_version == b->yk_build_version);
+	assert(a->command == b->command);
+	assert(a->ykp_acccode_type == b->ykp_acccode_type);
+	assert(memcmp(&a->ykcore_config, &b->ykcore_config,
+		      sizeof(YK_CONFIG)) == 0);
+}
+
+static void _test_record(void)
+{
+	YKP_CONFIG *cfg = _test_config(7);
+	YKP_CONFIG *cfg2 = ykp_alloc();
+	unsigned char rec[YKP_RECORD_SIZE + 1];
+	unsigned int serial = 0;
+
+	assert(ykp_export_record(cfg, 0x01020304, rec, sizeof(rec)) == 1);
+	assert(rec[0] == 0x01);
+	assert(yubikey_crc16(rec, YKP_RECORD_SIZE) == YK_CRC_OK_RESIDUAL);
+	assert(memcmp(rec + 8, "\x01\x02\x03\x04", 4) == 0);
+	assert(ykp_import_record(cfg2, &serial, rec, YKP_RECORD_SIZE) == 1);
+	assert(serial == 0x01020304);
+	_test_same(cfg, cfg2);
+	assert(ykp_import_record(cfg2, NULL, rec, YKP_RECORD_SIZE) == 1);
+
+	ykp_errno = 0;
+	assert(ykp_export_record(cfg, 1, rec, YKP_RECORD_SIZE - 1) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	ykp_errno = 0;
+	assert(ykp_import_record(cfg2, &serial, rec, YKP_RECORD_SIZE - 1) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	ykp_errno = 0;
+	assert(ykp_export_record(NULL, 1, rec, sizeof(rec)) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+	ykp_errno = 0;
+	assert(ykp_import_record(NULL, &serial, rec, sizeof(rec)) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+
+	/* any change is caught by the crc */
+	rec[20] ^= 0x10;
+	ykp_errno = 0;
+	assert(ykp_import_record(cfg2, &serial, rec, YKP_RECORD_SIZE) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	rec[20] ^= 0x10;
+	rec[0] = 0x02;
+	ykp_errno = 0;
+	assert(ykp_import_record(cfg2, &serial, rec, YKP_RECORD_SIZE) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	/* only what fits in a byte */
+	cfg->yk_build_version = 256;
+	ykp_errno = 0;
+	assert(ykp_export_record(cfg, 1, rec, sizeof(rec)) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	ykp_free_config(cfg);
+	ykp_free_config(cfg2);
+}
+
+static void _test_get(YKP_RECORD_FILE *file, size_t index)
+{
+	YKP_CONFIG *cfg = _test_config((int)index);
+	YKP_CONFIG *cfg2 = ykp_alloc();
+	unsigned int serial = 0;
+
+	assert(ykp_record_file_get(file, index, &serial, cfg2) == 1);
+	assert(serial == 1000000 + index);
+	_test_same(cfg, cfg2);
+
+	ykp_free_config(cfg);
+	ykp_free_config(cfg2);
+}
+
+static void _test_append(YKP_RECORD_FILE *file, size_t index)
+{
+	YKP_CONFIG *cfg = _test_config((int)index);
+
+	assert(ykp_record_file_append(file, cfg, 1000000 + index) == 1);
+	ykp_free_config(cfg);
+}
+
+static void _test_file(void)
+{
+	YKP_CONFIG *cfg = ykp_alloc();
+	YKP_RECORD_FILE *file;
+	FILE *f;
+	size_t i;
+
+	remove(RECORD_FILE);
+	file = ykp_record_file_open(RECORD_FILE);
+	assert(file != NULL);
+	assert(ykp_record_file_count(file) == 0);
+	ykp_errno = 0;
+	assert(ykp_record_file_get(file, 0, NULL, cfg) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	/* reads between appends see the records appended since */
+	for (i = 0; i < 10; i++) {
+		_test_append(file, i);
+		_test_get(file, i);
+		_test_get(file, 0);
+	}
+	for (; i < 300; i++)
+		_test_append(file, i);
+	assert(ykp_record_file_count(file) == 300);
+	assert(ykp_record_file_sync(file) == 1);
+	assert(ykp_record_file_close(file) == 1);
+
+	/* an interrupted append */
+	f = fopen(RECORD_FILE, "ab");
+	assert(f != NULL);
+	assert(fwrite("\x01\x03\x04", 1, 3, f) == 3);
+	assert(fclose(f) == 0);
+
+	file = ykp_record_file_open(RECORD_FILE);
+	assert(file != NULL);
+	assert(ykp_record_file_count(file) == 300);
+	for (i = 300; i > 0; i--)
+		_test_get(file, i - 1);
+	_test_append(file, 300);
+	_test_get(file, 300);
+	ykp_errno = 0;
+	assert(ykp_record_file_get(file, 301, NULL, cfg) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	assert(ykp_record_file_close(file) == 1);
+
+	/* a damaged record */
+	f = fopen(RECORD_FILE, "r+b");
+	assert(f != NULL);
+	assert(fseek(f, 5 * YKP_RECORD_SIZE + 30, SEEK_SET) == 0);
+	assert(fputc(0xff, f) != EOF);
+	assert(fclose(f) == 0);
+
+	file = ykp_record_file_open(RECORD_FILE);
+	assert(file != NULL);
+	assert(ykp_record_file_count(file) == 301);
+	_test_get(file, 4);
+	ykp_errno = 0;
+	assert(ykp_record_file_get(file, 5, NULL, cfg) == 0);
+	assert(ykp_errno == YKP_EIO);
+	_test_get(file, 6);
+	assert(ykp_record_file_close(file) == 1);
+
+	assert(ykp_record_file_close(NULL) == 0);
+	assert(ykp_record_file_count(NULL) == 0);
+	ykp_errno = 0;
+	assert(ykp_record_file_append(NULL, cfg, 1) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+
+	remove(RECORD_FILE);
+	ykp_free_config(cfg);
+}
+
+int main(void)
+{
+	_test_record();
+	_test_file();
+
+	return 0;
+}
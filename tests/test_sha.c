@@ -0,0 +1,358 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "sha.h"
+
+/* FIPS 180-2 and RFC 4634 test vectors */
+static const struct {
+	SHAversion which;
+	const char *text;
+	unsigned int repeat;
+	const char *digest;
+} vectors[] = {
+	{ SHA1, "", 1, "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+	{ SHA1, "abc", 1, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+	{ SHA1, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+	  "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+	{ SHA1, "a", 1000000, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+	{ SHA1, "01234567012345670123456701234567"
+	  "01234567012345670123456701234567", 10,
+	  "dea356a2cddd90c7a7ecedc5ebb563934f460452" },
+	{ SHA224, "abc", 1,
+	  "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7" },
+	{ SHA256, "", 1,
+	  "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+	{ SHA256, "abc", 1,
+	  "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+	{ SHA256, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+	  "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+	{ SHA256, "a", 1000000,
+	  "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+	{ SHA384, "abc", 1,
+	  "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded163"
+	  "1a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7" },
+	{ SHA512, "", 1,
+	  "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+	  "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" },
+	{ SHA512, "abc", 1,
+	  "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+	  "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" },
+	{ SHA512, "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+	  "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+	  "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+	  "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909" },
+	{ SHA512, "a", 1000000,
+	  "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+	  "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+};
+
+/* RFC 2202 and RFC 4231 */
+static const struct {
+	SHAversion which;
+	const char *key;
+	int key_len;
+	const char *text;
+	const char *mac;
+} hmac_vectors[] = {
+	{ SHA1, "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b"
+	  "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b", 20, "Hi There",
+	  "b617318655057264e28bc0b6fb378c8ef146be00" },
+	{ SHA1, "Jefe", 4, "what do ya want for nothing?",
+	  "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79" },
+	{ SHA512, "Jefe", 4, "what do ya want for nothing?",
+	  "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+	  "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737" },
+};
+
+/* Limits tried, each falls back to the next kernel down */
+static const unsigned int masks[] = {
+	SHA_CPU_ALL,
+	SHA_CPU_ALL & ~SHA_CPU_SHA,
+	SHA_CPU_ALL & ~(SHA_CPU_SHA | SHA_CPU_AVX512),
+	SHA_CPU_SSSE3 | SHA_CPU_SSE41,
+	0,
+};
+
+static void _hex(const uint8_t *digest, size_t len, char *out)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		sprintf(out + 2 * i, "%02x", digest[i]);
+}
+
+static void _test_vectors(void)
+{
+	uint8_t digest[USHAMaxHashSize];
+	char hex[2 * USHAMaxHashSize + 1];
+	size_t i;
+	unsigned int r;
+
+	for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		USHAContext ctx;
+
+		assert(USHAReset(&ctx, vectors[i].which) == shaSuccess);
+		for (r = 0; r < vectors[i].repeat; r++)
+			assert(USHAInput(&ctx, (const uint8_t *) vectors[i].text,
+					 strlen(vectors[i].text)) == shaSuccess);
+		assert(USHAResult(&ctx, digest) == shaSuccess);
+		_hex(digest, USHAHashSize(vectors[i].which), hex);
+		assert(strcmp(hex, vectors[i].digest) == 0);
+	}
+
+	for (i = 0; i < sizeof(hmac_vectors) / sizeof(hmac_vectors[0]); i++) {
+		assert(hmac(hmac_vectors[i].which,
+			    (const unsigned char *) hmac_vectors[i].text,
+			    (int) strlen(hmac_vectors[i].text),
+			    (const unsigned char *) hmac_vectors[i].key,
+			    hmac_vectors[i].key_len, digest) == shaSuccess);
+		_hex(digest, USHAHashSize(hmac_vectors[i].which), hex);
+		assert(strcmp(hex, hmac_vectors[i].mac) == 0);
+	}
+}
+
+/* Every length up to a few blocks, in one piece and split at every
+ * point, has to hash the same as with the portable code. */
+#define MAXLEN 600
+static const SHAversion hashes[] = { SHA1, SHA256, SHA512 };
+#define NHASHES (sizeof(hashes) / sizeof(hashes[0]))
+static uint8_t expected[NHASHES][MAXLEN + 2][USHAMaxHashSize];
+
+static void _test_lengths(SHAversion which, uint8_t want[][USHAMaxHashSize],
+			  int record)
+{
+	uint8_t msg[MAXLEN];
+	uint8_t digest[USHAMaxHashSize];
+	USHAContext ctx;
+	int size = USHAHashSize(which);
+	unsigned int len, split;
+
+	for (len = 0; len < MAXLEN; len++)
+		msg[len] = (uint8_t) (len * 7 + 3);
+
+	for (len = 0; len <= MAXLEN; len++) {
+		USHAReset(&ctx, which);
+		USHAInput(&ctx, msg, len);
+		USHAResult(&ctx, digest);
+		if (record)
+			memcpy(want[len], digest, size);
+		else
+			assert(memcmp(want[len], digest, size) == 0);
+
+		for (split = 1; split < len; split += 13) {
+			USHAReset(&ctx, which);
+			USHAInput(&ctx, msg, split);
+			USHAInput(&ctx, msg + split, len - split);
+			USHAResult(&ctx, digest);
+			assert(memcmp(want[len], digest, size) == 0);
+		}
+	}
+
+	/* final bits after whole blocks */
+	USHAReset(&ctx, which);
+	USHAInput(&ctx, msg, 512);
+	assert(USHAFinalBits(&ctx, 0x80, 3) == shaSuccess);
+	USHAResult(&ctx, digest);
+	if (record)
+		memcpy(want[MAXLEN + 1], digest, size);
+	else
+		assert(memcmp(want[MAXLEN + 1], digest, size) == 0);
+}
+
+/* Batches of every size up to a few groups of lanes, with keys and
+ * texts of all the lengths that change the padding, against hmac(). */
+static void _test_multi(void)
+{
+	HMACSHA1Job jobs[40];
+	uint8_t data[128];
+	uint8_t digest[USHAMaxHashSize];
+	int n, i;
+
+	for (i = 0; i < (int) sizeof(data); i++)
+		data[i] = (uint8_t) (i * 13 + 1);
+
+	for (n = 0; n <= 40; n++) {
+		for (i = 0; i < n; i++) {
+			jobs[i].key = data + i;
+			jobs[i].key_len = (i * 7) % 90;
+			jobs[i].text = data + 40 - i;
+			jobs[i].text_len = (i * 11 + n) % 65;
+		}
+		assert(hmacSHA1Multi(jobs, n) == shaSuccess);
+		for (i = 0; i < n; i++) {
+			assert(hmac(SHA1, jobs[i].text, jobs[i].text_len,
+				    jobs[i].key, jobs[i].key_len,
+				    digest) == shaSuccess);
+			assert(memcmp(jobs[i].digest, digest, SHA1HashSize) == 0);
+		}
+	}
+
+	/* RFC 2202 through the lanes */
+	for (i = 0; i < 8; i++) {
+		jobs[i].key = (const unsigned char *) hmac_vectors[1].key;
+		jobs[i].key_len = hmac_vectors[1].key_len;
+		jobs[i].text = (const unsigned char *) hmac_vectors[1].text;
+		jobs[i].text_len = (int) strlen(hmac_vectors[1].text);
+	}
+	assert(hmacSHA1Multi(jobs, 8) == shaSuccess);
+	for (i = 0; i < 8; i++) {
+		char hex[2 * SHA1HashSize + 1];
+
+		_hex(jobs[i].digest, SHA1HashSize, hex);
+		assert(strcmp(hex, hmac_vectors[1].mac) == 0);
+	}
+
+	jobs[3].text_len = 65;
+	assert(hmacSHA1Multi(jobs, 8) == shaBadParam);
+	jobs[3].text_len = 4;
+	jobs[3].text = NULL;
+	assert(hmacSHA1Multi(jobs, 8) == shaNull);
+	assert(hmacSHA1Multi(NULL, 0) == shaSuccess);
+}
+
+/* Keyed contexts against hmac(), each used for many texts, with keys
+ * shorter and longer than a block. */
+static void _test_keyed(void)
+{
+	HMACKeyed keyed;
+	uint8_t data[300];
+	uint8_t digest[USHAMaxHashSize], want[USHAMaxHashSize];
+	size_t h;
+	int key_len, text_len;
+
+	for (key_len = 0; key_len < (int) sizeof(data); key_len++)
+		data[key_len] = (uint8_t) (key_len * 7 + 3);
+
+	for (h = 0; h < NHASHES; h++) {
+		int size = USHAHashSize(hashes[h]);
+
+		for (key_len = 0; key_len <= 140; key_len += 20) {
+			assert(hmacKeyedReset(&keyed, hashes[h], data + 1,
+					      key_len) == shaSuccess);
+			for (text_len = 0; text_len <= 260; text_len += 13) {
+				assert(hmacKeyedResult(&keyed, data + 17,
+						       text_len,
+						       digest) == shaSuccess);
+				assert(hmac(hashes[h], data + 17, text_len,
+					    data + 1, key_len,
+					    want) == shaSuccess);
+				assert(memcmp(digest, want, size) == 0);
+			}
+		}
+	}
+
+	for (h = 0; h < sizeof(hmac_vectors) / sizeof(hmac_vectors[0]); h++) {
+		char hex[2 * USHAMaxHashSize + 1];
+
+		assert(hmacKeyedReset(&keyed, hmac_vectors[h].which,
+				      (const unsigned char *) hmac_vectors[h].key,
+				      hmac_vectors[h].key_len) == shaSuccess);
+		assert(hmacKeyedResult(&keyed,
+				       (const unsigned char *) hmac_vectors[h].text,
+				       (int) strlen(hmac_vectors[h].text),
+				       digest) == shaSuccess);
+		_hex(digest, USHAHashSize(hmac_vectors[h].which), hex);
+		assert(strcmp(hex, hmac_vectors[h].mac) == 0);
+	}
+
+	assert(hmacKeyedReset(NULL, SHA1, data, 4) == shaNull);
+	assert(hmacKeyedResult(NULL, data, 4, digest) == shaNull);
+}
+
+/* Shared-key batches of every size up to a few groups of lanes and
+ * every text length that pads to one block, against hmac(). */
+static void _test_keyed_multi(void)
+{
+	HMACKeyed keyed;
+	uint8_t data[40 * 55];
+	uint8_t digests[40][SHA1HashSize];
+	uint8_t digest[USHAMaxHashSize];
+	int n, i, text_len;
+
+	for (i = 0; i < (int) sizeof(data); i++)
+		data[i] = (uint8_t) (i * 17 + 9);
+
+	assert(hmacKeyedReset(&keyed, SHA1, data + 3, 20) == shaSuccess);
+	for (n = 0; n <= 40; n++) {
+		text_len = (n * 7) % 56;
+		assert(hmacSHA1KeyedMulti(&keyed, data, text_len, n,
+					  digests) == shaSuccess);
+		for (i = 0; i < n; i++) {
+			assert(hmac(SHA1, data + i * text_len, text_len,
+				    data + 3, 20, digest) == shaSuccess);
+			assert(memcmp(digests[i], digest, SHA1HashSize) == 0);
+		}
+	}
+	for (text_len = 0; text_len <= 55; text_len++) {
+		assert(hmacSHA1KeyedMulti(&keyed, data, text_len, 19,
+					  digests) == shaSuccess);
+		for (i = 0; i < 19; i++) {
+			assert(hmac(SHA1, data + i * text_len, text_len,
+				    data + 3, 20, digest) == shaSuccess);
+			assert(memcmp(digests[i], digest, SHA1HashSize) == 0);
+		}
+	}
+
+	assert(hmacSHA1KeyedMulti(&keyed, data, 56, 4, digests) == shaBadParam);
+	assert(hmacSHA1KeyedMulti(NULL, data, 8, 4, digests) == shaNull);
+	assert(hmacSHA1KeyedMulti(&keyed, data, 8, 0, NULL) == shaSuccess);
+	assert(hmacKeyedReset(&keyed, SHA256, data, 20) == shaSuccess);
+	assert(hmacSHA1KeyedMulti(&keyed, data, 8, 4, digests) == shaBadParam);
+}
+
+int main(void)
+{
+	unsigned int found = SHASetCPUFeatures(0);
+	size_t i, h;
+
+	_test_vectors();
+	_test_multi();
+	_test_keyed();
+	_test_keyed_multi();
+	for (h = 0; h < NHASHES; h++)
+		_test_lengths(hashes[h], expected[h], 1);
+
+	for (i = 0; i < sizeof(masks) / sizeof(masks[0]); i++) {
+		SHASetCPUFeatures(masks[i]);
+		assert(SHACPUFeatures() == (found & masks[i]));
+		_test_vectors();
+		_test_multi();
+		_test_keyed();
+		_test_keyed_multi();
+		for (h = 0; h < NHASHES; h++)
+			_test_lengths(hashes[h], expected[h], 0);
+	}
+
+	return 0;
+}
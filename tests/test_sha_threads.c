@@ -0,0 +1,215 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Hashes on as many threads as there are cores, at least two, all
+ * sharing keyed HMAC contexts, and checks every digest against the
+ * ones computed beforehand on one thread. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+#include "sha.h"
+
+#define NMSGS 64
+#define MAXLEN 700
+#define ROUNDS 16
+#define MAXTHREADS 64
+
+static const SHAversion hashes[] = { SHA1, SHA224, SHA256, SHA384, SHA512 };
+#define NHASHES (sizeof(hashes) / sizeof(hashes[0]))
+
+static uint8_t data[NMSGS + MAXLEN];
+static HMACKeyed keyed[NHASHES];
+static uint8_t expected[NMSGS][NHASHES][2][USHAMaxHashSize];
+
+struct share {
+	int id;
+	int failures;
+	unsigned long bytes;
+};
+
+static int _msg_len(int msg)
+{
+	return (msg * 37) % MAXLEN;
+}
+
+/* the SHA and keyed HMAC digests of one message */
+static int _digests(int msg, size_t h, uint8_t sha[USHAMaxHashSize],
+		    uint8_t mac[USHAMaxHashSize])
+{
+	USHAContext ctx;
+
+	return USHAReset(&ctx, hashes[h]) ||
+		USHAInput(&ctx, data + msg, _msg_len(msg)) ||
+		USHAResult(&ctx, sha) ||
+		hmacKeyedResult(&keyed[h], data + msg, _msg_len(msg), mac);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI _hash_thread(LPVOID arg)
+#else
+static void *_hash_thread(void *arg)
+#endif
+{
+	struct share *share = arg;
+	uint8_t sha[USHAMaxHashSize], mac[USHAMaxHashSize];
+	int round, i;
+	size_t h;
+
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < NMSGS; i++) {
+			/* threads start at different messages */
+			int msg = (i + share->id * 7) % NMSGS;
+
+			for (h = 0; h < NHASHES; h++) {
+				int size = USHAHashSize(hashes[h]);
+
+				if (_digests(msg, h, sha, mac) ||
+				    memcmp(sha, expected[msg][h][0], size) ||
+				    memcmp(mac, expected[msg][h][1], size))
+					share->failures++;
+				share->bytes += _msg_len(msg);
+			}
+		}
+	}
+#ifdef _WIN32
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
+static int _cores(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+	return (int) info.dwNumberOfProcessors;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return n > 0 ? (int) n : 1;
+#endif
+}
+
+static double _now(void)
+{
+#ifdef _WIN32
+	return GetTickCount() / 1e3;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void _test_threads(int nthreads)
+{
+#ifdef _WIN32
+	HANDLE threads[MAXTHREADS];
+#else
+	pthread_t threads[MAXTHREADS];
+#endif
+	struct share shares[MAXTHREADS];
+	unsigned long bytes = 0;
+	double secs;
+	int i;
+
+	secs = _now();
+	for (i = 0; i < nthreads; i++) {
+		shares[i].id = i;
+		shares[i].failures = 0;
+		shares[i].bytes = 0;
+#ifdef _WIN32
+		threads[i] = CreateThread(NULL, 0, _hash_thread, &shares[i],
+					  0, NULL);
+		assert(threads[i] != NULL);
+#else
+		assert(pthread_create(&threads[i], NULL, _hash_thread,
+				      &shares[i]) == 0);
+#endif
+	}
+	for (i = 0; i < nthreads; i++) {
+#ifdef _WIN32
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+#else
+		pthread_join(threads[i], NULL);
+#endif
+		assert(shares[i].failures == 0);
+		bytes += shares[i].bytes;
+	}
+	secs = _now() - secs;
+
+	printf("%d threads: %.1f MB in %.3f s, %.1f MB/s\n", nthreads,
+	       bytes / 1048576.0, secs, secs > 0 ? bytes / 1048576.0 / secs : 0);
+}
+
+int main(void)
+{
+	uint8_t key[100];
+	int nthreads = _cores();
+	int i;
+	size_t h;
+
+	if (nthreads < 2)
+		nthreads = 2;
+	if (nthreads > MAXTHREADS)
+		nthreads = MAXTHREADS;
+
+	for (i = 0; i < (int) sizeof(data); i++)
+		data[i] = (uint8_t) (i * 11 + 5);
+	for (i = 0; i < (int) sizeof(key); i++)
+		key[i] = (uint8_t) (i * 3 + 1);
+	for (h = 0; h < NHASHES; h++)
+		assert(hmacKeyedReset(&keyed[h], hashes[h], key,
+				      20 + (int) h * 20) == shaSuccess);
+
+	for (i = 0; i < NMSGS; i++)
+		for (h = 0; h < NHASHES; h++)
+			assert(_digests(i, h, expected[i][h][0],
+					expected[i][h][1]) == shaSuccess);
+
+	_test_threads(nthreads);
+
+	return 0;
+}
@@ -0,0 +1,251 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ykpers_lcl.h"
+#include <ykpers.h>
+#include <ykdef.h>
+
+/* A Yubico OTP configuration for slot 1 of a key of the given version,
+ * with a key set. */
+static YKP_CONFIG *_test_config(int major, int minor, int build)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+
+	t->versionMajor = major;
+	t->versionMinor = minor;
+	t->versionBuild = build;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	assert(ykp_AES_key_from_hex(cfg, "00112233445566778899aabbccddeeff") == 0);
+	ykds_free(st);
+
+	return cfg;
+}
+
+static unsigned int _test_report(const YKP_CONFIG *cfg)
+{
+	unsigned int report = 0xffff;
+
+	ykp_errno = 0;
+	if (ykp_validate_config(cfg, &report) == 1) {
+		assert(report == 0);
+	} else {
+		assert(report != 0);
+		assert(ykp_errno == YKP_EINVAL);
+	}
+	return report;
+}
+
+static void _test_valid(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+
+	assert(ykp_set_tktflag_APPEND_CR(cfg, true) == 1);
+	assert(ykp_set_extflag_SERIAL_API_VISIBLE(cfg, true) == 1);
+	assert(ykp_validate_config(cfg, NULL) == 1);
+	assert(_test_report(cfg) == 0);
+
+	/* OATH-HOTP with an IMF */
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_OATH_HOTP8(cfg, true) == 1);
+	assert(ykp_set_oath_imf(cfg, 32) == 1);
+	assert(_test_report(cfg) == 0);
+
+	/* HMAC-SHA1 with the key only in the uid part */
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, false) == 1);
+	assert(ykp_set_cfgflag_OATH_HOTP8(cfg, false) == 1);
+	assert(ykp_set_tktflag_APPEND_CR(cfg, false) == 1);
+	assert(ykp_set_tktflag_CHAL_RESP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_CHAL_HMAC(cfg, true) == 1);
+	memset(cfg->ykcore_config.key, 0, KEY_SIZE);
+	cfg->ykcore_config.uid[0] = 0x01;
+	assert(_test_report(cfg) == 0);
+
+	ykp_free_config(cfg);
+
+	ykp_errno = 0;
+	assert(ykp_validate_config(NULL, NULL) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+}
+
+static void _test_flags(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+	YKP_CONFIG *v1 = _test_config(1, 3, 0);
+	YKP_CONFIG *v20 = _test_config(2, 0, 0);
+
+	/* only on YubiKey 1 */
+	cfg->ykcore_config.cfgFlags = CFGFLAG_ALLOW_HIDTRIG;
+	assert(_test_report(cfg) == YKP_VALIDATE_CFGFLAGS);
+	v1->ykcore_config.cfgFlags = CFGFLAG_ALLOW_HIDTRIG;
+	assert(_test_report(v1) == 0);
+
+	/* only with static tickets */
+	cfg->ykcore_config.cfgFlags = CFGFLAG_STRONG_PW1;
+	assert(_test_report(cfg) == YKP_VALIDATE_CFGFLAGS);
+	cfg->ykcore_config.cfgFlags = CFGFLAG_STRONG_PW1 | CFGFLAG_STATIC_TICKET;
+	assert(_test_report(cfg) == 0);
+
+	/* not in challenge-response mode */
+	cfg->ykcore_config.tktFlags = TKTFLAG_CHAL_RESP | TKTFLAG_APPEND_CR;
+	cfg->ykcore_config.cfgFlags = CFGFLAG_CHAL_YUBICO;
+	assert(_test_report(cfg) == YKP_VALIDATE_TKTFLAGS);
+
+	/* extended flags are for later keys */
+	v20->ykcore_config.extFlags = EXTFLAG_DORMANT;
+	assert(_test_report(v20) == YKP_VALIDATE_EXTFLAGS);
+
+	/* a mode the key doesn't have; OATH_HOTP8 reads as SEND_REF here */
+	v20->ykcore_config.extFlags = 0;
+	v20->ykcore_config.tktFlags = TKTFLAG_OATH_HOTP;
+	v20->ykcore_config.cfgFlags = CFGFLAG_OATH_HOTP8;
+	assert(_test_report(v20) == (YKP_VALIDATE_MODE | YKP_VALIDATE_TKTFLAGS));
+
+	ykp_free_config(cfg);
+	ykp_free_config(v1);
+	ykp_free_config(v20);
+}
+
+static void _test_command(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+	YKP_CONFIG *v1 = _test_config(1, 3, 0);
+	YKP_CONFIG *v22 = _test_config(2, 2, 0);
+
+	v1->command = SLOT_CONFIG2;
+	assert(_test_report(v1) == YKP_VALIDATE_COMMAND);
+	v22->command = SLOT_UPDATE1;
+	assert(_test_report(v22) == YKP_VALIDATE_COMMAND);
+	cfg->command = SLOT_NDEF;
+	assert(_test_report(cfg) == YKP_VALIDATE_COMMAND);
+
+	/* an update carries no key, and only some flags */
+	cfg->command = SLOT_UPDATE2;
+	memset(cfg->ykcore_config.key, 0, KEY_SIZE);
+	cfg->ykcore_config.tktFlags = TKTFLAG_APPEND_CR;
+	cfg->ykcore_config.extFlags = EXTFLAG_ALLOW_UPDATE;
+	assert(_test_report(cfg) == 0);
+	cfg->ykcore_config.tktFlags |= TKTFLAG_PROTECT_CFG2;
+	assert(_test_report(cfg) == YKP_VALIDATE_UPDATE);
+
+	ykp_free_config(cfg);
+	ykp_free_config(v1);
+	ykp_free_config(v22);
+}
+
+static void _test_key(void)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+
+	/* a default configuration has no key yet */
+	t->versionMajor = 3;
+	t->versionMinor = 4;
+	t->versionBuild = 3;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	assert(ykp_get_supported_key_length(cfg) == 16);
+	assert(_test_report(cfg) == YKP_VALIDATE_KEY);
+	/* the uid is not part of a 16 byte key */
+	cfg->ykcore_config.uid[0] = 0x01;
+	assert(_test_report(cfg) == YKP_VALIDATE_KEY);
+	cfg->ykcore_config.uid[0] = 0;
+
+	/* but the last 4 bytes of a 20 byte HMAC key live there */
+	assert(ykp_set_tktflag_APPEND_CR(cfg, false) == 1);
+	assert(ykp_set_tktflag_CHAL_RESP(cfg, true) == 1);
+	assert(ykp_set_cfgflag_CHAL_HMAC(cfg, true) == 1);
+	assert(ykp_get_supported_key_length(cfg) == 20);
+	assert(_test_report(cfg) == YKP_VALIDATE_KEY);
+	cfg->ykcore_config.uid[3] = 0x01;
+	assert(_test_report(cfg) == 0);
+	/* and no further */
+	cfg->ykcore_config.uid[3] = 0;
+	cfg->ykcore_config.uid[4] = 0x01;
+	assert(_test_report(cfg) == YKP_VALIDATE_KEY);
+
+	ykp_free_config(cfg);
+	ykds_free(st);
+}
+
+static void _test_fields(void)
+{
+	YKP_CONFIG *cfg = _test_config(3, 4, 3);
+	YKP_CONFIG *neo = _test_config(2, 1, 5);
+
+	cfg->ykcore_config.fixedSize = FIXED_SIZE + 1;
+	assert(_test_report(cfg) == YKP_VALIDATE_FIXED);
+	cfg->ykcore_config.fixedSize = FIXED_SIZE;
+	memset(cfg->ykcore_config.key, 0, KEY_SIZE);
+	assert(_test_report(cfg) == YKP_VALIDATE_KEY);
+	cfg->ykcore_config.key[KEY_SIZE - 1] = 0x01;
+
+	/* the NEO before 2.1.7 has OATH-HOTP but no IMF */
+	assert(ykp_set_tktflag_OATH_HOTP(neo, true) == 1);
+	assert(_test_report(neo) == 0);
+	neo->ykcore_config.uid[5] = 0x01;
+	assert(_test_report(neo) == YKP_VALIDATE_OATH_IMF);
+
+	ykp_set_acccode_type(cfg, YKP_ACCCODE_NONE);
+	assert(_test_report(cfg) == 0);
+	ykp_set_acccode_type(cfg, YKP_ACCCODE_RANDOM);
+	assert(_test_report(cfg) == YKP_VALIDATE_ACC_CODE);
+	cfg->ykcore_config.accCode[0] = 0x01;
+	assert(_test_report(cfg) == 0);
+	ykp_set_acccode_type(cfg, YKP_ACCCODE_NONE);
+	assert(_test_report(cfg) == YKP_VALIDATE_ACC_CODE);
+	ykp_set_acccode_type(cfg, 0x10);
+	assert(_test_report(cfg) == YKP_VALIDATE_ACC_CODE);
+
+	/* everything at once */
+	cfg->ykcore_config.fixedSize = 0xff;
+	cfg->ykcore_config.cfgFlags = CFGFLAG_ALLOW_HIDTRIG;
+	assert(_test_report(cfg) == (YKP_VALIDATE_ACC_CODE | YKP_VALIDATE_FIXED |
+				     YKP_VALIDATE_CFGFLAGS));
+
+	ykp_free_config(cfg);
+	ykp_free_config(neo);
+}
+
+int main(void)
+{
+	_test_valid();
+	_test_flags();
+	_test_command();
+	_test_key();
+	_test_fields();
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykcore.h>
+#include <ykdef.h>
+
+#include <yubikey.h>
+
+static void _test_prepare_command(void)
+{
+	YK_WRITE_OP op;
+	YKP_CONFIG *cfg = ykp_create_config();
+	YK_CONFIG *ycfg = ykp_core_config(cfg);
+	unsigned char acc_code[ACC_CODE_SIZE] = {1, 2, 3, 4, 5, 6};
+
+	assert(yk_prepare_write_command(&op, ycfg, SLOT_CONFIG2, acc_code) == 1);
+	assert(op.command == SLOT_CONFIG2);
+	assert(op.len == sizeof(struct config_st) + ACC_CODE_SIZE);
+	assert(memcmp(op.data, ycfg, sizeof(struct config_st)) == 0);
+	assert(memcmp(op.data + sizeof(struct config_st), acc_code, ACC_CODE_SIZE) == 0);
+	/* the config crc is filled in */
+	assert(yubikey_crc16(op.data, sizeof(struct config_st)) == YK_CRC_OK_RESIDUAL);
+
+	/* zap, no config and no access code */
+	assert(yk_prepare_write_command(&op, NULL, SLOT_CONFIG, NULL) == 1);
+	assert(op.command == SLOT_CONFIG);
+	assert(op.len == sizeof(struct config_st) + ACC_CODE_SIZE);
+	assert(op.data[0] == 0 && memcmp(op.data, op.data + 1, op.len - 1) == 0);
+
+	ykp_free_config(cfg);
+}
+
+static void _test_prepare_other(void)
+{
+	YK_WRITE_OP op;
+	YK_NDEF *ndef = ykp_alloc_ndef();
+	YK_DEVICE_CONFIG *device_config = ykp_alloc_device_config();
+	unsigned char scan_map[sizeof(SCAN_MAP)];
+	unsigned char device_info[65];
+
+	assert(ykp_construct_ndef_uri(ndef, "https://example.com/") == 1);
+	assert(yk_prepare_write_ndef(&op, ndef, 3) == 0);
+	assert(yk_errno == YK_EINVALIDCMD);
+	assert(yk_prepare_write_ndef(&op, ndef, 2) == 1);
+	assert(op.command == SLOT_NDEF2);
+	assert(op.len == sizeof(struct ndef_st));
+	assert(memcmp(op.data, ndef, op.len) == 0);
+
+	assert(ykp_set_device_mode(device_config, 0x81) == 1);
+	assert(yk_prepare_write_device_config(&op, device_config) == 1);
+	assert(op.command == SLOT_DEVICE_CONFIG);
+	assert(op.len == sizeof(struct device_config_st));
+	assert(op.data[0] == 0x81);
+
+	memcpy(scan_map, SCAN_MAP, sizeof(scan_map));
+	assert(yk_prepare_write_scan_map(&op, scan_map) == 1);
+	assert(op.command == SLOT_SCAN_MAP);
+	assert(op.len == strlen(SCAN_MAP));
+
+	memset(device_info, 0x42, sizeof(device_info));
+	assert(yk_prepare_write_device_info(&op, device_info, sizeof(device_info)) == 0);
+	assert(yk_errno == YK_EWRONGSIZ);
+	assert(yk_prepare_write_device_info(&op, device_info, 10) == 1);
+	assert(op.command == SLOT_YK4_SET_DEVICE_INFO);
+	assert(op.len == 10);
+
+	ykp_free_ndef(ndef);
+	ykp_free_device_config(device_config);
+}
+
+int main(void)
+{
+	_test_prepare_command();
+	_test_prepare_other();
+
+	return 0;
+}
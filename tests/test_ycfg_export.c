@@ -0,0 +1,173 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include <ykpers.h>
+#include <ykdef.h>
+
+/* what json-c made of this configuration with JSON_C_TO_STRING_PRETTY */
+static const char oath_ycfg[] =
+	"{\n"
+	"  \"yubiProdConfig\":{\n"
+	"    \"mode\":\"oathHOTP\",\n"
+	"    \"targetConfig\":1,\n"
+	"    \"protection\":\"none\",\n"
+	"    \"options\":{\n"
+	"      \"fixedModhex\":false,\n"
+	"      \"oathDigits\":6,\n"
+	"      \"fixedSeedvalue\":16,\n"
+	"      \"randomSeed\":false,\n"
+	"      \"tabFirst\":false,\n"
+	"      \"tabBetween\":false,\n"
+	"      \"tabLast\":false,\n"
+	"      \"appendDelay1\":false,\n"
+	"      \"appendDelay2\":false,\n"
+	"      \"appendCR\":true,\n"
+	"      \"protectSecond\":false,\n"
+	"      \"sendRef\":false,\n"
+	"      \"pacing10ms\":false,\n"
+	"      \"pacing20ms\":false,\n"
+	"      \"shortTicket\":false,\n"
+	"      \"serialBtnVisible\":false,\n"
+	"      \"serialUsbVisible\":false,\n"
+	"      \"serialApiVisible\":false,\n"
+	"      \"useNumericKeypad\":false,\n"
+	"      \"fastTrig\":false,\n"
+	"      \"allowUpdate\":false,\n"
+	"      \"dormant\":false,\n"
+	"      \"ledInverted\":false\n"
+	"    },\n"
+	"    \"scope\":\"privatePrefix\",\n"
+	"    \"prefix\":\"0102\"\n"
+	"  }\n"
+	"}";
+
+static YKP_CONFIG *_test_config(void)
+{
+	YK_STATUS *st = ykds_alloc();
+	struct status_st *t = (struct status_st *) st;
+	YKP_CONFIG *cfg = ykp_alloc();
+	unsigned char fixed[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+	t->versionMajor = 2;
+	t->versionMinor = 2;
+	t->versionBuild = 3;
+	assert(ykp_configure_for(cfg, 1, st) == 1);
+	assert(ykp_set_tktflag_OATH_HOTP(cfg, true) == 1);
+	assert(ykp_set_fixed(cfg, fixed, sizeof(fixed)) == 1);
+	assert(ykp_set_oath_imf(cfg, 16) == 1);
+	ykp_set_acccode_type(cfg, YKP_ACCCODE_NONE);
+	ykds_free(st);
+
+	return cfg;
+}
+
+struct sink_st {
+	char buf[2048];
+	size_t pos;
+	int calls;
+	int fail;
+};
+
+static int _writer(const char *buf, size_t count, void *userdata)
+{
+	struct sink_st *sink = userdata;
+
+	sink->calls++;
+	if (sink->fail)
+		return -1;
+	assert(sink->pos + count < sizeof(sink->buf));
+	memcpy(sink->buf + sink->pos, buf, count);
+	sink->pos += count;
+	sink->buf[sink->pos] = '\0';
+	return (int)count;
+}
+
+static void _test_export_buffer(void)
+{
+	YKP_CONFIG *cfg = _test_config();
+	char buf[2048];
+	char small[40];
+
+	assert(ykp_export_config(cfg, buf, sizeof(buf), YKP_FORMAT_YCFG) == (int)strlen(oath_ycfg));
+	assert(strcmp(buf, oath_ycfg) == 0);
+
+	/* too small a buffer gets a NUL terminated prefix */
+	assert(ykp_export_config(cfg, small, sizeof(small), YKP_FORMAT_YCFG) == (int)sizeof(small) - 1);
+	assert(strncmp(small, oath_ycfg, sizeof(small) - 1) == 0);
+	assert(small[sizeof(small) - 1] == '\0');
+
+	ykp_free_config(cfg);
+}
+
+static void _test_export_writer(void)
+{
+	YKP_CONFIG *cfg = _test_config();
+	struct sink_st sink;
+	char buf[1024];
+
+	memset(&sink, 0, sizeof(sink));
+	assert(ykp_write_config_format(cfg, YKP_FORMAT_YCFG, _writer, &sink) == 1);
+	assert(strcmp(sink.buf, oath_ycfg) == 0);
+	/* in a few pieces, not a call per token */
+	assert(sink.calls <= (int)(sizeof(oath_ycfg) / 256) + 1);
+
+	memset(&sink, 0, sizeof(sink));
+	assert(ykp_write_config_format(cfg, YKP_FORMAT_LEGACY, _writer, &sink) == 1);
+	assert(ykp_export_config(cfg, buf, sizeof(buf), YKP_FORMAT_LEGACY) > 0);
+	assert(strcmp(sink.buf, buf) == 0);
+
+	memset(&sink, 0, sizeof(sink));
+	sink.fail = 1;
+	ykp_errno = 0;
+	assert(ykp_write_config_format(cfg, YKP_FORMAT_YCFG, _writer, &sink) == 0);
+	assert(ykp_errno == YKP_EIO);
+	assert(sink.calls == 1);
+
+	ykp_errno = 0;
+	assert(ykp_write_config_format(cfg, YKP_FORMAT_KSM, _writer, &sink) == 0);
+	assert(ykp_errno == YKP_EINVAL);
+	assert(ykp_write_config_format(NULL, YKP_FORMAT_YCFG, _writer, &sink) == 0);
+	assert(ykp_errno == YKP_ENOCFG);
+
+	ykp_free_config(cfg);
+}
+
+int main(void)
+{
+	_test_export_buffer();
+	_test_export_writer();
+
+	return 0;
+}
@@ -236,14 +236,197 @@ static int test_pbkdf2_6(void)
 		0xcc, 0x37, 0xd7, 0xf0, 0x34, 0x25, 0xe0, 0xc3 };
 
 	unsigned char buf[64];
+	YK_PRF_CTX *ctx;
 	memset(buf, 0, 64);
 
-	yk_pbkdf2(password, salt, 5, iterations, buf, key_bytes, &hmac_sha1);
+	/* the NUL in the passphrase needs it keyed with its length */
+	ctx = yk_prf_init(&hmac_sha1, password, 9);
+	assert(ctx != NULL);
+	assert(yk_pbkdf2_ctx(ctx, salt, 5, iterations, buf, key_bytes) == 1);
 	assert(memcmp(expected, buf, key_bytes) == 0);
+	yk_prf_free(ctx);
 	return 0;
 
 }
 
+/* an odd iteration count with more than one output block, only the PRF
+ * output of each iteration goes into the key */
+static int test_pbkdf2_odd(void)
+{
+	unsigned char expected[] = {
+		0x6b, 0x4e, 0x26, 0x12, 0x5c, 0x25, 0xcf, 0x21,
+		0xae, 0x35, 0xea, 0xd9, 0x55, 0xf4, 0x79, 0xea,
+		0x2e, 0x71, 0xf6, 0xff, 0x9e, 0x40, 0x00, 0x29,
+		0xf0, 0x48, 0x10, 0xee, 0xce, 0x31, 0x35, 0x55,
+		0x33, 0xbb, 0x2e, 0xd3, 0x48, 0xe6, 0x04, 0xda,
+		0x70, 0x7c, 0xc4, 0x56, 0x2f };
+	unsigned char buf[64];
+
+	memset(buf, 0, 64);
+	assert(yk_pbkdf2("password", (const unsigned char *)"salt", 4, 3,
+			 buf, sizeof(expected), &hmac_sha1) == 1);
+	assert(memcmp(expected, buf, sizeof(expected)) == 0);
+	assert(buf[sizeof(expected)] == 0);
+	return 0;
+}
+
+static int other_hmac_sha1(const char *key, size_t key_len,
+			   const char *text, size_t text_len,
+			   uint8_t *output, size_t output_size)
+{
+	return yk_hmac_sha1(key, key_len, text, text_len, output, output_size);
+}
+
+/* the keyed PRF gives what the plain one does, with its pads hashed
+ * ahead or not */
+static int test_prf_ctx(void)
+{
+	YK_PRF_METHOD other = { 20, other_hmac_sha1 };
+	YK_PRF_CTX *ctx, *other_ctx;
+	char key[100], text[100];
+	uint8_t out1[20], out2[20];
+	unsigned char dk1[45], dk2[45];
+	size_t key_len, text_len;
+
+	for (key_len = 0; key_len < sizeof(key); key_len++)
+		key[key_len] = (char)(key_len * 5);
+	for (text_len = 0; text_len < sizeof(text); text_len++)
+		text[text_len] = (char)(text_len * 3 + 1);
+
+	for (key_len = 0; key_len < sizeof(key); key_len += 9) {
+		ctx = yk_prf_init(&hmac_sha1, key, key_len);
+		other_ctx = yk_prf_init(&other, key, key_len);
+		assert(ctx != NULL && other_ctx != NULL);
+		for (text_len = 0; text_len < sizeof(text); text_len += 7) {
+			assert(yk_prf_compute(ctx, text, text_len,
+					      out1, sizeof(out1)) == 1);
+			assert(yk_hmac_sha1(key, key_len, text, text_len,
+					    out2, sizeof(out2)) == 1);
+			assert(memcmp(out1, out2, 20) == 0);
+			assert(yk_prf_compute(other_ctx, text, text_len,
+					      out1, sizeof(out1)) == 1);
+			assert(memcmp(out1, out2, 20) == 0);
+		}
+		assert(yk_prf_compute(ctx, text, 10, out1, 19) == 0);
+
+		assert(yk_pbkdf2_ctx(ctx, (unsigned char *)text, 8, 5,
+				     dk1, sizeof(dk1)) == 1);
+		assert(yk_pbkdf2_ctx(other_ctx, (unsigned char *)text, 8, 5,
+				     dk2, sizeof(dk2)) == 1);
+		assert(memcmp(dk1, dk2, sizeof(dk1)) == 0);
+		yk_prf_free(ctx);
+		yk_prf_free(other_ctx);
+	}
+	return 0;
+}
+
+/* challenge-response shaped batches give what yk_hmac_sha1() does */
+static int test_hmac_sha1_multi(void)
+{
+	YK_HMAC_JOB jobs[20];
+	char keys[20][20];
+	char challenges[20][64];
+	uint8_t output[20];
+	size_t i, j;
+
+	for (i = 0; i < 20; i++) {
+		for (j = 0; j < 20; j++)
+			keys[i][j] = (char)(i * 20 + j);
+		for (j = 0; j < 64; j++)
+			challenges[i][j] = (char)(i + j * 3);
+		jobs[i].key = keys[i];
+		jobs[i].key_len = 20;
+		jobs[i].text = challenges[i];
+		jobs[i].text_len = i == 7 ? 32 : 64;
+	}
+
+	assert(yk_hmac_sha1_multi(jobs, 20) == 1);
+	for (i = 0; i < 20; i++) {
+		assert(yk_hmac_sha1(jobs[i].key, jobs[i].key_len,
+				    jobs[i].text, jobs[i].text_len,
+				    output, sizeof(output)) == 1);
+		assert(memcmp(jobs[i].output, output, 20) == 0);
+	}
+
+	jobs[19].text_len = 65;
+	assert(yk_hmac_sha1_multi(jobs, 20) == 0);
+	return 0;
+}
+
+/* the blocks computed on threads come out as one after another */
+static int test_pbkdf2_parallel(void)
+{
+	unsigned int threads[] = { 0, 1, 2, 3, 8, 100 };
+	unsigned char salt[] = "saltSALTsaltSALT";
+	unsigned char expected[143], buf[144];
+	YK_PRF_CTX *ctx = yk_prf_init(&hmac_sha1, "password", 8);
+	size_t i, dklen;
+
+	assert(ctx != NULL);
+	for (dklen = 0; dklen <= sizeof(expected); dklen += 13) {
+		assert(yk_pbkdf2_ctx(ctx, salt, 16, 7, expected, dklen) == 1);
+		for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+			memset(buf, 0xa5, sizeof(buf));
+			assert(yk_pbkdf2_parallel(ctx, salt, 16, 7, buf, dklen,
+						  threads[i]) == 1);
+			assert(memcmp(expected, buf, dklen) == 0);
+			assert(buf[dklen] == 0xa5);
+		}
+	}
+	assert(yk_pbkdf2_parallel(ctx, salt, 16, 0, buf, 40, 2) == 0);
+	yk_prf_free(ctx);
+	return 0;
+}
+
+/* PBKDF2-HMAC-SHA256 and -SHA512 with P = "password", S = "salt" */
+static int test_pbkdf2_sha2(void)
+{
+	YK_PRF_METHOD hmac_sha256 = { 32, yk_hmac_sha256 };
+	YK_PRF_METHOD hmac_sha512 = { 64, yk_hmac_sha512 };
+	unsigned char salt[] = "salt";
+	unsigned char dk[64];
+	unsigned char expected_256_1[] = {
+		0x12, 0x0f, 0xb6, 0xcf, 0xfc, 0xf8, 0xb3, 0x2c,
+		0x43, 0xe7, 0x22, 0x52, 0x56, 0xc4, 0xf8, 0x37,
+		0xa8, 0x65, 0x48, 0xc9, 0x2c, 0xcc, 0x35, 0x48,
+		0x08, 0x05, 0x98, 0x7c, 0xb7, 0x0b, 0xe1, 0x7b,
+	};
+	unsigned char expected_256_4096[] = {
+		0xc5, 0xe4, 0x78, 0xd5, 0x92, 0x88, 0xc8, 0x41,
+		0xaa, 0x53, 0x0d, 0xb6, 0x84, 0x5c, 0x4c, 0x8d,
+		0x96, 0x28, 0x93, 0xa0, 0x01, 0xce, 0x4e, 0x11,
+		0xa4, 0x96, 0x38, 0x73, 0xaa, 0x98, 0x13, 0x4a,
+	};
+	unsigned char expected_512_1[] = {
+		0x86, 0x7f, 0x70, 0xcf, 0x1a, 0xde, 0x02, 0xcf,
+		0xf3, 0x75, 0x25, 0x99, 0xa3, 0xa5, 0x3d, 0xc4,
+		0xaf, 0x34, 0xc7, 0xa6, 0x69, 0x81, 0x5a, 0xe5,
+		0xd5, 0x13, 0x55, 0x4e, 0x1c, 0x8c, 0xf2, 0x52,
+		0xc0, 0x2d, 0x47, 0x0a, 0x28, 0x5a, 0x05, 0x01,
+		0xba, 0xd9, 0x99, 0xbf, 0xe9, 0x43, 0xc0, 0x8f,
+		0x05, 0x02, 0x35, 0xd7, 0xd6, 0x8b, 0x1d, 0xa5,
+		0x5e, 0x63, 0xf7, 0x3b, 0x60, 0xa5, 0x7f, 0xce,
+	};
+
+	assert(yk_pbkdf2("password", salt, 4, 1, dk, 32, &hmac_sha256) == 1);
+	assert(memcmp(dk, expected_256_1, 32) == 0);
+	assert(yk_pbkdf2("password", salt, 4, 4096, dk, 32, &hmac_sha256) == 1);
+	assert(memcmp(dk, expected_256_4096, 32) == 0);
+	assert(yk_pbkdf2("password", salt, 4, 1, dk, 64, &hmac_sha512) == 1);
+	assert(memcmp(dk, expected_512_1, 64) == 0);
+	return 0;
+}
+
+static int test_pbkdf2_calibrate(void)
+{
+	YK_PRF_METHOD hmac_sha256 = { 32, yk_hmac_sha256 };
+
+	assert(yk_pbkdf2_calibrate(&hmac_sha1, 16, 5) > 0);
+	assert(yk_pbkdf2_calibrate(&hmac_sha256, 32, 5) > 0);
+	assert(yk_pbkdf2_calibrate(&hmac_sha1, 16, 0) == 0);
+	return 0;
+}
+
 int main(void)
 {
 	test_pbkdf2_1();
@@ -254,9 +437,12 @@ int main(void)
 	test_pbkdf2_4();
 #endif
 	test_pbkdf2_5();
-	/* vector 6 breaks though to us running strlen() on the password. */
-#if 0
 	test_pbkdf2_6();
-#endif
+	test_pbkdf2_odd();
+	test_pbkdf2_sha2();
+	test_pbkdf2_calibrate();
+	test_prf_ctx();
+	test_pbkdf2_parallel();
+	test_hmac_sha1_multi();
 	return 0;
 }
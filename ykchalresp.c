@@ -40,6 +40,7 @@
 #include <ykdef.h>
 #include <ykcore.h>
 #include <ykstatus.h>
+#include <ykpers.h>
 #include <ykpers-version.h>
 
 const char *usage =
@@ -249,7 +250,6 @@ static int challenge_response(YK_KEY *yk, int slot,
 	unsigned char output_buf[(SHA1_MAX_BLOCK_SIZE * 2) + 1];
 	int yk_cmd;
 	unsigned int expect_bytes = 0;
-	unsigned int offset;
 	unsigned int bin_code;
 	memset(response, 0, sizeof(response));
 	memset(output_buf, 0, sizeof(output_buf));
@@ -278,18 +278,10 @@ static int challenge_response(YK_KEY *yk, int slot,
 	expect_bytes = (hmac == true) ? 20 : 16;
 
 	if(digits && hmac){
-		offset   =  response[19] & 0xf ;
-		bin_code = (response[offset]  & 0x7f) << 24
-			| (response[offset+1] & 0xff) << 16
-			| (response[offset+2] & 0xff) <<  8
-			| (response[offset+3] & 0xff) ;
-		if(digits == 8){
-			bin_code = bin_code % 100000000;
-			printf("%08u\n", bin_code);
-			return 1;
+		if(! ykp_oath_truncate(response, digits, &bin_code)) {
+			return 0;
 		}
-		bin_code = bin_code % 1000000;
-		printf("%06i\n", bin_code);
+		printf("%0*u\n", digits, bin_code);
 		return 1;
 	}
 	if (hmac) {
@@ -39,6 +39,7 @@
 #include <stdio.h>
 #ifndef _WIN32
 #include <unistd.h>
+#include <time.h>
 #define Sleep(x) usleep((x)*1000)
 #endif
 
@@ -215,17 +216,29 @@ int yk_get_capabilities(YK_KEY *yk, uint8_t slot, unsigned int flags,
 	return 1;
 }
 
-static int _yk_write(YK_KEY *yk, uint8_t yk_cmd, unsigned char *buf, size_t len)
+/* Microseconds from some fixed point, for timing transaction steps. */
+static unsigned long long _yk_now_us(void)
 {
-	YK_STATUS stat;
-	int seq;
+#ifdef _WIN32
+	LARGE_INTEGER freq, now;
 
-	/* Get current sequence # from status block */
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (unsigned long long)now.QuadPart * 1000000 / freq.QuadPart;
+#else
+	struct timespec ts;
 
-	if (!yk_get_status(yk, &stat /*, 0*/))
-		return 0;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
 
-	seq = stat.pgmSeq;
+/* Write buf to the key and verify that the key took it, seq is the
+ * program sequence before the write and is updated to the one after. */
+static int _yk_write_step(YK_KEY *yk, uint8_t yk_cmd, unsigned char *buf,
+			  size_t len, int *seq)
+{
+	YK_STATUS stat;
 
 	/* Write to Yubikey */
 	if (!yk_write_to_key(yk, yk_cmd, buf, len))
@@ -250,42 +263,92 @@ static int _yk_write(YK_KEY *yk, uint8_t yk_cmd, unsigned char *buf, size_t len)
 	 * pgmSeq 0, if one is still configured after an erase pgmSeq is
 	 * counted up as usual. */
 	if((stat.touchLevel & (CONFIG1_VALID | CONFIG2_VALID)) == 0 && stat.pgmSeq == 0) {
+		*seq = stat.pgmSeq;
 		return 1;
 	}
-	return stat.pgmSeq != seq;
+	if (stat.pgmSeq == *seq)
+		return 0;
+	*seq = stat.pgmSeq;
+	return 1;
 }
 
-int yk_write_device_info(YK_KEY *yk, unsigned char *buf, unsigned int len)
+static int _yk_write(YK_KEY *yk, uint8_t yk_cmd, unsigned char *buf, size_t len)
+{
+	YK_STATUS stat;
+	int seq;
+
+	/* Get current sequence # from status block */
+
+	if (!yk_get_status(yk, &stat /*, 0*/))
+		return 0;
+
+	seq = stat.pgmSeq;
+
+	return _yk_write_step(yk, yk_cmd, buf, len, &seq);
+}
+
+static int _yk_write_op(YK_KEY *yk, YK_WRITE_OP *op)
 {
-	return _yk_write(yk, SLOT_YK4_SET_DEVICE_INFO, buf, len);
+	int ret = _yk_write(yk, op->command, op->data, op->len);
+	insecure_memzero(op->data, sizeof(op->data));
+	return ret;
 }
 
+int yk_prepare_write_device_info(YK_WRITE_OP *op, unsigned char *buf,
+				 unsigned int len)
+{
+	if (len > sizeof(op->data)) {
+		yk_errno = YK_EWRONGSIZ;
+		return 0;
+	}
+	memset(op, 0, sizeof(*op));
+	op->command = SLOT_YK4_SET_DEVICE_INFO;
+	memcpy(op->data, buf, len);
+	op->len = len;
+	return 1;
+}
 
-int yk_write_command(YK_KEY *yk, YK_CONFIG *cfg, uint8_t command,
-		    unsigned char *acc_code)
+int yk_write_device_info(YK_KEY *yk, unsigned char *buf, unsigned int len)
 {
-	int ret;
-	unsigned char buf[sizeof(YK_CONFIG) + ACC_CODE_SIZE];
+	YK_WRITE_OP op;
 
-	/* Update checksum and insert config block in buffer if present */
+	if (!yk_prepare_write_device_info(&op, buf, len))
+		return 0;
+	return _yk_write_op(yk, &op);
+}
 
-	memset(buf, 0, sizeof(buf));
+int yk_prepare_write_command(YK_WRITE_OP *op, YK_CONFIG *cfg,
+			     uint8_t command, unsigned char *acc_code)
+{
+	memset(op, 0, sizeof(*op));
+	op->command = command;
+	op->len = sizeof(YK_CONFIG) + ACC_CODE_SIZE;
+
+	/* Update checksum and insert config block in buffer if present */
 
 	if (cfg) {
 		cfg->crc = ~yubikey_crc16 ((unsigned char *) cfg,
 					   sizeof(YK_CONFIG) - sizeof(cfg->crc));
 		cfg->crc = yk_endian_swap_16(cfg->crc);
-		memcpy(buf, cfg, sizeof(YK_CONFIG));
+		memcpy(op->data, cfg, sizeof(YK_CONFIG));
 	}
 
 	/* Append current access code if present */
 
 	if (acc_code)
-		memcpy(buf + sizeof(YK_CONFIG), acc_code, ACC_CODE_SIZE);
+		memcpy(op->data + sizeof(YK_CONFIG), acc_code, ACC_CODE_SIZE);
 
-	ret = _yk_write(yk, command, buf, sizeof(buf));
-	insecure_memzero(buf, sizeof(buf));
-	return ret;
+	return 1;
+}
+
+int yk_write_command(YK_KEY *yk, YK_CONFIG *cfg, uint8_t command,
+		    unsigned char *acc_code)
+{
+	YK_WRITE_OP op;
+
+	if (!yk_prepare_write_command(&op, cfg, command, acc_code))
+		return 0;
+	return _yk_write_op(yk, &op);
 }
 
 int yk_write_config(YK_KEY *yk, YK_CONFIG *cfg, int confnum,
@@ -315,9 +378,8 @@ int yk_write_ndef(YK_KEY *yk, YK_NDEF *ndef)
 	return yk_write_ndef2(yk, ndef, 1);
 }
 
-int yk_write_ndef2(YK_KEY *yk, YK_NDEF *ndef, int confnum)
+int yk_prepare_write_ndef(YK_WRITE_OP *op, YK_NDEF *ndef, int confnum)
 {
-	unsigned char buf[sizeof(YK_NDEF)];
 	uint8_t command;
 
 	switch(confnum) {
@@ -334,25 +396,95 @@ int yk_write_ndef2(YK_KEY *yk, YK_NDEF *ndef, int confnum)
 
 	/* Insert config block in buffer */
 
-	memset(buf, 0, sizeof(buf));
-	memcpy(buf, ndef, sizeof(YK_NDEF));
+	memset(op, 0, sizeof(*op));
+	op->command = command;
+	memcpy(op->data, ndef, sizeof(YK_NDEF));
+	op->len = sizeof(YK_NDEF);
+	return 1;
+}
 
-	return _yk_write(yk, command, buf, sizeof(YK_NDEF));
+int yk_write_ndef2(YK_KEY *yk, YK_NDEF *ndef, int confnum)
+{
+	YK_WRITE_OP op;
+
+	if (!yk_prepare_write_ndef(&op, ndef, confnum))
+		return 0;
+	return _yk_write_op(yk, &op);
+}
+
+int yk_prepare_write_device_config(YK_WRITE_OP *op,
+				   YK_DEVICE_CONFIG *device_config)
+{
+	memset(op, 0, sizeof(*op));
+	op->command = SLOT_DEVICE_CONFIG;
+	memcpy(op->data, device_config, sizeof(YK_DEVICE_CONFIG));
+	op->len = sizeof(YK_DEVICE_CONFIG);
+	return 1;
 }
 
 int yk_write_device_config(YK_KEY *yk, YK_DEVICE_CONFIG *device_config)
 {
-	unsigned char buf[sizeof(YK_DEVICE_CONFIG)];
+	YK_WRITE_OP op;
 
-	memset(buf, 0, sizeof(buf));
-	memcpy(buf, device_config, sizeof(YK_DEVICE_CONFIG));
+	if (!yk_prepare_write_device_config(&op, device_config))
+		return 0;
+	return _yk_write_op(yk, &op);
+}
 
-	return _yk_write(yk, SLOT_DEVICE_CONFIG, buf, sizeof(YK_DEVICE_CONFIG));
+int yk_prepare_write_scan_map(YK_WRITE_OP *op, unsigned char *scan_map)
+{
+	memset(op, 0, sizeof(*op));
+	op->command = SLOT_SCAN_MAP;
+	memcpy(op->data, scan_map, strlen(SCAN_MAP));
+	op->len = strlen(SCAN_MAP);
+	return 1;
 }
 
 int yk_write_scan_map(YK_KEY *yk, unsigned char *scan_map)
 {
-	return _yk_write(yk, SLOT_SCAN_MAP, scan_map, strlen(SCAN_MAP));
+	YK_WRITE_OP op;
+
+	if (!yk_prepare_write_scan_map(&op, scan_map))
+		return 0;
+	return _yk_write_op(yk, &op);
+}
+
+/* Run the writes in ops in order on an open key.  The status is read
+ * once up front and then once after every step, which is where the
+ * program sequence of the step is checked.  Stops at the first step
+ * that fails, steps that are not run get result -1.  The data of every
+ * step run is cleared.
+ */
+int yk_write_transaction(YK_KEY *yk, YK_WRITE_OP *ops, size_t num_ops)
+{
+	YK_STATUS stat;
+	size_t i;
+	int seq;
+
+	for (i = 0; i < num_ops; i++) {
+		ops[i].result = -1;
+		ops[i].error = 0;
+		ops[i].elapsed_us = 0;
+	}
+
+	if (!yk_get_status(yk, &stat /*, 0*/))
+		return 0;
+	seq = stat.pgmSeq;
+
+	for (i = 0; i < num_ops; i++) {
+		unsigned long long start = _yk_now_us();
+
+		ops[i].result = _yk_write_step(yk, ops[i].command, ops[i].data,
+					       ops[i].len, &seq);
+		ops[i].elapsed_us = (unsigned long)(_yk_now_us() - start);
+		insecure_memzero(ops[i].data, sizeof(ops[i].data));
+		if (!ops[i].result) {
+			ops[i].error = yk_errno;
+			return 0;
+		}
+	}
+
+	return 1;
 }
 
 /*
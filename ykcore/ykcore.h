@@ -64,6 +64,8 @@ typedef struct yk_nav_st YK_NAV;	/* Navigation structure.
 typedef struct yk_frame_st YK_FRAME;	/* Data frame for write operation */
 typedef struct ndef_st YK_NDEF;
 typedef struct yk_device_config_st YK_DEVICE_CONFIG;
+typedef struct yk_write_op_st YK_WRITE_OP;	/* One step of a write
+						   transaction. */
 
 /*************************************************************************
  *
@@ -143,6 +145,32 @@ int yk_get_capabilities(YK_KEY *yk, uint8_t slot, unsigned int flags,
 /* Set the device info (TLV string) */
 int yk_write_device_info(YK_KEY *yk, unsigned char *buf, unsigned int len);
 
+/* A write prepared by one of the yk_prepare_write_*() functions below,
+   which take the same arguments as the corresponding yk_write_*()
+   function.  result, error and elapsed_us are set by
+   yk_write_transaction(). */
+struct yk_write_op_st {
+	uint8_t command;
+	unsigned char data[64];		/* SLOT_DATA_SIZE */
+	unsigned int len;
+
+	int result;			/* 1 written, 0 failed, -1 not run */
+	int error;			/* yk_errno if failed */
+	unsigned long elapsed_us;	/* time taken by the step */
+};
+
+extern int yk_prepare_write_command(YK_WRITE_OP *op, YK_CONFIG *cfg,
+				    uint8_t command, unsigned char *acc_code);
+extern int yk_prepare_write_ndef(YK_WRITE_OP *op, YK_NDEF *ndef, int confnum);
+extern int yk_prepare_write_device_config(YK_WRITE_OP *op,
+					  YK_DEVICE_CONFIG *device_config);
+extern int yk_prepare_write_scan_map(YK_WRITE_OP *op, unsigned char *scan_map);
+extern int yk_prepare_write_device_info(YK_WRITE_OP *op, unsigned char *buf,
+					unsigned int len);
+/* Run num_ops prepared writes, in order, on the open key.  Stops at the
+   first write that fails. */
+extern int yk_write_transaction(YK_KEY *yk, YK_WRITE_OP *ops, size_t num_ops);
+
 
 /*************************************************************************
  *
@@ -33,6 +33,8 @@
 #include "ykdef.h"
 #include "ykstatus.h"
 
+#include <string.h>
+
 YK_STATUS *ykds_alloc(void)
 {
 	YK_STATUS *st = malloc(sizeof(YK_STATUS));
@@ -47,6 +49,18 @@ void ykds_free(YK_STATUS *st)
 	free(st);
 }
 
+size_t ykds_sizeof(void)
+{
+	return sizeof(YK_STATUS);
+}
+
+YK_STATUS *ykds_init(void *mem)
+{
+	if (mem)
+		memset(mem, 0, sizeof(YK_STATUS));
+	return mem;
+}
+
 YK_STATUS *ykds_static(void)
 {
 	static YK_STATUS st;
@@ -42,6 +42,12 @@ extern "C" {
 extern YK_STATUS *ykds_alloc(void);
 extern void ykds_free(YK_STATUS *st);
 
+/* Clear a status structure in storage of the caller, of at least
+   ykds_sizeof() bytes aligned as by malloc(), not to be passed to
+   ykds_free() */
+extern size_t ykds_sizeof(void);
+extern YK_STATUS *ykds_init(void *mem);
+
 /* Return static status structure, to be used for quick checks.
    USE WITH CAUTION, as this is a SHARED OBJECT. */
 extern YK_STATUS *ykds_static(void);
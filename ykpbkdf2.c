@@ -28,73 +28,436 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include <ykpbkdf2.h>
 
 #include "sha.h"
 
+static int _hmac(SHAversion which, const char *key, size_t key_len,
+		 const char *text, size_t text_len,
+		 uint8_t *output, size_t output_size)
+{
+	uint8_t digest[USHAMaxHashSize];
+	int size = USHAHashSize(which);
+
+	if (output_size < (size_t)size)
+		return 0;
+
+	if (hmac(which,
+		 (const unsigned char *)text, (int)text_len,
+		 (const unsigned char *)key, (int)key_len,
+		 digest))
+		return 0;
+	memcpy(output, digest, size);
+	return 1;
+}
+
 int yk_hmac_sha1(const char *key, size_t key_len,
 		     const char *text, size_t text_len,
 		     uint8_t *output, size_t output_size)
 {
-	if (output_size < SHA1HashSize)
+	return _hmac(SHA1, key, key_len, text, text_len, output, output_size);
+}
+
+int yk_hmac_sha256(const char *key, size_t key_len,
+		   const char *text, size_t text_len,
+		   uint8_t *output, size_t output_size)
+{
+	return _hmac(SHA256, key, key_len, text, text_len,
+		     output, output_size);
+}
+
+int yk_hmac_sha512(const char *key, size_t key_len,
+		   const char *text, size_t text_len,
+		   uint8_t *output, size_t output_size)
+{
+	return _hmac(SHA512, key, key_len, text, text_len,
+		     output, output_size);
+}
+
+int yk_hmac_sha1_multi(YK_HMAC_JOB *jobs, size_t count)
+{
+	HMACSHA1Job batch[16];
+	size_t i, j, n;
+
+	for (i = 0; i < count; i += n) {
+		n = count - i < 16 ? count - i : 16;
+		for (j = 0; j < n; j++) {
+			YK_HMAC_JOB *job = &jobs[i + j];
+
+			if (job->key_len > INT_MAX || job->text_len > 64)
+				return 0;
+			batch[j].key = (const unsigned char *)job->key;
+			batch[j].key_len = (int)job->key_len;
+			batch[j].text = (const unsigned char *)job->text;
+			batch[j].text_len = (int)job->text_len;
+		}
+		if (hmacSHA1Multi(batch, (int)n))
+			return 0;
+		for (j = 0; j < n; j++)
+			memcpy(jobs[i + j].output, batch[j].digest, SHA1HashSize);
+	}
+	return 1;
+}
+
+/* A keyed PRF.  HMAC methods built on the SHA code here keep the key
+ * as an HMACKeyed, so each call costs two compressions for a short
+ * text instead of four.  Others keep the key and call prf_fn. */
+struct yk_prf_context {
+	YK_PRF_METHOD method;
+	int which;			/* SHAversion, or -1 for prf_fn */
+	HMACKeyed keyed;
+	size_t key_len;
+	char key[];
+};
+
+static const struct {
+	int (*prf_fn)(const char *key, size_t key_len,
+		      const char *text, size_t text_len,
+		      uint8_t *output, size_t output_size);
+	SHAversion which;
+} _hmac_methods[] = {
+	{ yk_hmac_sha1, SHA1 },
+	{ yk_hmac_sha256, SHA256 },
+	{ yk_hmac_sha512, SHA512 },
+};
+
+YK_PRF_CTX *yk_prf_init(const YK_PRF_METHOD *prf_method,
+			const char *key, size_t key_len)
+{
+	YK_PRF_CTX *ctx;
+	size_t i;
+
+	if (!prf_method || !prf_method->prf_fn || key_len > INT_MAX)
+		return NULL;
+
+	for (i = 0; i < sizeof(_hmac_methods) / sizeof(_hmac_methods[0]); i++)
+		if (prf_method->prf_fn == _hmac_methods[i].prf_fn)
+			break;
+
+	if (i < sizeof(_hmac_methods) / sizeof(_hmac_methods[0])) {
+		ctx = malloc(sizeof(*ctx));
+		if (!ctx)
+			return NULL;
+		ctx->method = *prf_method;
+		ctx->which = _hmac_methods[i].which;
+		ctx->key_len = 0;
+		if (hmacKeyedReset(&ctx->keyed, ctx->which,
+				   (const unsigned char *)key, (int)key_len)) {
+			yk_prf_free(ctx);
+			return NULL;
+		}
+		return ctx;
+	}
+
+	ctx = malloc(sizeof(*ctx) + key_len);
+	if (!ctx)
+		return NULL;
+	ctx->method = *prf_method;
+	ctx->which = -1;
+	ctx->key_len = key_len;
+	memcpy(ctx->key, key, key_len);
+	return ctx;
+}
+
+int yk_prf_compute(const YK_PRF_CTX *ctx,
+		   const char *text, size_t text_len,
+		   uint8_t *output, size_t output_size)
+{
+	uint8_t digest[USHAMaxHashSize];
+	int size;
+
+	if (!ctx)
 		return 0;
+	if (ctx->which < 0)
+		return ctx->method.prf_fn(ctx->key, ctx->key_len,
+					  text, text_len,
+					  output, output_size);
 
-	if (hmac(SHA1,
-		 (const unsigned char *)text, (int)text_len,
-		 (const unsigned char *)key, (int)key_len,
-		 output))
+	size = USHAHashSize(ctx->which);
+	if (output_size < (size_t)size || text_len > INT_MAX)
+		return 0;
+
+	if (hmacKeyedResult(&ctx->keyed, (const unsigned char *)text,
+			    (int)text_len, digest))
 		return 0;
+	memcpy(output, digest, size);
 	return 1;
 }
 
+void yk_prf_free(YK_PRF_CTX *ctx)
+{
+	if (ctx) {
+		memset(ctx, 0, sizeof(*ctx) + ctx->key_len);
+		free(ctx);
+	}
+}
+
+/* T_i = U_1 ^ ... ^ U_c, over the PRF output only, into t */
+static int _pbkdf2_block(const YK_PRF_CTX *ctx,
+			 const unsigned char *salt, size_t salt_len,
+			 unsigned int iterations, unsigned int block_count,
+			 unsigned char *t)
+{
+	unsigned char block[256]; /* A big chunk, that's 2048 bits */
+	unsigned char u[256];
+	size_t output_size = ctx->method.output_size;
+	unsigned int iteration;
+	size_t i;
+	int rc;
+
+	memcpy(block, salt, salt_len);
+	block[salt_len + 0] = (block_count & 0xff000000) >> 24;
+	block[salt_len + 1] = (block_count & 0x00ff0000) >> 16;
+	block[salt_len + 2] = (block_count & 0x0000ff00) >>  8;
+	block[salt_len + 3] = (block_count & 0x000000ff) >>  0;
+
+	rc = yk_prf_compute(ctx, (char *)block, salt_len + 4, u, sizeof(u));
+	memcpy(t, u, output_size);
+	for (iteration = 1; rc && iteration < iterations; iteration++) {
+		rc = yk_prf_compute(ctx, (char *)u, output_size,
+				    u, sizeof(u));
+		for (i = 0; i < output_size; i++)
+			t[i] ^= u[i];
+	}
+
+	memset(u, 0, sizeof(u));
+	return rc;
+}
+
+static int _pbkdf2_check(const YK_PRF_CTX *ctx, size_t salt_len,
+			 unsigned int iterations)
+{
+	return ctx && iterations > 0 && salt_len <= 256 - 4 &&
+		ctx->method.output_size > 0 && ctx->method.output_size <= 256;
+}
+
+int yk_pbkdf2_ctx(const YK_PRF_CTX *ctx,
+		  const unsigned char *salt, size_t salt_len,
+		  unsigned int iterations,
+		  unsigned char *dk, size_t dklen)
+{
+	unsigned char t[256];
+	unsigned int block_count;
+	int rc = 1;
+
+	if (!_pbkdf2_check(ctx, salt_len, iterations))
+		return 0;
+
+	for (block_count = 1; rc && dklen > 0; block_count++) {
+		size_t block_len = ctx->method.output_size;
+
+		rc = _pbkdf2_block(ctx, salt, salt_len, iterations,
+				   block_count, t);
+		if (block_len > dklen)
+			block_len = dklen; /* This happens in the last block */
+		memcpy(dk, t, block_len);
+		dk += block_len;
+		dklen -= block_len;
+	}
+
+	memset(t, 0, sizeof(t));
+	return rc;
+}
+
+/* One thread's share of the blocks: first, first + step, ... */
+struct pbkdf2_share {
+	const YK_PRF_CTX *ctx;
+	const unsigned char *salt;
+	size_t salt_len;
+	unsigned int iterations;
+	unsigned int first;
+	unsigned int step;
+	unsigned int blocks;
+	unsigned char *out;
+	int rc;
+};
+
+#ifdef _WIN32
+static DWORD WINAPI _pbkdf2_thread(LPVOID arg)
+#else
+static void *_pbkdf2_thread(void *arg)
+#endif
+{
+	struct pbkdf2_share *share = arg;
+	size_t output_size = share->ctx->method.output_size;
+	unsigned int i;
+
+	share->rc = 1;
+	for (i = share->first; share->rc && i < share->blocks; i += share->step)
+		share->rc = _pbkdf2_block(share->ctx, share->salt,
+					  share->salt_len, share->iterations,
+					  i + 1, share->out + i * output_size);
+	return 0;
+}
+
+static unsigned int _online_cpus(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return n > 0 ? (unsigned int)n : 1;
+#endif
+}
+
+int yk_pbkdf2_parallel(const YK_PRF_CTX *ctx,
+		       const unsigned char *salt, size_t salt_len,
+		       unsigned int iterations,
+		       unsigned char *dk, size_t dklen,
+		       unsigned int threads)
+{
+	struct pbkdf2_share shares[YK_PBKDF2_MAX_THREADS];
+#ifdef _WIN32
+	HANDLE handles[YK_PBKDF2_MAX_THREADS];
+#else
+	pthread_t handles[YK_PBKDF2_MAX_THREADS];
+#endif
+	int started[YK_PBKDF2_MAX_THREADS];
+	size_t output_size, blocks;
+	unsigned char *out;
+	unsigned int i;
+	int rc = 1;
+
+	if (!_pbkdf2_check(ctx, salt_len, iterations))
+		return 0;
+	output_size = ctx->method.output_size;
+	blocks = (dklen + output_size - 1) / output_size;
+	if (blocks > UINT_MAX)
+		return 0;
+
+	if (threads == 0)
+		threads = _online_cpus();
+	if (threads > YK_PBKDF2_MAX_THREADS)
+		threads = YK_PBKDF2_MAX_THREADS;
+	if (threads > blocks)
+		threads = (unsigned int)blocks;
+	if (threads <= 1)
+		return yk_pbkdf2_ctx(ctx, salt, salt_len, iterations, dk, dklen);
+
+	out = malloc(blocks * output_size);
+	if (!out)
+		return 0;
+
+	for (i = 0; i < threads; i++) {
+		shares[i].ctx = ctx;
+		shares[i].salt = salt;
+		shares[i].salt_len = salt_len;
+		shares[i].iterations = iterations;
+		shares[i].first = i;
+		shares[i].step = threads;
+		shares[i].blocks = (unsigned int)blocks;
+		shares[i].out = out;
+	}
+
+	/* the calling thread takes share 0, and any share that could
+	 * not get a thread of its own */
+	for (i = 1; i < threads; i++) {
+#ifdef _WIN32
+		handles[i] = CreateThread(NULL, 0, _pbkdf2_thread,
+					  &shares[i], 0, NULL);
+		started[i] = handles[i] != NULL;
+#else
+		started[i] = pthread_create(&handles[i], NULL, _pbkdf2_thread,
+					    &shares[i]) == 0;
+#endif
+	}
+	_pbkdf2_thread(&shares[0]);
+	for (i = 1; i < threads; i++) {
+		if (started[i]) {
+#ifdef _WIN32
+			WaitForSingleObject(handles[i], INFINITE);
+			CloseHandle(handles[i]);
+#else
+			pthread_join(handles[i], NULL);
+#endif
+		} else {
+			_pbkdf2_thread(&shares[i]);
+		}
+	}
+
+	for (i = 0; i < threads; i++)
+		rc = rc && shares[i].rc;
+	if (rc)
+		memcpy(dk, out, dklen);
+	memset(out, 0, blocks * output_size);
+	free(out);
+	return rc;
+}
+
 int yk_pbkdf2(const char *passphrase,
 	      const unsigned char *salt, size_t salt_len,
 	      unsigned int iterations,
 	      unsigned char *dk, size_t dklen,
 	      YK_PRF_METHOD *prf_method)
 {
-	if (salt_len > 256) {
+	YK_PRF_CTX *ctx = yk_prf_init(prf_method, passphrase,
+				      strlen(passphrase));
+	int rc = yk_pbkdf2_ctx(ctx, salt, salt_len, iterations, dk, dklen);
+
+	yk_prf_free(ctx);
+	return rc;
+}
+
+/* Derivations are timed with doubling iteration counts until one takes
+ * long enough for the clock, then the count is scaled to the target. */
+unsigned int yk_pbkdf2_calibrate(const YK_PRF_METHOD *prf_method,
+				 size_t dklen, unsigned int milliseconds)
+{
+	const unsigned char salt[8] = { 0 };
+	unsigned char *dk;
+	YK_PRF_CTX *ctx;
+	unsigned int iterations = 1;
+	double secs = 0, target = milliseconds / 1000.0;
+	double count;
+
+	if (milliseconds == 0 || dklen == 0)
+		return 0;
+	ctx = yk_prf_init(prf_method, "calibrate", 9);
+	dk = malloc(dklen);
+	if (!ctx || !dk) {
+		yk_prf_free(ctx);
+		free(dk);
 		return 0;
 	}
-	size_t l = ((dklen - 1 + prf_method->output_size)
-		    / prf_method->output_size);
-#if 0 /* r for "rest" is unused but may be interesting in the future */
-	size_t r = dklen - ((l - 1) * prf_method->output_size);
-#endif
 
-	unsigned int block_count;
+	for (;;) {
+		clock_t start = clock();
 
-	memset(dk, 0, dklen);
-
-	for (block_count = 1; block_count <= l; block_count++) {
-		unsigned char block[256]; /* A big chunk, that's 2048 bits */
-		size_t block_len;
-		unsigned int iteration;
-		size_t i;
-
-		memcpy(block, salt, salt_len);
-		block[salt_len + 0] = (block_count & 0xff000000) >> 24;
-		block[salt_len + 1] = (block_count & 0x00ff0000) >> 16;
-		block[salt_len + 2] = (block_count & 0x0000ff00) >>  8;
-		block[salt_len + 3] = (block_count & 0x000000ff) >>  0;
-		block_len = salt_len + 4;
-
-		for (iteration = 0; iteration < iterations; iteration++) {
-			if (!prf_method->prf_fn(passphrase, strlen(passphrase),
-						(char *)block, block_len,
-						block, sizeof(block)))
-				return 0;
-			block_len = prf_method->output_size;
-			for(i = 0; i < dklen; i++) {
-				dk[i] ^= block[i];
-			}
+		if (!yk_pbkdf2_ctx(ctx, salt, sizeof(salt), iterations,
+				   dk, dklen)) {
+			iterations = 0;
+			break;
 		}
-
-		if (block_len > dklen)
-			block_len = dklen; /* This happens in the last block */
-		dk += block_len;
-		dklen -= block_len;
+		secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (secs >= 0.02 || secs >= target / 4 ||
+		    iterations > UINT_MAX / 2)
+			break;
+		iterations *= 2;
 	}
-	return 1;
+
+	yk_prf_free(ctx);
+	free(dk);
+	if (iterations == 0)
+		return 0;
+	if (secs <= 0)
+		return iterations;
+	count = iterations * (target / secs);
+	if (count >= UINT_MAX)
+		return UINT_MAX;
+	return count < 1 ? 1 : (unsigned int)count;
 }
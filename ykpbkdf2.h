@@ -33,6 +33,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+# ifdef __cplusplus
+extern "C" {
+# endif
+
 typedef struct yk_prf_context YK_PRF_CTX;
 typedef struct yk_prf_method YK_PRF_METHOD;
 struct yk_prf_method {
@@ -45,6 +49,26 @@ struct yk_prf_method {
 int yk_hmac_sha1(const char *key, size_t key_len,
 		const char *text, size_t text_len,
 		uint8_t *output, size_t output_size);
+int yk_hmac_sha256(const char *key, size_t key_len,
+		   const char *text, size_t text_len,
+		   uint8_t *output, size_t output_size);
+int yk_hmac_sha512(const char *key, size_t key_len,
+		   const char *text, size_t text_len,
+		   uint8_t *output, size_t output_size);
+
+/* HMAC-SHA1 of many (key, text) pairs at once, each text at most 64
+ * bytes like a challenge-response challenge, several of them in SIMD
+ * lanes where the CPU has them. */
+typedef struct yk_hmac_job YK_HMAC_JOB;
+struct yk_hmac_job {
+	const char *key;
+	size_t key_len;
+	const char *text;
+	size_t text_len;
+	uint8_t output[20];
+};
+
+int yk_hmac_sha1_multi(YK_HMAC_JOB *jobs, size_t count);
 
 int yk_pbkdf2(const char *passphrase,
 	      const unsigned char *salt, size_t salt_len,
@@ -52,4 +76,39 @@ int yk_pbkdf2(const char *passphrase,
 	      unsigned char *dk, size_t dklen,
 	      YK_PRF_METHOD *prf_method);
 
+/* A PRF keyed once for many texts.  For the yk_hmac_sha* PRFs the pad
+ * blocks are hashed here, halving the work per call.  The context is
+ * not changed by yk_prf_compute() or yk_pbkdf2_ctx(). */
+YK_PRF_CTX *yk_prf_init(const YK_PRF_METHOD *prf_method,
+			const char *key, size_t key_len);
+int yk_prf_compute(const YK_PRF_CTX *ctx,
+		   const char *text, size_t text_len,
+		   uint8_t *output, size_t output_size);
+void yk_prf_free(YK_PRF_CTX *ctx);
+
+/* yk_pbkdf2() with the passphrase already keyed, which also allows
+ * passphrases with NUL bytes. */
+int yk_pbkdf2_ctx(const YK_PRF_CTX *ctx,
+		  const unsigned char *salt, size_t salt_len,
+		  unsigned int iterations,
+		  unsigned char *dk, size_t dklen);
+
+/* The iteration count for which deriving dklen bytes with prf_method
+ * takes about milliseconds of CPU time on this host, or 0 on error. */
+unsigned int yk_pbkdf2_calibrate(const YK_PRF_METHOD *prf_method,
+				 size_t dklen, unsigned int milliseconds);
+
+/* yk_pbkdf2_ctx() with the output blocks computed on up to threads
+ * threads at once, 0 for one per online CPU.  The key is the same. */
+#define YK_PBKDF2_MAX_THREADS 64
+int yk_pbkdf2_parallel(const YK_PRF_CTX *ctx,
+		       const unsigned char *salt, size_t salt_len,
+		       unsigned int iterations,
+		       unsigned char *dk, size_t dklen,
+		       unsigned int threads);
+
+# ifdef __cplusplus
+}
+# endif
+
 #endif
@@ -64,9 +64,14 @@ const char *usage =
 "-z        delete the configuration in slot 1 or 2.\n"
 "-sFILE    save configuration to FILE instead of key.\n"
 "          (if FILE is -, send to stdout)\n"
-"-iFILE    read configuration from FILE. (only valid for -fycfg)\n"
+"-iFILE    read configuration from FILE.\n"
 "          (if FILE is -, read from stdin)\n"
+"-INUM     use configuration NUM, counting from 0, of the -i FILE.  With\n"
+"          -fycfg FILE can hold many configurations, one JSON object after\n"
+"          the other or in a JSON array.\n"
 "-fformat  set the data format for -s and -i valid values are ycfg or legacy.\n"
+"-jFILE    keep a provisioning journal in FILE.  Keys that according to the\n"
+"          journal already hold the configuration are skipped.\n"
 "-a[XXX..] The AES secret key as a 32 (or 40 for OATH-HOTP/HMAC CHAL-RESP)\n"
 "          char hex value (not modhex) (none to prompt for key on stdin)\n"
 "          If -a is not used a random key will be generated.\n"
@@ -160,7 +165,7 @@ const char *usage =
 "-V        tool version\n"
 "-h        help (this text)\n"
 ;
-const char *optstring = ":u12xza:c:n:t:hi:o:s:f:dvym:S:VN:D:";
+const char *optstring = ":u12xza:c:n:t:hi:o:s:f:dvym:S:VN:D:j:I:";
 
 static int _set_fixed(char *opt, YKP_CONFIG *cfg);
 static int _format_decimal_as_hex(uint8_t *dst, size_t dst_len, uint8_t *src);
@@ -719,6 +724,8 @@ int args_to_config(int argc, char **argv, YKP_CONFIG *cfg, char *oathid,
 			break;
 		case 'V':
 		case 'N':
+		case 'j':
+		case 'I':
 			continue;
 		case ':':
 			switch(optopt) {
@@ -0,0 +1,273 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ykpers_lcl.h"
+#include "ykpers-json.h"
+
+#include <ykpers.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/* A bundle is a file of many ycfg configurations, either one JSON
+ * object after the other (NDJSON, or pretty printed objects one after
+ * the other) or the elements of one top level JSON array.
+ *
+ * The file is mapped, not read.  Finding where the configurations start
+ * and end only needs their braces and strings, so that is done lazily,
+ * as far as the highest index asked for, and remembered; a configuration
+ * is only parsed when it is fetched with ykp_bundle_get().
+ */
+
+struct ykp_bundle_doc {
+	size_t offset;
+	size_t len;
+};
+
+struct ykp_bundle_t {
+	const char *data;
+	size_t len;
+	int array;
+	/* where indexing continues, and whether it has reached the end or
+	 * something that is not a configuration */
+	size_t scan;
+	int done;
+	int bad;
+	struct ykp_bundle_doc *docs;
+	size_t num_docs;
+	size_t max_docs;
+};
+
+static size_t _bundle_ws(const YKP_BUNDLE *bundle, size_t p)
+{
+	while (p < bundle->len &&
+	       (bundle->data[p] == ' ' || bundle->data[p] == '\t' ||
+		bundle->data[p] == '\n' || bundle->data[p] == '\r'))
+		p++;
+	return p;
+}
+
+static int _bundle_add(YKP_BUNDLE *bundle, size_t offset, size_t len)
+{
+	if (bundle->num_docs == bundle->max_docs) {
+		size_t max = bundle->max_docs ? bundle->max_docs * 2 : 64;
+		struct ykp_bundle_doc *docs =
+			realloc(bundle->docs, max * sizeof(*docs));
+		if (!docs)
+			return 0;
+		bundle->docs = docs;
+		bundle->max_docs = max;
+	}
+	bundle->docs[bundle->num_docs].offset = offset;
+	bundle->docs[bundle->num_docs].len = len;
+	bundle->num_docs++;
+	return 1;
+}
+
+/* Index the next configuration: 1 if there was one, 0 at the end of the
+ * bundle, -1 if what follows isn't a configuration or memory ran out. */
+static int _bundle_next(YKP_BUNDLE *bundle)
+{
+	size_t p = _bundle_ws(bundle, bundle->scan);
+	size_t start;
+	int depth = 0;
+
+	if (bundle->array) {
+		if (p < bundle->len && bundle->data[p] == ']') {
+			/* nothing but whitespace after the array */
+			return _bundle_ws(bundle, p + 1) == bundle->len ? 0 : -1;
+		}
+		if (bundle->num_docs > 0) {
+			if (p == bundle->len || bundle->data[p] != ',')
+				return -1;
+			p = _bundle_ws(bundle, p + 1);
+		}
+	} else if (p == bundle->len) {
+		return 0;
+	}
+
+	if (p == bundle->len || bundle->data[p] != '{')
+		return -1;
+	start = p;
+	for (; p < bundle->len; p++) {
+		char c = bundle->data[p];
+
+		if (c == '"') {
+			for (p++; p < bundle->len && bundle->data[p] != '"'; p++) {
+				if (bundle->data[p] == '\\')
+					p++;
+			}
+			if (p >= bundle->len)
+				return -1;
+		} else if (c == '{' || c == '[') {
+			depth++;
+		} else if (c == '}' || c == ']') {
+			if (--depth == 0)
+				break;
+		}
+	}
+	if (p == bundle->len)
+		return -1;
+	p++;
+	if (!_bundle_add(bundle, start, p - start))
+		return -1;
+	bundle->scan = p;
+	return 1;
+}
+
+/* Index up to and including configuration index, or all of them. */
+static void _bundle_index(YKP_BUNDLE *bundle, size_t index)
+{
+	while (!bundle->done && !bundle->bad && bundle->num_docs <= index) {
+		int rc = _bundle_next(bundle);
+		if (rc == 0)
+			bundle->done = 1;
+		else if (rc < 0)
+			bundle->bad = 1;
+	}
+}
+
+static void _bundle_unmap(YKP_BUNDLE *bundle)
+{
+	if (!bundle->data)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(bundle->data);
+#else
+	munmap((void *)bundle->data, bundle->len);
+#endif
+}
+
+YKP_BUNDLE *ykp_bundle_open(const char *filename)
+{
+	YKP_BUNDLE *bundle = calloc(1, sizeof(YKP_BUNDLE));
+	struct stat sb;
+	size_t p;
+	int fd;
+
+	if (!bundle)
+		return 0;
+
+	fd = open(filename, O_RDONLY | O_BINARY);
+	if (fd == -1)
+		goto err;
+	if (fstat(fd, &sb) != 0 || sb.st_size < 0 ||
+	    (unsigned long long)sb.st_size > (size_t)-1) {
+		close(fd);
+		goto err;
+	}
+	bundle->len = (size_t)sb.st_size;
+
+	if (bundle->len > 0) {
+#ifdef _WIN32
+		HANDLE map = CreateFileMapping((HANDLE)_get_osfhandle(fd), NULL,
+					       PAGE_READONLY, 0, 0, NULL);
+		if (map) {
+			bundle->data = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(map);
+		}
+#else
+		void *data = mmap(NULL, bundle->len, PROT_READ, MAP_PRIVATE,
+				  fd, 0);
+		if (data != MAP_FAILED)
+			bundle->data = data;
+#endif
+		if (!bundle->data) {
+			close(fd);
+			goto err;
+		}
+	}
+	/* the mapping stays valid without the descriptor */
+	close(fd);
+
+	p = _bundle_ws(bundle, 0);
+	if (p < bundle->len && bundle->data[p] == '[') {
+		bundle->array = 1;
+		p++;
+	}
+	bundle->scan = p;
+	return bundle;
+
+err:
+	free(bundle);
+	ykp_errno = YKP_EIO;
+	return 0;
+}
+
+int ykp_bundle_close(YKP_BUNDLE *bundle)
+{
+	if (bundle) {
+		_bundle_unmap(bundle);
+		free(bundle->docs);
+		free(bundle);
+		return 1;
+	}
+	return 0;
+}
+
+size_t ykp_bundle_count(YKP_BUNDLE *bundle)
+{
+	if (!bundle)
+		return 0;
+	_bundle_index(bundle, (size_t)-1);
+	return bundle->num_docs;
+}
+
+int ykp_bundle_get(YKP_BUNDLE *bundle, size_t index, YKP_CONFIG *cfg)
+{
+	const struct ykp_bundle_doc *doc;
+
+	if (!bundle) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	_bundle_index(bundle, index);
+	if (index >= bundle->num_docs) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	doc = &bundle->docs[index];
+	return _ykp_json_import_cfg(cfg, bundle->data + doc->offset, doc->len);
+}
@@ -0,0 +1,286 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ykpers_lcl.h"
+#include "ykbzero.h"
+
+#include <ykpers.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <yubikey.h>
+
+/* Export of configurations in the formats validation servers import,
+ * one record at a time.  Nothing is kept between calls and every record
+ * is formatted in a buffer on the stack and handed to the writer in one
+ * call, so this can sit in a provisioning loop.
+ *
+ * YKP_FORMAT_KSM is the yubikey-ksm import format, for Yubico OTP:
+ *   serialnr,identity,internaluid,aeskey,lockpw,created,accessed
+ *
+ * YKP_FORMAT_PSKC is an RFC 6030 KeyContainer, for OATH-HOTP (hotp, the
+ * counter is the initial moving factor) and HMAC-SHA1 challenge-response
+ * (totp with a 30 second time step).
+ */
+
+#define EXPORT_BUFSIZE	1024
+
+static const char pskc_begin[] =
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	"<KeyContainer Version=\"1.0\" xmlns=\"urn:ietf:params:xml:ns:keyprov:pskc\">\n";
+static const char pskc_end[] =
+	"</KeyContainer>\n";
+static const char ksm_begin[] =
+	"# ykksm 1\n";
+
+static int _export_write(int (*writer)(const char *buf, size_t count,
+				       void *userdata),
+			 void *userdata, const char *buf, size_t count)
+{
+	if (writer(buf, count, userdata) != (int)count) {
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+	return 1;
+}
+
+static void _export_base64(char *dst, const unsigned char *src, size_t len)
+{
+	static const char b64[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	size_t i;
+
+	for (i = 0; i + 2 < len; i += 3) {
+		*dst++ = b64[src[i] >> 2];
+		*dst++ = b64[((src[i] & 0x03) << 4) | (src[i + 1] >> 4)];
+		*dst++ = b64[((src[i + 1] & 0x0f) << 2) | (src[i + 2] >> 6)];
+		*dst++ = b64[src[i + 2] & 0x3f];
+	}
+	if (i < len) {
+		*dst++ = b64[src[i] >> 2];
+		if (i + 1 < len) {
+			*dst++ = b64[((src[i] & 0x03) << 4) | (src[i + 1] >> 4)];
+			*dst++ = b64[(src[i + 1] & 0x0f) << 2];
+		} else {
+			*dst++ = b64[(src[i] & 0x03) << 4];
+			*dst++ = '=';
+		}
+		*dst++ = '=';
+	}
+	*dst = '\0';
+}
+
+static int _export_ksm(char *buf, size_t len, const YKP_CONFIG *cfg,
+		       unsigned int serial)
+{
+	const YK_CONFIG *ycfg = &cfg->ykcore_config;
+	char fixed[FIXED_SIZE * 2 + 1];
+	char uid[UID_SIZE * 2 + 1];
+	char key[KEY_SIZE * 2 + 1];
+	char acc_code[ACC_CODE_SIZE * 2 + 1];
+	char created[32];
+	time_t now = time(NULL);
+	struct tm tm;
+	int written;
+
+#ifdef _WIN32
+	if (gmtime_s(&tm, &now) != 0)
+		return -1;
+#else
+	if (!gmtime_r(&now, &tm))
+		return -1;
+#endif
+	strftime(created, sizeof(created), "%Y-%m-%dT%H:%M:%S", &tm);
+
+	yubikey_modhex_encode(fixed, (const char *)ycfg->fixed,
+			      ycfg->fixedSize <= FIXED_SIZE ? ycfg->fixedSize : FIXED_SIZE);
+	yubikey_hex_encode(uid, (const char *)ycfg->uid, UID_SIZE);
+	yubikey_hex_encode(key, (const char *)ycfg->key, KEY_SIZE);
+	yubikey_hex_encode(acc_code, (const char *)ycfg->accCode, ACC_CODE_SIZE);
+
+	written = snprintf(buf, len, "%u,%s,%s,%s,%s,%s,\n",
+			   serial, fixed, uid, key, acc_code, created);
+
+	insecure_memzero(uid, sizeof(uid));
+	insecure_memzero(key, sizeof(key));
+	insecure_memzero(acc_code, sizeof(acc_code));
+	return written;
+}
+
+static int _export_pskc(char *buf, size_t len, const YKP_CONFIG *cfg,
+			unsigned int serial, int mode)
+{
+	const YK_CONFIG *ycfg = &cfg->ykcore_config;
+	unsigned char secret[KEY_SIZE + 4];
+	char secret64[((sizeof(secret) + 2) / 3) * 4 + 1];
+	char id[32];
+	int digits = 6;
+	int slot = 0;
+	int written;
+
+	/* the last four bytes of the 20 byte HMAC key are in the uid */
+	memcpy(secret, ycfg->key, KEY_SIZE);
+	memcpy(secret + KEY_SIZE, ycfg->uid, 4);
+	_export_base64(secret64, secret, sizeof(secret));
+	insecure_memzero(secret, sizeof(secret));
+
+	if (cfg->command == SLOT_CONFIG || cfg->command == SLOT_UPDATE1)
+		slot = 1;
+	else if (cfg->command == SLOT_CONFIG2 || cfg->command == SLOT_UPDATE2)
+		slot = 2;
+	if (slot)
+		snprintf(id, sizeof(id), "%u:%d", serial, slot);
+	else
+		snprintf(id, sizeof(id), "%u", serial);
+
+	if (mode == MODE_OATH_HOTP) {
+		struct ykp_view_st view;
+		unsigned long imf;
+
+		_ykp_config_view(cfg, &view);
+		imf = view.oath_imf;
+		if ((ycfg->cfgFlags & CFGFLAG_OATH_HOTP8) == CFGFLAG_OATH_HOTP8)
+			digits = 8;
+		written = snprintf(buf, len,
+				   "  <KeyPackage>\n"
+				   "    <DeviceInfo>\n"
+				   "      <Manufacturer>oath.UB</Manufacturer>\n"
+				   "      <SerialNo>%u</SerialNo>\n"
+				   "    </DeviceInfo>\n"
+				   "    <Key Id=\"%s\" Algorithm=\"urn:ietf:params:xml:ns:keyprov:pskc:hotp\">\n"
+				   "      <AlgorithmParameters>\n"
+				   "        <ResponseFormat Encoding=\"DECIMAL\" Length=\"%d\"/>\n"
+				   "      </AlgorithmParameters>\n"
+				   "      <Data>\n"
+				   "        <Secret>\n"
+				   "          <PlainValue>%s</PlainValue>\n"
+				   "        </Secret>\n"
+				   "        <Counter>\n"
+				   "          <PlainValue>%lu</PlainValue>\n"
+				   "        </Counter>\n"
+				   "      </Data>\n"
+				   "    </Key>\n"
+				   "  </KeyPackage>\n",
+				   serial, id, digits, secret64, imf);
+	} else {
+		written = snprintf(buf, len,
+				   "  <KeyPackage>\n"
+				   "    <DeviceInfo>\n"
+				   "      <Manufacturer>oath.UB</Manufacturer>\n"
+				   "      <SerialNo>%u</SerialNo>\n"
+				   "    </DeviceInfo>\n"
+				   "    <Key Id=\"%s\" Algorithm=\"urn:ietf:params:xml:ns:keyprov:pskc:totp\">\n"
+				   "      <AlgorithmParameters>\n"
+				   "        <ResponseFormat Encoding=\"DECIMAL\" Length=\"%d\"/>\n"
+				   "      </AlgorithmParameters>\n"
+				   "      <Data>\n"
+				   "        <Secret>\n"
+				   "          <PlainValue>%s</PlainValue>\n"
+				   "        </Secret>\n"
+				   "        <TimeInterval>\n"
+				   "          <PlainValue>30</PlainValue>\n"
+				   "        </TimeInterval>\n"
+				   "      </Data>\n"
+				   "    </Key>\n"
+				   "  </KeyPackage>\n",
+				   serial, id, digits, secret64);
+	}
+
+	insecure_memzero(secret64, sizeof(secret64));
+	return written;
+}
+
+int ykp_export_server_begin(int format,
+			    int (*writer)(const char *buf, size_t count,
+					  void *userdata),
+			    void *userdata)
+{
+	if (format == YKP_FORMAT_KSM)
+		return _export_write(writer, userdata, ksm_begin,
+				     sizeof(ksm_begin) - 1);
+	if (format == YKP_FORMAT_PSKC)
+		return _export_write(writer, userdata, pskc_begin,
+				     sizeof(pskc_begin) - 1);
+	ykp_errno = YKP_EINVAL;
+	return 0;
+}
+
+int ykp_export_server_config(int format, const YKP_CONFIG *cfg,
+			     unsigned int serial,
+			     int (*writer)(const char *buf, size_t count,
+					   void *userdata),
+			     void *userdata)
+{
+	char buf[EXPORT_BUFSIZE];
+	int mode;
+	int written;
+	int ret;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	mode = _ykp_config_mode(cfg);
+
+	if (format == YKP_FORMAT_KSM && mode == MODE_OTP_YUBICO) {
+		written = _export_ksm(buf, sizeof(buf), cfg, serial);
+	} else if (format == YKP_FORMAT_PSKC &&
+		   (mode == MODE_OATH_HOTP || mode == MODE_CHAL_HMAC)) {
+		written = _export_pskc(buf, sizeof(buf), cfg, serial, mode);
+	} else {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (written < 0 || (size_t)written >= sizeof(buf)) {
+		insecure_memzero(buf, sizeof(buf));
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+
+	ret = _export_write(writer, userdata, buf, (size_t)written);
+	insecure_memzero(buf, (size_t)written);
+	return ret;
+}
+
+int ykp_export_server_end(int format,
+			  int (*writer)(const char *buf, size_t count,
+					void *userdata),
+			  void *userdata)
+{
+	if (format == YKP_FORMAT_KSM)
+		return 1;
+	if (format == YKP_FORMAT_PSKC)
+		return _export_write(writer, userdata, pskc_end,
+				     sizeof(pskc_end) - 1);
+	ykp_errno = YKP_EINVAL;
+	return 0;
+}
@@ -0,0 +1,461 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ykpers_lcl.h"
+#include "ykbzero.h"
+
+#include <ykpers.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/* The journal is a file of fixed size records, appended to with
+ * O_APPEND, one for every successful write of a configuration:
+ *
+ *   0	 format version (JOURNAL_VERSION)
+ *   1	 slot (1 or 2)
+ *   2	 mode (MODE_*)
+ *   3	 program sequence after the write
+ *   4	 slot valid bits of touchLevel after the write
+ *   5	 fixedSize
+ *   6	 tktFlags
+ *   7	 cfgFlags
+ *   8	 extFlags
+ *   9	 reserved (0)
+ *  12	 serial number, big endian
+ *  16	 time of the write, seconds since the epoch, big endian
+ *  24	 fingerprint
+ *  44	 fingerprint including secrets
+ *  64	 fixed
+ *  80	 uid
+ *  86	 key
+ * 102	 accCode
+ * 108	 reserved (0)
+ * 126	 crc16, stored like the crc of YK_CONFIG
+ *
+ * Later records override earlier ones.  A crash can at most leave the
+ * last record incomplete, so at open a partial or bad last record is
+ * truncated away.  A bad record before the last one is not what a
+ * crash leaves, the open fails and the file is left alone.
+ */
+
+#define JOURNAL_VERSION		0x01
+#define JOURNAL_RECORD_SIZE	128
+
+#define REC_VERSION	0
+#define REC_SLOT	1
+#define REC_MODE	2
+#define REC_PGM_SEQ	3
+#define REC_VALID	4
+#define REC_FIXED_SIZE	5
+#define REC_TKT_FLAGS	6
+#define REC_CFG_FLAGS	7
+#define REC_EXT_FLAGS	8
+#define REC_SERIAL	12
+#define REC_TIME	16
+#define REC_FP		24
+#define REC_FP_SECRETS	(REC_FP + YKP_FINGERPRINT_SIZE)
+#define REC_FIXED	64
+#define REC_UID		(REC_FIXED + FIXED_SIZE)
+#define REC_KEY		(REC_UID + UID_SIZE)
+#define REC_ACC_CODE	(REC_KEY + KEY_SIZE)
+#define REC_CRC		(JOURNAL_RECORD_SIZE - 2)
+
+#define VALID_MASK	(CONFIG1_VALID | CONFIG2_VALID)
+
+/* What is kept in memory, the secrets stay in the file. */
+struct ykp_journal_entry {
+	unsigned int serial;
+	int slot;
+	unsigned int pgm_seq;
+	unsigned int valid;
+	unsigned char fp[YKP_FINGERPRINT_SIZE];
+	unsigned char fp_secrets[YKP_FINGERPRINT_SIZE];
+};
+
+struct ykp_journal_t {
+	int fd;
+	unsigned int sync_interval;
+	unsigned int unsynced;
+	struct ykp_journal_entry *entries;
+	size_t num_entries;
+	size_t max_entries;
+};
+
+static int _journal_slot(const YKP_CONFIG *cfg)
+{
+	if (cfg->command == SLOT_CONFIG)
+		return 1;
+	if (cfg->command == SLOT_CONFIG2)
+		return 2;
+	return 0;
+}
+
+static int _journal_add(YKP_JOURNAL *journal,
+			const struct ykp_journal_entry *entry)
+{
+	if (journal->num_entries == journal->max_entries) {
+		size_t max = journal->max_entries ? journal->max_entries * 2 : 64;
+		struct ykp_journal_entry *entries =
+			realloc(journal->entries, max * sizeof(*entries));
+		if (!entries)
+			return 0;
+		journal->entries = entries;
+		journal->max_entries = max;
+	}
+	journal->entries[journal->num_entries++] = *entry;
+	return 1;
+}
+
+static bool _journal_check(const unsigned char *rec)
+{
+	if (rec[REC_VERSION] != JOURNAL_VERSION)
+		return false;
+	if (rec[REC_SLOT] < 1 || rec[REC_SLOT] > 2)
+		return false;
+	return _ykp_crc16(rec, JOURNAL_RECORD_SIZE) == YK_CRC_OK_RESIDUAL;
+}
+
+static void _journal_decode(const unsigned char *rec,
+			    struct ykp_journal_entry *entry)
+{
+	entry->serial = (unsigned int)rec[REC_SERIAL] << 24 |
+		(unsigned int)rec[REC_SERIAL + 1] << 16 |
+		(unsigned int)rec[REC_SERIAL + 2] << 8 |
+		rec[REC_SERIAL + 3];
+	entry->slot = rec[REC_SLOT];
+	entry->pgm_seq = rec[REC_PGM_SEQ];
+	entry->valid = rec[REC_VALID];
+	memcpy(entry->fp, rec + REC_FP, YKP_FINGERPRINT_SIZE);
+	memcpy(entry->fp_secrets, rec + REC_FP_SECRETS, YKP_FINGERPRINT_SIZE);
+}
+
+static int _journal_encode(unsigned char *rec, unsigned int serial,
+			   const YKP_CONFIG *cfg, const YK_STATUS *st)
+{
+	const YK_CONFIG *ycfg = &cfg->ykcore_config;
+	unsigned long long now = (unsigned long long)time(NULL);
+	unsigned short crc;
+	int i;
+
+	memset(rec, 0, JOURNAL_RECORD_SIZE);
+	rec[REC_VERSION] = JOURNAL_VERSION;
+	rec[REC_SLOT] = _journal_slot(cfg);
+	rec[REC_MODE] = _ykp_config_mode(cfg);
+	rec[REC_PGM_SEQ] = ykds_pgm_seq(st);
+	rec[REC_VALID] = ykds_touch_level(st) & VALID_MASK;
+	rec[REC_FIXED_SIZE] = ycfg->fixedSize;
+	rec[REC_TKT_FLAGS] = ycfg->tktFlags;
+	rec[REC_CFG_FLAGS] = ycfg->cfgFlags;
+	rec[REC_EXT_FLAGS] = ycfg->extFlags;
+	for (i = 0; i < 4; i++)
+		rec[REC_SERIAL + i] = (serial >> (24 - 8 * i)) & 0xff;
+	for (i = 0; i < 8; i++)
+		rec[REC_TIME + i] = (now >> (56 - 8 * i)) & 0xff;
+	if (!ykp_config_fingerprint(cfg, 0, rec + REC_FP,
+				    YKP_FINGERPRINT_SIZE) ||
+	    !ykp_config_fingerprint(cfg, YKP_FINGERPRINT_SECRETS,
+				    rec + REC_FP_SECRETS, YKP_FINGERPRINT_SIZE))
+		return 0;
+	memcpy(rec + REC_FIXED, ycfg->fixed, FIXED_SIZE);
+	memcpy(rec + REC_UID, ycfg->uid, UID_SIZE);
+	memcpy(rec + REC_KEY, ycfg->key, KEY_SIZE);
+	memcpy(rec + REC_ACC_CODE, ycfg->accCode, ACC_CODE_SIZE);
+
+	crc = ~_ykp_crc16(rec, REC_CRC);
+	rec[REC_CRC] = crc & 0xff;
+	rec[REC_CRC + 1] = (crc >> 8) & 0xff;
+	return 1;
+}
+
+static int _journal_read(int fd, unsigned char *rec)
+{
+	size_t got = 0;
+
+	while (got < JOURNAL_RECORD_SIZE) {
+		int n = read(fd, rec + got, JOURNAL_RECORD_SIZE - got);
+		if (n <= 0)
+			return n < 0 ? -1 : 0;
+		got += n;
+	}
+	return 1;
+}
+
+YKP_JOURNAL *ykp_journal_open(const char *filename)
+{
+	YKP_JOURNAL *journal = calloc(1, sizeof(YKP_JOURNAL));
+	unsigned char rec[JOURNAL_RECORD_SIZE];
+	struct stat sb;
+	size_t good;
+	int rc;
+
+	if (!journal)
+		return 0;
+	journal->sync_interval = 1;
+
+	journal->fd = open(filename, O_RDWR | O_CREAT | O_APPEND | O_BINARY,
+			   0600);
+	if (journal->fd == -1) {
+		free(journal);
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+
+	while ((rc = _journal_read(journal->fd, rec)) == 1 &&
+	       _journal_check(rec)) {
+		struct ykp_journal_entry entry;
+
+		_journal_decode(rec, &entry);
+		if (!_journal_add(journal, &entry)) {
+			ykp_journal_close(journal);
+			insecure_memzero(rec, sizeof(rec));
+			return 0;
+		}
+	}
+	insecure_memzero(rec, sizeof(rec));
+	if (rc == -1 || fstat(journal->fd, &sb) != 0)
+		goto err;
+
+	/* A whole record with a bad crc and more after it is corruption,
+	 * truncating there would throw the good records after it away. */
+	if (rc == 1 && (size_t)sb.st_size >
+	    (journal->num_entries + 1) * JOURNAL_RECORD_SIZE)
+		goto err;
+
+	/* Drop the partial or bad last record, that is what an
+	 * interrupted append leaves behind. */
+	good = journal->num_entries * JOURNAL_RECORD_SIZE;
+	if ((size_t)sb.st_size != good) {
+		if (_ykp_file_truncate(journal->fd, good) != 0 ||
+		    _ykp_file_sync(journal->fd) != 0)
+			goto err;
+	}
+
+	return journal;
+
+err:
+	ykp_journal_close(journal);
+	ykp_errno = YKP_EIO;
+	return 0;
+}
+
+int ykp_journal_set_sync_interval(YKP_JOURNAL *journal, unsigned int records)
+{
+	if (journal) {
+		journal->sync_interval = records;
+		return 1;
+	}
+	ykp_errno = YKP_EINVAL;
+	return 0;
+}
+
+int ykp_journal_sync(YKP_JOURNAL *journal)
+{
+	if (!journal) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (journal->unsynced) {
+		if (_ykp_file_sync(journal->fd) != 0) {
+			ykp_errno = YKP_EIO;
+			return 0;
+		}
+		journal->unsynced = 0;
+	}
+	return 1;
+}
+
+int ykp_journal_close(YKP_JOURNAL *journal)
+{
+	int ret = 1;
+
+	if (journal) {
+		if (!ykp_journal_sync(journal))
+			ret = 0;
+		if (close(journal->fd) != 0) {
+			ykp_errno = YKP_EIO;
+			ret = 0;
+		}
+		free(journal->entries);
+		free(journal);
+		return ret;
+	}
+	return 0;
+}
+
+int ykp_journal_record(YKP_JOURNAL *journal, unsigned int serial,
+		       const YKP_CONFIG *cfg, const YK_STATUS *st)
+{
+	unsigned char rec[JOURNAL_RECORD_SIZE];
+	struct ykp_journal_entry entry;
+	int n;
+
+	if (!journal || !st) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	if (_journal_slot(cfg) == 0) {
+		ykp_errno = YKP_EINVCONFNUM;
+		return 0;
+	}
+
+	if (!_journal_encode(rec, serial, cfg, st)) {
+		insecure_memzero(rec, sizeof(rec));
+		return 0;
+	}
+	_journal_decode(rec, &entry);
+
+	/* One write per record, with O_APPEND it lands in one piece at the
+	 * end of the file.  If it does not, the fragment is left for the
+	 * next open to drop: others may have appended since this journal
+	 * was opened, so its own count says nothing about where to cut. */
+	n = write(journal->fd, rec, JOURNAL_RECORD_SIZE);
+	insecure_memzero(rec, sizeof(rec));
+	if (n != JOURNAL_RECORD_SIZE) {
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+	if (!_journal_add(journal, &entry))
+		return 0;
+
+	journal->unsynced++;
+	if (journal->sync_interval &&
+	    journal->unsynced >= journal->sync_interval)
+		return ykp_journal_sync(journal);
+	return 1;
+}
+
+size_t ykp_journal_count(const YKP_JOURNAL *journal)
+{
+	return journal ? journal->num_entries : 0;
+}
+
+int ykp_journal_get(const YKP_JOURNAL *journal, size_t index,
+		    unsigned int *serial, YKP_CONFIG *cfg)
+{
+	unsigned char rec[JOURNAL_RECORD_SIZE];
+	YK_CONFIG *ycfg;
+
+	if (!journal || index >= journal->num_entries) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+
+	if (lseek(journal->fd, (off_t)index * JOURNAL_RECORD_SIZE,
+		  SEEK_SET) == (off_t)-1 ||
+	    _journal_read(journal->fd, rec) != 1 ||
+	    !_journal_check(rec)) {
+		insecure_memzero(rec, sizeof(rec));
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+
+	ycfg = &cfg->ykcore_config;
+	memset(ycfg, 0, sizeof(*ycfg));
+	cfg->command = rec[REC_SLOT] == 1 ? SLOT_CONFIG : SLOT_CONFIG2;
+	ycfg->fixedSize = rec[REC_FIXED_SIZE];
+	ycfg->tktFlags = rec[REC_TKT_FLAGS];
+	ycfg->cfgFlags = rec[REC_CFG_FLAGS];
+	ycfg->extFlags = rec[REC_EXT_FLAGS];
+	memcpy(ycfg->fixed, rec + REC_FIXED, FIXED_SIZE);
+	memcpy(ycfg->uid, rec + REC_UID, UID_SIZE);
+	memcpy(ycfg->key, rec + REC_KEY, KEY_SIZE);
+	memcpy(ycfg->accCode, rec + REC_ACC_CODE, ACC_CODE_SIZE);
+	if (serial)
+		*serial = journal->entries[index].serial;
+
+	insecure_memzero(rec, sizeof(rec));
+	return 1;
+}
+
+bool ykp_journal_is_current(const YKP_JOURNAL *journal, unsigned int serial,
+			    const YKP_CONFIG *cfg, const YK_STATUS *st,
+			    int flags)
+{
+	const struct ykp_journal_entry *last = NULL;
+	const struct ykp_journal_entry *slot = NULL;
+	unsigned char fp[YKP_FINGERPRINT_SIZE];
+	size_t i;
+	int slotnum;
+
+	if (!journal || !cfg || !st)
+		return false;
+	slotnum = _journal_slot(cfg);
+
+	/* The newest entry for the key tells us what the key looked like
+	 * after our last write to it, the newest entry for the slot what we
+	 * put in that slot. */
+	for (i = journal->num_entries; i > 0 && !slot; i--) {
+		const struct ykp_journal_entry *entry = &journal->entries[i - 1];
+		if (entry->serial != serial)
+			continue;
+		if (!last)
+			last = entry;
+		if (entry->slot == slotnum)
+			slot = entry;
+	}
+	if (!slot)
+		return false;
+
+	/* Anything else writing to the key bumps the program sequence. */
+	if (ykds_pgm_seq(st) == 0 ||
+	    last->pgm_seq != (unsigned int)ykds_pgm_seq(st) ||
+	    last->valid != (ykds_touch_level(st) & VALID_MASK))
+		return false;
+
+	if (!ykp_config_fingerprint(cfg, flags & YKP_FINGERPRINT_SECRETS,
+				    fp, sizeof(fp)))
+		return false;
+	if (flags & YKP_FINGERPRINT_SECRETS)
+		return memcmp(fp, slot->fp_secrets, sizeof(fp)) == 0;
+	return memcmp(fp, slot->fp, sizeof(fp)) == 0;
+}
@@ -38,6 +38,10 @@ extern "C" {
 # endif
 
 int _ykp_json_export_cfg(const YKP_CONFIG *cfg, char *json, size_t len);
+int _ykp_json_write_cfg(const YKP_CONFIG *cfg,
+			int (*writer)(const char *buf, size_t count,
+				      void *userdata),
+			void *userdata);
 int _ykp_json_import_cfg(YKP_CONFIG *cfg, const char *json, size_t len);
 
 # ifdef __cplusplus
@@ -0,0 +1,213 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ykpers_lcl.h"
+#include "ykbzero.h"
+
+#include <ykpers.h>
+
+#include <limits.h>
+#include <string.h>
+
+#include "sha.h"
+
+/* Counters hashed per hmacSHA1KeyedMulti() call, a few groups of
+ * lanes. */
+#define OATH_BATCH	64
+
+static const unsigned int _modulus[] = { 1000000, 10000000, 100000000 };
+
+int ykp_oath_truncate(const unsigned char *hmac, int digits,
+		      unsigned int *code)
+{
+	unsigned int offset;
+	unsigned int bin_code;
+
+	if (!hmac || !code || digits < 6 || digits > 8) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+
+	offset = hmac[19] & 0xf;
+	bin_code = (hmac[offset] & 0x7f) << 24
+		| (hmac[offset + 1] & 0xff) << 16
+		| (hmac[offset + 2] & 0xff) << 8
+		| (hmac[offset + 3] & 0xff);
+	*code = bin_code % _modulus[digits - 6];
+	return 1;
+}
+
+/* The codes of count counters, at most OATH_BATCH. */
+static int _codes(const HMACKeyed *keyed, const uint64_t *counters,
+		  size_t count, int digits, unsigned int *codes)
+{
+	unsigned char texts[OATH_BATCH][8];
+	uint8_t digests[OATH_BATCH][SHA1HashSize];
+	size_t i;
+	int j;
+
+	if (!count)
+		return 1;
+	for (i = 0; i < count; i++)
+		for (j = 0; j < 8; j++)
+			texts[i][j] = (unsigned char)
+				(counters[i] >> 8 * (7 - j));
+	if (hmacSHA1KeyedMulti(keyed, &texts[0][0], 8, (int)count, digests)) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	for (i = 0; i < count; i++)
+		ykp_oath_truncate(digests[i], digits, &codes[i]);
+	insecure_memzero(digests, sizeof(digests));
+	return 1;
+}
+
+static int _keyed(HMACKeyed *keyed, const unsigned char *secret,
+		  size_t secret_len, int digits)
+{
+	if ((!secret && secret_len) || secret_len > INT_MAX ||
+	    digits < 6 || digits > 8 ||
+	    hmacKeyedReset(keyed, SHA1, secret, (int)secret_len)) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	return 1;
+}
+
+int ykp_oath_hotp_codes(const unsigned char *secret, size_t secret_len,
+			uint64_t counter, size_t count, int digits,
+			unsigned int *codes)
+{
+	HMACKeyed keyed;
+	uint64_t counters[OATH_BATCH];
+	size_t i, j, n;
+	int rc = 1;
+
+	if (!codes && count) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (!_keyed(&keyed, secret, secret_len, digits))
+		return 0;
+
+	for (i = 0; i < count && rc; i += n) {
+		n = count - i < OATH_BATCH ? count - i : OATH_BATCH;
+		for (j = 0; j < n; j++)
+			counters[j] = counter + i + j;
+		rc = _codes(&keyed, counters, n, digits, codes + i);
+	}
+	insecure_memzero(&keyed, sizeof(keyed));
+	return rc;
+}
+
+int ykp_oath_hotp_validate(const unsigned char *secret, size_t secret_len,
+			   uint64_t counter, size_t window, int digits,
+			   unsigned int code, uint64_t *matched)
+{
+	HMACKeyed keyed;
+	uint64_t counters[OATH_BATCH];
+	unsigned int codes[OATH_BATCH];
+	size_t i, j, n;
+	int rc = 0;
+
+	if (!matched) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (!_keyed(&keyed, secret, secret_len, digits))
+		return 0;
+
+	/* a batch at a time, so a match near counter stops early */
+	ykp_errno = 0;
+	for (i = 0; i < window && !rc; i += n) {
+		n = window - i < OATH_BATCH ? window - i : OATH_BATCH;
+		for (j = 0; j < n; j++)
+			counters[j] = counter + i + j;
+		if (!_codes(&keyed, counters, n, digits, codes))
+			break;
+		for (j = 0; j < n; j++) {
+			if (codes[j] == code) {
+				*matched = counters[j];
+				rc = 1;
+				break;
+			}
+		}
+	}
+	insecure_memzero(&keyed, sizeof(keyed));
+	return rc;
+}
+
+int ykp_oath_totp_validate(const unsigned char *secret, size_t secret_len,
+			   uint64_t now, unsigned int step,
+			   unsigned int drift, int digits,
+			   unsigned int code, int *offset)
+{
+	HMACKeyed keyed;
+	uint64_t counters[OATH_BATCH];
+	int offsets[OATH_BATCH];
+	unsigned int codes[OATH_BATCH];
+	uint64_t t, k, d;
+	size_t j, n;
+	int rc = 0;
+
+	if (!offset || step == 0 || drift > INT_MAX) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (!_keyed(&keyed, secret, secret_len, digits))
+		return 0;
+
+	/* steps t, t - 1, t + 1, t - 2, ... a batch at a time */
+	t = now / step;
+	ykp_errno = 0;
+	for (k = 0; k <= 2 * (uint64_t)drift && !rc; ) {
+		for (n = 0; n < OATH_BATCH && k <= 2 * (uint64_t)drift; k++) {
+			d = (k + 1) / 2;
+			if ((k & 1) && t >= d) {
+				counters[n] = t - d;
+				offsets[n++] = -(int)d;
+			} else if (!(k & 1) && t + d >= t) {
+				counters[n] = t + d;
+				offsets[n++] = (int)d;
+			}
+		}
+		if (!_codes(&keyed, counters, n, digits, codes))
+			break;
+		for (j = 0; j < n; j++) {
+			if (codes[j] == code) {
+				*offset = offsets[j];
+				rc = 1;
+				break;
+			}
+		}
+	}
+	insecure_memzero(&keyed, sizeof(keyed));
+	return rc;
+}
@@ -0,0 +1,329 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ykpers_lcl.h"
+#include "ykbzero.h"
+
+#include <ykpers.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/* A record is a configuration in YKP_RECORD_SIZE bytes:
+ *
+ *   0	 format version (RECORD_VERSION)
+ *   1	 firmware version, major, minor and build
+ *   4	 command
+ *   5	 access code type (YKP_ACCCODE_*)
+ *   6	 reserved (0)
+ *   8	 serial number, big endian
+ *  12	 YK_CONFIG up to but not including its crc, that is computed when
+ *	 the configuration is written to a key
+ *  62	 crc16, stored like the crc of YK_CONFIG
+ *
+ * A record file is nothing but records, one after the other, so record
+ * n is at n * YKP_RECORD_SIZE and the file can be mapped and read as an
+ * array.  It is only ever appended to; an incomplete record at the end,
+ * left by a crash, is cut off when the file is opened.
+ */
+
+#define RECORD_VERSION		0x01
+
+#define REC_VERSION	0
+#define REC_MAJOR	1
+#define REC_MINOR	2
+#define REC_BUILD	3
+#define REC_COMMAND	4
+#define REC_ACCCODE	5
+#define REC_SERIAL	8
+#define REC_CONFIG	12
+#define REC_CONFIG_SIZE	offsetof(YK_CONFIG, crc)
+#define REC_CRC		(YKP_RECORD_SIZE - 2)
+
+struct ykp_record_file_t {
+	int fd;
+	size_t num_records;
+	/* the mapping, of the first num_mapped records */
+	const unsigned char *map;
+	size_t num_mapped;
+	int unsynced;
+};
+
+int ykp_export_record(const YKP_CONFIG *cfg, unsigned int serial,
+		      unsigned char *rec, size_t len)
+{
+	unsigned short crc;
+	int i;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	if (!rec || len < YKP_RECORD_SIZE ||
+	    cfg->yk_major_version > 0xff || cfg->yk_minor_version > 0xff ||
+	    cfg->yk_build_version > 0xff || cfg->command > 0xff ||
+	    cfg->ykp_acccode_type > 0xff) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+
+	memset(rec, 0, YKP_RECORD_SIZE);
+	rec[REC_VERSION] = RECORD_VERSION;
+	rec[REC_MAJOR] = cfg->yk_major_version;
+	rec[REC_MINOR] = cfg->yk_minor_version;
+	rec[REC_BUILD] = cfg->yk_build_version;
+	rec[REC_COMMAND] = cfg->command;
+	rec[REC_ACCCODE] = cfg->ykp_acccode_type;
+	for (i = 0; i < 4; i++)
+		rec[REC_SERIAL + i] = (serial >> (24 - 8 * i)) & 0xff;
+	memcpy(rec + REC_CONFIG, &cfg->ykcore_config, REC_CONFIG_SIZE);
+
+	crc = ~_ykp_crc16(rec, REC_CRC);
+	rec[REC_CRC] = crc & 0xff;
+	rec[REC_CRC + 1] = (crc >> 8) & 0xff;
+	return 1;
+}
+
+int ykp_import_record(YKP_CONFIG *cfg, unsigned int *serial,
+		      const unsigned char *rec, size_t len)
+{
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	if (!rec || len < YKP_RECORD_SIZE || rec[REC_VERSION] != RECORD_VERSION ||
+	    _ykp_crc16(rec, YKP_RECORD_SIZE) != YK_CRC_OK_RESIDUAL) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+
+	cfg->yk_major_version = rec[REC_MAJOR];
+	cfg->yk_minor_version = rec[REC_MINOR];
+	cfg->yk_build_version = rec[REC_BUILD];
+	_ykp_set_capabilities(cfg);
+	cfg->command = rec[REC_COMMAND];
+	cfg->ykp_acccode_type = rec[REC_ACCCODE];
+	memcpy(&cfg->ykcore_config, rec + REC_CONFIG, REC_CONFIG_SIZE);
+	cfg->ykcore_config.crc = 0;
+	if (serial)
+		*serial = (unsigned int)rec[REC_SERIAL] << 24 |
+			(unsigned int)rec[REC_SERIAL + 1] << 16 |
+			(unsigned int)rec[REC_SERIAL + 2] << 8 |
+			rec[REC_SERIAL + 3];
+	return 1;
+}
+
+static void _records_unmap(YKP_RECORD_FILE *file)
+{
+	if (!file->map)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(file->map);
+#else
+	munmap((void *)file->map, file->num_mapped * YKP_RECORD_SIZE);
+#endif
+	file->map = NULL;
+	file->num_mapped = 0;
+}
+
+/* Map all records there are, the mapping only grows with the file when
+ * a record past its end is asked for. */
+static int _records_map(YKP_RECORD_FILE *file)
+{
+	size_t len = file->num_records * YKP_RECORD_SIZE;
+
+	_records_unmap(file);
+	if (file->num_records == 0)
+		return 1;
+#ifdef _WIN32
+	{
+		HANDLE map = CreateFileMapping((HANDLE)_get_osfhandle(file->fd),
+					       NULL, PAGE_READONLY, 0, 0, NULL);
+		if (map) {
+			file->map = MapViewOfFile(map, FILE_MAP_READ, 0, 0, len);
+			CloseHandle(map);
+		}
+	}
+#else
+	{
+		void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, file->fd, 0);
+		if (map != MAP_FAILED)
+			file->map = map;
+	}
+#endif
+	if (!file->map)
+		return 0;
+	file->num_mapped = file->num_records;
+	return 1;
+}
+
+YKP_RECORD_FILE *ykp_record_file_open(const char *filename)
+{
+	YKP_RECORD_FILE *file = calloc(1, sizeof(YKP_RECORD_FILE));
+	struct stat sb;
+
+	if (!file)
+		return 0;
+
+	file->fd = open(filename, O_RDWR | O_CREAT | O_APPEND | O_BINARY,
+			0600);
+	if (file->fd == -1) {
+		free(file);
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+	if (fstat(file->fd, &sb) != 0 || sb.st_size < 0)
+		goto err;
+	file->num_records = (size_t)sb.st_size / YKP_RECORD_SIZE;
+
+	/* Drop an incomplete record, that is what an interrupted append
+	 * leaves behind. */
+	if ((size_t)sb.st_size % YKP_RECORD_SIZE != 0) {
+		if (_ykp_file_truncate(file->fd,
+				       file->num_records * YKP_RECORD_SIZE) != 0 ||
+		    _ykp_file_sync(file->fd) != 0)
+			goto err;
+	}
+
+	return file;
+
+err:
+	ykp_record_file_close(file);
+	ykp_errno = YKP_EIO;
+	return 0;
+}
+
+int ykp_record_file_sync(YKP_RECORD_FILE *file)
+{
+	if (!file) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (file->unsynced) {
+		if (_ykp_file_sync(file->fd) != 0) {
+			ykp_errno = YKP_EIO;
+			return 0;
+		}
+		file->unsynced = 0;
+	}
+	return 1;
+}
+
+int ykp_record_file_close(YKP_RECORD_FILE *file)
+{
+	int ret = 1;
+
+	if (file) {
+		_records_unmap(file);
+		if (!ykp_record_file_sync(file))
+			ret = 0;
+		if (close(file->fd) != 0) {
+			ykp_errno = YKP_EIO;
+			ret = 0;
+		}
+		free(file);
+		return ret;
+	}
+	return 0;
+}
+
+int ykp_record_file_append(YKP_RECORD_FILE *file, const YKP_CONFIG *cfg,
+			   unsigned int serial)
+{
+	unsigned char rec[YKP_RECORD_SIZE];
+	int n;
+
+	if (!file) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (!ykp_export_record(cfg, serial, rec, sizeof(rec)))
+		return 0;
+
+	/* One write per record, with O_APPEND it lands in one piece at the
+	 * end of the file.  If it does not, cut it off again so the next
+	 * record does not end up out of step. */
+	n = write(file->fd, rec, YKP_RECORD_SIZE);
+	insecure_memzero(rec, sizeof(rec));
+	if (n != YKP_RECORD_SIZE) {
+		if (n > 0) {
+			_records_unmap(file);
+			_ykp_file_truncate(file->fd,
+					   file->num_records * YKP_RECORD_SIZE);
+		}
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+	file->num_records++;
+	file->unsynced = 1;
+	return 1;
+}
+
+size_t ykp_record_file_count(const YKP_RECORD_FILE *file)
+{
+	return file ? file->num_records : 0;
+}
+
+int ykp_record_file_get(YKP_RECORD_FILE *file, size_t index,
+			unsigned int *serial, YKP_CONFIG *cfg)
+{
+	if (!file || index >= file->num_records) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	if (index >= file->num_mapped && !_records_map(file)) {
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+	if (!ykp_import_record(cfg, serial,
+			       file->map + index * YKP_RECORD_SIZE,
+			       YKP_RECORD_SIZE)) {
+		if (ykp_errno == YKP_EINVAL)
+			ykp_errno = YKP_EIO;
+		return 0;
+	}
+	return 1;
+}
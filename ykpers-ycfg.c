@@ -0,0 +1,833 @@
+/* -*- mode:C; c-file-style: "bsd" -*- */
+/*
+ * Copyright (c) 2026 Yubico AB
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ykpers_lcl.h"
+#include "ykpers-json.h"
+
+#include <ykpers.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include <yubikey.h>
+
+/* The ycfg (JSON) export, written out as it is generated, with the same
+ * layout json-c gives with JSON_C_TO_STRING_PRETTY: two spaces of indent
+ * per level, no space after the colon and members in the order json-c
+ * would have them.  Nothing is allocated, output goes either straight
+ * into a caller buffer or through a small stack buffer to a writer.
+ */
+
+#define YCFG_STAGE_SIZE	256
+#define YCFG_MAX_DEPTH	3
+
+struct ycfg_out {
+	/* caller buffer, or */
+	char *buf;
+	size_t len;
+	/* writer */
+	int (*writer)(const char *buf, size_t count, void *userdata);
+	void *userdata;
+	char stage[YCFG_STAGE_SIZE];
+
+	size_t pos;
+	int error;
+	int depth;
+	int had_members[YCFG_MAX_DEPTH + 1];
+};
+
+static void _ycfg_flush(struct ycfg_out *o)
+{
+	if (o->writer && o->pos > 0 && !o->error) {
+		if (o->writer(o->stage, o->pos, o->userdata) != (int)o->pos) {
+			o->error = 1;
+		}
+		o->pos = 0;
+	}
+}
+
+static void _ycfg_put(struct ycfg_out *o, const char *s, size_t n)
+{
+	if (o->writer) {
+		while (n > 0 && !o->error) {
+			size_t room = sizeof(o->stage) - o->pos;
+			size_t chunk = n < room ? n : room;
+			memcpy(o->stage + o->pos, s, chunk);
+			o->pos += chunk;
+			s += chunk;
+			n -= chunk;
+			if (o->pos == sizeof(o->stage)) {
+				_ycfg_flush(o);
+			}
+		}
+	} else if (o->len > 0) {
+		/* like the strncpy() of the json-c output, quietly cut it
+		 * short if the buffer is too small */
+		size_t room = o->len - 1 - o->pos;
+		size_t chunk = n < room ? n : room;
+		memcpy(o->buf + o->pos, s, chunk);
+		o->pos += chunk;
+	}
+}
+
+static void _ycfg_puts(struct ycfg_out *o, const char *s)
+{
+	_ycfg_put(o, s, strlen(s));
+}
+
+static void _ycfg_indent(struct ycfg_out *o, int depth)
+{
+	static const char spaces[] = "        ";
+
+	_ycfg_put(o, spaces, (size_t)(depth * 2));
+}
+
+static void _ycfg_key(struct ycfg_out *o, const char *key)
+{
+	if (o->had_members[o->depth]) {
+		_ycfg_puts(o, ",\n");
+	}
+	o->had_members[o->depth] = 1;
+	_ycfg_indent(o, o->depth);
+	_ycfg_puts(o, "\"");
+	_ycfg_puts(o, key);
+	_ycfg_puts(o, "\":");
+}
+
+static void _ycfg_open(struct ycfg_out *o, const char *key)
+{
+	if (key) {
+		_ycfg_key(o, key);
+	}
+	_ycfg_puts(o, "{\n");
+	o->depth++;
+	o->had_members[o->depth] = 0;
+}
+
+static void _ycfg_close(struct ycfg_out *o)
+{
+	if (o->had_members[o->depth]) {
+		_ycfg_puts(o, "\n");
+	}
+	o->depth--;
+	_ycfg_indent(o, o->depth);
+	_ycfg_puts(o, "}");
+}
+
+/* Only used for mode names and (mod)hex, none of which json-c escapes. */
+static void _ycfg_string(struct ycfg_out *o, const char *key, const char *value)
+{
+	_ycfg_key(o, key);
+	_ycfg_puts(o, "\"");
+	_ycfg_puts(o, value);
+	_ycfg_puts(o, "\"");
+}
+
+static void _ycfg_int(struct ycfg_out *o, const char *key, int value)
+{
+	char buf[16];
+
+	_ycfg_key(o, key);
+	_ycfg_put(o, buf, (size_t)snprintf(buf, sizeof(buf), "%d", value));
+}
+
+static void _ycfg_bool(struct ycfg_out *o, const char *key, int value)
+{
+	_ycfg_key(o, key);
+	_ycfg_puts(o, value ? "true" : "false");
+}
+
+static void _ycfg_flags(struct ycfg_out *o, struct map_st *map,
+			unsigned char flags, int mode)
+{
+	struct map_st *p;
+
+	for (p = map; p->flag; p++) {
+		if (!p->json_text) {
+			continue;
+		}
+		if (p->mode && (mode & p->mode) == mode) {
+			_ycfg_bool(o, p->json_text, (flags & p->flag) == p->flag);
+		}
+	}
+}
+
+static void _ycfg_export(struct ycfg_out *o, const YKP_CONFIG *cfg)
+{
+	const YK_CONFIG *ycfg = &cfg->ykcore_config;
+	struct ykp_view_st view;
+	int mode;
+	int protection = ykp_get_acccode_type(cfg);
+	struct map_st *p;
+
+	_ykp_config_view(cfg, &view);
+	mode = view.mode;
+
+	_ycfg_open(o, NULL);
+	_ycfg_open(o, "yubiProdConfig");
+
+	for (p = _modes_map; p->flag; p++) {
+		if (p->flag == mode) {
+			_ycfg_string(o, "mode", p->json_text);
+			break;
+		}
+	}
+
+	if (cfg->command == SLOT_CONFIG) {
+		_ycfg_int(o, "targetConfig", 1);
+	} else if (cfg->command == SLOT_CONFIG2) {
+		_ycfg_int(o, "targetConfig", 2);
+	}
+
+	if (protection == YKP_ACCCODE_NONE) {
+		_ycfg_string(o, "protection", "none");
+	} else if (protection == YKP_ACCCODE_RANDOM) {
+		_ycfg_string(o, "protection", "random");
+	} else if (protection == YKP_ACCCODE_SERIAL) {
+		_ycfg_string(o, "protection", "id");
+	}
+
+	_ycfg_open(o, "options");
+
+	if (ycfg->fixedSize != 0 && mode == MODE_OATH_HOTP) {
+		_ycfg_bool(o, "fixedModhex",
+			   (view.oath_id_modhex & VIEW_FIXED_MUI) != 0);
+	}
+
+	if (mode == MODE_OATH_HOTP) {
+		if ((ycfg->cfgFlags & CFGFLAG_OATH_HOTP8) == CFGFLAG_OATH_HOTP8) {
+			_ycfg_int(o, "oathDigits", 8);
+		} else {
+			_ycfg_int(o, "oathDigits", 6);
+		}
+
+		if (view.oath_imf <= 16) {
+			_ycfg_int(o, "fixedSeedvalue", (int)view.oath_imf);
+			_ycfg_bool(o, "randomSeed", 0);
+		} else {
+			_ycfg_bool(o, "randomSeed", 1);
+		}
+	}
+
+	_ycfg_flags(o, _ticket_flags_map, ycfg->tktFlags, mode);
+	_ycfg_flags(o, _config_flags_map, ycfg->cfgFlags, mode);
+	_ycfg_flags(o, _extended_flags_map, ycfg->extFlags, mode);
+
+	_ycfg_close(o);
+
+	if (ycfg->fixedSize != 0 && mode != MODE_STATIC_TICKET) {
+		char prefix[5] = {0};
+
+		if (mode == MODE_OTP_YUBICO &&
+		    ycfg->fixed[0] == 0x00 && ycfg->fixed[1] == 0x00) {
+			_ycfg_string(o, "scope", "yubiCloud");
+		} else {
+			_ycfg_string(o, "scope", "privatePrefix");
+		}
+
+		yubikey_modhex_encode(prefix, (const char *)ycfg->fixed, 2);
+		if (mode == MODE_OATH_HOTP) {
+			if (!(view.oath_id_modhex & VIEW_FIXED_VENDOR)) {
+				yubikey_hex_encode(prefix, (const char *)ycfg->fixed, 2);
+			} else if (!(view.oath_id_modhex & VIEW_FIXED_TYPE)) {
+				yubikey_hex_encode(prefix + 2, (const char *)ycfg->fixed + 1, 1);
+			}
+		}
+		_ycfg_string(o, "prefix", prefix);
+	} else if (mode != MODE_STATIC_TICKET) {
+		_ycfg_string(o, "scope", "noPublicId");
+	}
+
+	_ycfg_close(o);
+	_ycfg_close(o);
+}
+
+int _ykp_json_export_cfg(const YKP_CONFIG *cfg, char *json, size_t len)
+{
+	struct ycfg_out o;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+
+	memset(&o, 0, sizeof(o));
+	o.buf = json;
+	o.len = len;
+	_ycfg_export(&o, cfg);
+	if (len > 0) {
+		json[o.pos] = '\0';
+	}
+	return (int)o.pos;
+}
+
+int _ykp_json_write_cfg(const YKP_CONFIG *cfg,
+			int (*writer)(const char *buf, size_t count,
+				      void *userdata),
+			void *userdata)
+{
+	struct ycfg_out o;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+
+	memset(&o, 0, sizeof(o));
+	o.writer = writer;
+	o.userdata = userdata;
+	_ycfg_export(&o, cfg);
+	_ycfg_flush(&o);
+	if (o.error) {
+		ykp_errno = YKP_EIO;
+		return 0;
+	}
+	return 1;
+}
+
+/* The ycfg import tokenizes the document once, without building a tree.
+ * Member names are looked up in a perfect hash generated from the
+ * json_text column of the flag maps (see build-aux/ycfg-hash.awk), the
+ * values are collected and applied once the whole document has been
+ * read, as the members can come in any order.  Unknown members and
+ * members of the wrong type are skipped, like the json-c import did.
+ */
+
+enum {
+	YCFG_KEY_NONE = 0,
+	YCFG_KEY_TICKET,
+	YCFG_KEY_CONFIG,
+	YCFG_KEY_EXTENDED,
+	YCFG_KEY_YUBIPRODCONFIG,
+	YCFG_KEY_MODE,
+	YCFG_KEY_TARGETCONFIG,
+	YCFG_KEY_OPTIONS,
+	YCFG_KEY_OATHDIGITS,
+	YCFG_KEY_RANDOMSEED,
+	YCFG_KEY_FIXEDSEEDVALUE,
+	/* not in the hash, the document itself */
+	YCFG_KEY_ROOT
+};
+
+struct ycfg_key {
+	const char *name;
+	unsigned char len;
+	unsigned char kind;
+	unsigned char index;
+};
+
+#include "ykpers-ycfg-hash.h"
+
+/* json-c's default nesting limit */
+#define YCFG_MAX_NESTING	32
+#define YCFG_MAX_STRING		64
+
+enum {
+	YCFG_NULL = 1,
+	YCFG_FALSE,
+	YCFG_TRUE,
+	YCFG_NUMBER,
+	YCFG_STRING,
+	YCFG_OBJECT,
+	YCFG_OTHER
+};
+
+struct ycfg_in {
+	const char *p;
+	const char *end;
+
+	int have_yprod;
+	int have_mode;
+	int have_options;
+	int mode;
+	int have_target;
+	int target;
+	int have_digits;
+	int digits;
+	int have_random;
+	int random;
+	int seed;
+	/* options set to true, by kind and index into the flag map */
+	uint32_t flags[YCFG_KEY_EXTENDED + 1];
+};
+
+static unsigned int _ycfg_hash(const char *s, size_t len)
+{
+	uint32_t h = YCFG_HASH_SEED;
+
+	while (len--) {
+		h = (h + (unsigned char)*s++) * 16777619u;
+	}
+	return h >> (32 - YCFG_HASH_BITS);
+}
+
+static const struct ycfg_key *_ycfg_lookup(const char *s, size_t len)
+{
+	const struct ycfg_key *k = &_ycfg_keys[_ycfg_hash(s, len)];
+
+	if (k->name && k->len == len && memcmp(k->name, s, len) == 0) {
+		return k;
+	}
+	return NULL;
+}
+
+static void _ycfg_ws(struct ycfg_in *in)
+{
+	while (in->p < in->end &&
+	       (*in->p == ' ' || *in->p == '\t' || *in->p == '\n' || *in->p == '\r')) {
+		in->p++;
+	}
+}
+
+static int _ycfg_hexval(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/* Read a string, in->p at the opening quote.  Up to YCFG_MAX_STRING bytes
+ * of it are decoded into buf, *len is set to the decoded length or to
+ * YCFG_MAX_STRING + 1 if it didn't fit (or has characters outside ASCII),
+ * which no name or value we look for does.
+ */
+static int _ycfg_read_string(struct ycfg_in *in, char *buf, size_t *len)
+{
+	size_t n = 0;
+
+	in->p++;
+	while (in->p < in->end) {
+		unsigned char c = (unsigned char)*in->p++;
+		int out;
+
+		if (c == '"') {
+			*len = n;
+			return 1;
+		} else if (c < 0x20) {
+			return 0;
+		} else if (c == '\\') {
+			if (in->p >= in->end) {
+				return 0;
+			}
+			c = (unsigned char)*in->p++;
+			switch (c) {
+			case '"': case '\\': case '/':
+				out = c;
+				break;
+			case 'b': out = '\b'; break;
+			case 'f': out = '\f'; break;
+			case 'n': out = '\n'; break;
+			case 'r': out = '\r'; break;
+			case 't': out = '\t'; break;
+			case 'u': {
+				int i;
+				out = 0;
+				if (in->end - in->p < 4) {
+					return 0;
+				}
+				for (i = 0; i < 4; i++) {
+					int v = _ycfg_hexval(in->p[i]);
+					if (v < 0) {
+						return 0;
+					}
+					out = (out << 4) | v;
+				}
+				in->p += 4;
+				if (out >= 0x80) {
+					out = -1;
+				}
+				break;
+			}
+			default:
+				return 0;
+			}
+		} else {
+			out = c < 0x80 ? c : -1;
+		}
+
+		if (n < YCFG_MAX_STRING && out >= 0) {
+			buf[n++] = (char)out;
+		} else {
+			n = YCFG_MAX_STRING + 1;
+		}
+	}
+	return 0;
+}
+
+/* Read a number as json_object_get_int() would see it: the integer part,
+ * scaled by any exponent, clamped to int. */
+static int _ycfg_read_number(struct ycfg_in *in, int *value)
+{
+	const char *start = in->p;
+	double v = 0;
+	int neg = 0;
+	int digits = 0;
+
+	if (in->p < in->end && *in->p == '-') {
+		neg = 1;
+		in->p++;
+	}
+	while (in->p < in->end && *in->p >= '0' && *in->p <= '9') {
+		v = v * 10 + (*in->p++ - '0');
+		digits++;
+	}
+	if (!digits || (digits > 1 && start[neg] == '0')) {
+		return 0;
+	}
+	if (in->p < in->end && *in->p == '.') {
+		double scale = 0.1;
+		in->p++;
+		digits = 0;
+		while (in->p < in->end && *in->p >= '0' && *in->p <= '9') {
+			v += (*in->p++ - '0') * scale;
+			scale /= 10;
+			digits++;
+		}
+		if (!digits) {
+			return 0;
+		}
+	}
+	if (in->p < in->end && (*in->p == 'e' || *in->p == 'E')) {
+		int eneg = 0;
+		int e = 0;
+		in->p++;
+		if (in->p < in->end && (*in->p == '+' || *in->p == '-')) {
+			eneg = *in->p++ == '-';
+		}
+		digits = 0;
+		while (in->p < in->end && *in->p >= '0' && *in->p <= '9') {
+			if (e < 1000) {
+				e = e * 10 + (*in->p - '0');
+			}
+			in->p++;
+			digits++;
+		}
+		if (!digits) {
+			return 0;
+		}
+		while (e-- > 0) {
+			v = eneg ? v / 10 : v * 10;
+		}
+	}
+	if (v > INT_MAX) {
+		v = INT_MAX;
+	}
+	*value = neg ? -(int)v : (int)v;
+	return 1;
+}
+
+static int _ycfg_literal(struct ycfg_in *in, const char *lit, size_t len)
+{
+	if ((size_t)(in->end - in->p) < len || memcmp(in->p, lit, len) != 0) {
+		return 0;
+	}
+	in->p += len;
+	return 1;
+}
+
+static int _ycfg_object(struct ycfg_in *in, int kind, int depth);
+
+/* Read any value.  Objects are handed to _ycfg_object() with kind, the
+ * key they are the value of.  For scalars the type is returned in *type
+ * and numbers in *number, strings in buf and *len.
+ */
+static int _ycfg_value(struct ycfg_in *in, int kind, int depth, int *type,
+		       int *number, char *buf, size_t *len)
+{
+	_ycfg_ws(in);
+	if (in->p >= in->end) {
+		return 0;
+	}
+	*type = YCFG_OTHER;
+	switch (*in->p) {
+	case '{':
+		*type = YCFG_OBJECT;
+		return _ycfg_object(in, kind, depth + 1);
+	case '[':
+		if (depth + 1 > YCFG_MAX_NESTING) {
+			return 0;
+		}
+		in->p++;
+		_ycfg_ws(in);
+		if (in->p < in->end && *in->p == ']') {
+			in->p++;
+			return 1;
+		}
+		for (;;) {
+			int t, v;
+			size_t l;
+			char b[YCFG_MAX_STRING];
+			if (!_ycfg_value(in, YCFG_KEY_NONE, depth + 1, &t, &v, b, &l)) {
+				return 0;
+			}
+			_ycfg_ws(in);
+			if (in->p < in->end && *in->p == ',') {
+				in->p++;
+			} else if (in->p < in->end && *in->p == ']') {
+				in->p++;
+				return 1;
+			} else {
+				return 0;
+			}
+		}
+	case '"':
+		*type = YCFG_STRING;
+		return _ycfg_read_string(in, buf, len);
+	case 't':
+		*type = YCFG_TRUE;
+		return _ycfg_literal(in, "true", 4);
+	case 'f':
+		*type = YCFG_FALSE;
+		return _ycfg_literal(in, "false", 5);
+	case 'n':
+		*type = YCFG_NULL;
+		return _ycfg_literal(in, "null", 4);
+	default:
+		*type = YCFG_NUMBER;
+		return _ycfg_read_number(in, number);
+	}
+}
+
+/* Note what a member of the object kind says, value already read. */
+static void _ycfg_member(struct ycfg_in *in, int kind, const struct ycfg_key *k,
+			 int type, int number, const char *buf, size_t len)
+{
+	struct map_st *p;
+
+	if (kind == YCFG_KEY_YUBIPRODCONFIG) {
+		switch (k->kind) {
+		case YCFG_KEY_MODE:
+			in->have_mode = 1;
+			in->mode = MODE_OTP_YUBICO;
+			if (type != YCFG_STRING) {
+				break;
+			}
+			for (p = _modes_map; p->flag; p++) {
+				if (strlen(p->json_text) == len &&
+				    memcmp(p->json_text, buf, len) == 0) {
+					in->mode = p->flag;
+					break;
+				}
+			}
+			break;
+		case YCFG_KEY_TARGETCONFIG:
+			in->have_target = 1;
+			in->target = type == YCFG_NUMBER ? number : 0;
+			break;
+		}
+	} else if (kind == YCFG_KEY_OPTIONS) {
+		switch (k->kind) {
+		case YCFG_KEY_TICKET:
+		case YCFG_KEY_CONFIG:
+		case YCFG_KEY_EXTENDED:
+			if (type == YCFG_TRUE) {
+				in->flags[k->kind] |= 1u << k->index;
+			} else {
+				in->flags[k->kind] &= ~(1u << k->index);
+			}
+			break;
+		case YCFG_KEY_OATHDIGITS:
+			in->have_digits = 1;
+			in->digits = type == YCFG_NUMBER ? number : 0;
+			break;
+		case YCFG_KEY_RANDOMSEED:
+			in->have_random = 1;
+			in->random = type == YCFG_TRUE ||
+				(type == YCFG_NUMBER && number != 0);
+			break;
+		case YCFG_KEY_FIXEDSEEDVALUE:
+			in->seed = type == YCFG_NUMBER ? number : 0;
+			break;
+		}
+	}
+}
+
+/* Read an object, in->p at the opening brace, kind is the key it is the
+ * value of, YCFG_KEY_ROOT for the document and YCFG_KEY_NONE for objects
+ * we don't look into.
+ */
+static int _ycfg_object(struct ycfg_in *in, int kind, int depth)
+{
+	if (depth > YCFG_MAX_NESTING) {
+		return 0;
+	}
+	in->p++;
+	_ycfg_ws(in);
+	if (in->p < in->end && *in->p == '}') {
+		in->p++;
+		return 1;
+	}
+	for (;;) {
+		char name[YCFG_MAX_STRING];
+		char buf[YCFG_MAX_STRING];
+		size_t name_len, len = 0;
+		const struct ycfg_key *k = NULL;
+		int child = YCFG_KEY_NONE;
+		int type, number = 0;
+
+		_ycfg_ws(in);
+		if (in->p >= in->end || *in->p != '"' ||
+		    !_ycfg_read_string(in, name, &name_len)) {
+			return 0;
+		}
+		if (name_len <= YCFG_MAX_STRING) {
+			k = _ycfg_lookup(name, name_len);
+		}
+		_ycfg_ws(in);
+		if (in->p >= in->end || *in->p != ':') {
+			return 0;
+		}
+		in->p++;
+
+		if (k && kind == YCFG_KEY_ROOT && k->kind == YCFG_KEY_YUBIPRODCONFIG) {
+			child = YCFG_KEY_YUBIPRODCONFIG;
+		} else if (k && kind == YCFG_KEY_YUBIPRODCONFIG && k->kind == YCFG_KEY_OPTIONS) {
+			child = YCFG_KEY_OPTIONS;
+		}
+		if (!_ycfg_value(in, child, depth, &type, &number, buf, &len)) {
+			return 0;
+		}
+		if (type == YCFG_OBJECT && child == YCFG_KEY_YUBIPRODCONFIG) {
+			in->have_yprod = 1;
+		} else if (type == YCFG_OBJECT && child == YCFG_KEY_OPTIONS) {
+			in->have_options = 1;
+		} else if (k) {
+			_ycfg_member(in, kind, k, type, number, buf, len);
+		}
+
+		_ycfg_ws(in);
+		if (in->p < in->end && *in->p == ',') {
+			in->p++;
+		} else if (in->p < in->end && *in->p == '}') {
+			in->p++;
+			return 1;
+		} else {
+			return 0;
+		}
+	}
+}
+
+static void _ycfg_set_flags(const struct ycfg_in *in, YKP_CONFIG *cfg,
+			    struct map_st *map, int kind)
+{
+	struct map_st *p;
+	int i;
+
+	for (p = map, i = 0; p->flag; p++, i++) {
+		if (p->json_text && p->mode && (in->mode & p->mode) == in->mode &&
+		    (in->flags[kind] & (1u << i))) {
+			p->setter(cfg, true);
+		}
+	}
+}
+
+int _ykp_json_import_cfg(YKP_CONFIG *cfg, const char *json, size_t len)
+{
+	struct ycfg_in in;
+	const char *nul;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+
+	memset(&in, 0, sizeof(in));
+	in.p = json;
+	in.end = json + len;
+	nul = memchr(json, '\0', len);
+	if (nul) {
+		in.end = nul;
+	}
+
+	_ycfg_ws(&in);
+	if (in.p >= in.end || *in.p != '{' ||
+	    !_ycfg_object(&in, YCFG_KEY_ROOT, 1)) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	/* like json_tokener_parse(), whatever follows the object is
+	 * ignored */
+	if (!in.have_yprod || !in.have_mode || !in.have_options) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+
+	if (in.have_target) {
+		int command;
+		if (in.target == 1) {
+			command = SLOT_CONFIG;
+		} else if (in.target == 2) {
+			command = SLOT_CONFIG2;
+		} else {
+			ykp_errno = YKP_EINVAL;
+			return 0;
+		}
+		if (ykp_command(cfg) == 0) {
+			ykp_configure_command(cfg, command);
+		} else if (ykp_command(cfg) != command) {
+			ykp_errno = YKP_EINVAL;
+			return 0;
+		}
+	}
+
+	if (in.mode == MODE_OATH_HOTP) {
+		ykp_set_tktflag_OATH_HOTP(cfg, true);
+		if (in.have_digits && in.digits == 8) {
+			ykp_set_cfgflag_OATH_HOTP8(cfg, true);
+		}
+		if (in.have_random) {
+			if (in.random) {
+				/* NOTE: random seed isn't implemented here for now. */
+				ykp_errno = YKP_ENORANDOM;
+				return 0;
+			}
+			ykp_set_oath_imf(cfg, (unsigned long)in.seed);
+		}
+	} else if (in.mode == MODE_CHAL_HMAC) {
+		ykp_set_tktflag_CHAL_RESP(cfg, true);
+		ykp_set_cfgflag_CHAL_HMAC(cfg, true);
+	} else if (in.mode == MODE_CHAL_YUBICO) {
+		ykp_set_tktflag_CHAL_RESP(cfg, true);
+		ykp_set_cfgflag_CHAL_YUBICO(cfg, true);
+	} else if (in.mode == MODE_STATIC_TICKET) {
+		ykp_set_cfgflag_STATIC_TICKET(cfg, true);
+	}
+
+	_ycfg_set_flags(&in, cfg, _ticket_flags_map, YCFG_KEY_TICKET);
+	_ycfg_set_flags(&in, cfg, _config_flags_map, YCFG_KEY_CONFIG);
+	_ycfg_set_flags(&in, cfg, _extended_flags_map, YCFG_KEY_EXTENDED);
+
+	return 1;
+}
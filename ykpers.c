@@ -32,6 +32,8 @@
 #include "ykpbkdf2.h"
 #include "yktsd.h"
 #include "ykpers-json.h"
+#include "sha.h"
+#include "ykbzero.h"
 
 #include <ykpers.h>
 
@@ -108,29 +110,44 @@ static const char *ndef_identifiers[] = {
 	"urn:nfc:"
 };
 
-YKP_CONFIG *ykp_create_config(void)
+size_t ykp_config_sizeof(void)
 {
-	YKP_CONFIG *cfg = malloc(sizeof(YKP_CONFIG));
+	return sizeof(YKP_CONFIG);
+}
+
+YKP_CONFIG *ykp_config_init_default(void *mem)
+{
+	YKP_CONFIG *cfg = ykp_config_init(mem);
 	if (cfg) {
 		memcpy(&cfg->ykcore_config, &default_config1,
 		       sizeof(default_config1));
 		cfg->yk_major_version = 1;
 		cfg->yk_minor_version = 3;
 		cfg->yk_build_version = 0;
+		_ykp_set_capabilities(cfg);
 		cfg->command = SLOT_CONFIG;
-		return cfg;
 	}
-	return 0;
+	return cfg;
 }
 
-YKP_CONFIG *ykp_alloc(void)
+YKP_CONFIG *ykp_config_init(void *mem)
 {
-	YKP_CONFIG *cfg = malloc(sizeof(YKP_CONFIG));
+	YKP_CONFIG *cfg = mem;
 	if(cfg) {
 		memset(cfg, 0, sizeof(YKP_CONFIG));
-		return cfg;
+		_ykp_set_capabilities(cfg);
 	}
-	return 0;
+	return cfg;
+}
+
+YKP_CONFIG *ykp_create_config(void)
+{
+	return ykp_config_init_default(malloc(sizeof(YKP_CONFIG)));
+}
+
+YKP_CONFIG *ykp_alloc(void)
+{
+	return ykp_config_init(malloc(sizeof(YKP_CONFIG)));
 }
 
 int ykp_free_config(YKP_CONFIG *cfg)
@@ -158,6 +175,7 @@ void ykp_configure_version(YKP_CONFIG *cfg, YK_STATUS *st)
 	cfg->yk_major_version = st->versionMajor;
 	cfg->yk_minor_version = st->versionMinor;
 	cfg->yk_build_version = st->versionBuild;
+	_ykp_set_capabilities(cfg);
 }
 
 int ykp_configure_command(YKP_CONFIG *cfg, uint8_t command)
@@ -248,17 +266,12 @@ int ykp_configure_for(YKP_CONFIG *cfg, int confnum, YK_STATUS *st)
  */
 int ykp_get_supported_key_length(const YKP_CONFIG *cfg)
 {
-	/* OATH-HOTP and HMAC-SHA1 challenge response support 20 byte (160 bits)
-	 * keys, holding the last four bytes in the uid field.
-	 */
-	if((ykp_get_tktflag_OATH_HOTP(cfg) &&
-				!ykp_get_cfgflag_CHAL_YUBICO(cfg)) ||
-			(ykp_get_tktflag_CHAL_RESP(cfg) &&
-			 ykp_get_cfgflag_CHAL_HMAC(cfg))) {
-		return 20;
-	}
+	struct ykp_view_st view;
 
-	return 16;
+	if (!cfg)
+		return 16;
+	_ykp_config_view(cfg, &view);
+	return view.key_length;
 }
 
 /* Decode 128 bit AES key into cfg->ykcore_config.key */
@@ -341,6 +354,16 @@ int ykp_HMAC_key_from_hex(YKP_CONFIG *cfg, const char *hexkey) {
  */
 int ykp_AES_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
 				const char *salt)
+{
+	return ykp_key_from_passphrase(cfg, passphrase, salt, NULL, 0);
+}
+
+/* The same with PBKDF2 over prf_method, HMAC-SHA1 if NULL, and
+ * iterations, 1024 if 0. */
+int ykp_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
+			    const char *salt,
+			    const YK_PRF_METHOD *prf_method,
+			    unsigned int iterations)
 {
 	if (cfg) {
 		const char *random_places[] = {
@@ -355,7 +378,8 @@ int ykp_AES_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
 		unsigned char buf[sizeof(cfg->ykcore_config.key) + 4];
 		int rc;
 		int key_bytes = ykp_get_supported_key_length(cfg);
-		YK_PRF_METHOD prf_method = {20, yk_hmac_sha1};
+		YK_PRF_METHOD default_method = {20, yk_hmac_sha1};
+		YK_PRF_CTX *ctx;
 
 		assert (key_bytes <= sizeof(buf));
 
@@ -394,11 +418,20 @@ int ykp_AES_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
 			return 0;
 		}
 
-		rc = yk_pbkdf2(passphrase,
-			       _salt, _salt_len,
-			       1024,
-			       buf, key_bytes,
-			       &prf_method);
+		if (!prf_method)
+			prf_method = &default_method;
+		if (!iterations)
+			iterations = 1024;
+		ctx = yk_prf_init(prf_method, passphrase, strlen(passphrase));
+		if (!ctx) {
+			ykp_errno = YKP_EINVAL;
+			return 0;
+		}
+		rc = yk_pbkdf2_ctx(ctx,
+				   _salt, _salt_len,
+				   iterations,
+				   buf, key_bytes);
+		yk_prf_free(ctx);
 
 		if (rc) {
 			memcpy(cfg->ykcore_config.key, buf, sizeof(cfg->ykcore_config.key));
@@ -414,14 +447,21 @@ int ykp_AES_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
 	return 0;
 }
 
+size_t ykp_ndef_sizeof(void)
+{
+	return sizeof(YK_NDEF);
+}
+
+YK_NDEF *ykp_ndef_init(void *mem)
+{
+	if(mem)
+		memset(mem, 0, sizeof(YK_NDEF));
+	return mem;
+}
+
 YK_NDEF *ykp_alloc_ndef(void)
 {
-	YK_NDEF *ndef = malloc(sizeof(YK_NDEF));
-	if(ndef) {
-		memset(ndef, 0, sizeof(YK_NDEF));
-		return ndef;
-	}
-	return 0;
+	return ykp_ndef_init(malloc(sizeof(YK_NDEF)));
 }
 
 int ykp_free_ndef(YK_NDEF *ndef)
@@ -531,14 +571,21 @@ int ykp_set_ndef_access_code(YK_NDEF *ndef, unsigned char *access_code)
 	return 1;
 }
 
+size_t ykp_device_config_sizeof(void)
+{
+	return sizeof(YK_DEVICE_CONFIG);
+}
+
+YK_DEVICE_CONFIG *ykp_device_config_init(void *mem)
+{
+	if(mem)
+		memset(mem, 0, sizeof(YK_DEVICE_CONFIG));
+	return mem;
+}
+
 YK_DEVICE_CONFIG *ykp_alloc_device_config(void)
 {
-	YK_DEVICE_CONFIG *cfg = malloc(sizeof(YK_DEVICE_CONFIG));
-	if(cfg) {
-		memset(cfg, 0, sizeof(YK_DEVICE_CONFIG));
-		return cfg;
-	}
-	return 0;
+	return ykp_device_config_init(malloc(sizeof(YK_DEVICE_CONFIG)));
 }
 
 int ykp_free_device_config(YK_DEVICE_CONFIG *device_config)
@@ -580,150 +627,105 @@ int ykp_set_device_autoeject_time(YK_DEVICE_CONFIG *device_config, unsigned shor
 	return 0;
 }
 
-static bool vcheck_all(const YKP_CONFIG *cfg)
+static bool _ykp_version_from(const YKP_CONFIG *cfg,
+			      const struct firmware_st *fw)
 {
-	return true;
-}
-static bool vcheck_v1(const YKP_CONFIG *cfg)
-{
-	return cfg->yk_major_version == 1;
-}
-static bool vcheck_no_v1(const YKP_CONFIG *cfg)
-{
-	return cfg->yk_major_version > 1;
-}
-
-static bool vcheck_v21_or_greater(const YKP_CONFIG *cfg)
-{
-	/* the NEO Beta is versioned from 2.1.4 but shouldn't be identified as a 2.1 above key */
-	return (cfg->yk_major_version == 2 && cfg->yk_minor_version > 1) ||
-		(cfg->yk_major_version == 2 && cfg->yk_minor_version == 1 && cfg->yk_build_version <= 3)
-		|| cfg->yk_major_version > 2;
-}
-
-static bool vcheck_v22_or_greater(const YKP_CONFIG *cfg)
-{
-	return (cfg->yk_major_version == 2 &&
-		cfg->yk_minor_version >= 2) ||
-		cfg->yk_major_version > 2;
-}
-
-static bool vcheck_v23_or_greater(const YKP_CONFIG *cfg)
-{
-	return (cfg->yk_major_version == 2 &&
-		cfg->yk_minor_version >= 3) ||
-		cfg->yk_major_version > 2;
-}
-
-static bool vcheck_v24_or_greater(const YKP_CONFIG *cfg)
-{
-	return (cfg->yk_major_version == 2 &&
-		cfg->yk_minor_version >= 4) ||
-		cfg->yk_major_version > 2;
-}
-
-static bool vcheck_v30(const YKP_CONFIG *cfg)
-{
-	return (cfg->yk_major_version == 3 &&
-		cfg->yk_minor_version == 0);
+	if (cfg->yk_major_version != fw->major)
+		return cfg->yk_major_version > fw->major;
+	if (cfg->yk_minor_version != fw->minor)
+		return cfg->yk_minor_version > fw->minor;
+	return cfg->yk_build_version >= fw->build;
 }
 
-static bool vcheck_neo(const YKP_CONFIG *cfg)
+void _ykp_set_capabilities(YKP_CONFIG *cfg)
 {
-	return (cfg->yk_major_version == 2 &&
-			cfg->yk_minor_version == 1 &&
-			cfg->yk_build_version >= 4);
+	const struct firmware_st *fw;
 
-}
-
-static bool vcheck_neo_before_5(const YKP_CONFIG *cfg)
-{
-	return vcheck_neo(cfg) && cfg->yk_build_version < 5;
-}
-
-static bool vcheck_neo_after_6(const YKP_CONFIG *cfg)
-{
-	return vcheck_neo(cfg) && cfg->yk_build_version > 6;
+	for (fw = _firmware_map; fw->capabilities; fw++) {
+		if (_ykp_version_from(cfg, fw))
+			break;
+	}
+	cfg->capabilities = fw->capabilities;
 }
 
 bool capability_has_hidtrig(const YKP_CONFIG *cfg)
 {
-	return vcheck_v1(cfg);
+	return (cfg->capabilities & CAP_HIDTRIG) != 0;
 }
 
 bool capability_has_ticket_first(const YKP_CONFIG *cfg)
 {
-	return vcheck_v1(cfg);
+	return (cfg->capabilities & CAP_TICKET_FIRST) != 0;
 }
 
 bool capability_has_static(const YKP_CONFIG *cfg)
 {
-	return vcheck_all(cfg) && !vcheck_neo_before_5(cfg);
+	return (cfg->capabilities & CAP_STATIC) != 0;
 }
 
 bool capability_has_static_extras(const YKP_CONFIG *cfg)
 {
-	return vcheck_no_v1(cfg) && !vcheck_neo_before_5(cfg);
+	return (cfg->capabilities & CAP_STATIC_EXTRAS) != 0;
 }
 
 bool capability_has_slot_two(const YKP_CONFIG *cfg)
 {
-	return vcheck_no_v1(cfg) && !vcheck_neo(cfg);
+	return (cfg->capabilities & CAP_SLOT_TWO) != 0;
 }
 
 bool capability_has_chal_resp(const YKP_CONFIG *cfg)
 {
-	return vcheck_v22_or_greater(cfg);
+	return (cfg->capabilities & CAP_CHAL_RESP) != 0;
 }
 
 bool capability_has_oath_imf(const YKP_CONFIG *cfg)
 {
-	return vcheck_v22_or_greater(cfg) || vcheck_neo_after_6(cfg);
+	return (cfg->capabilities & CAP_OATH_IMF) != 0;
 }
 
 bool capability_has_serial_api(const YKP_CONFIG *cfg)
 {
-	return vcheck_v22_or_greater(cfg) || vcheck_neo(cfg);
+	return (cfg->capabilities & CAP_SERIAL_API) != 0;
 }
 
 bool capability_has_serial(const YKP_CONFIG *cfg)
 {
-	return vcheck_v22_or_greater(cfg);
+	return (cfg->capabilities & CAP_SERIAL) != 0;
 }
 
 bool capability_has_oath(const YKP_CONFIG *cfg)
 {
-	return vcheck_v21_or_greater(cfg) || vcheck_neo(cfg);
+	return (cfg->capabilities & CAP_OATH) != 0;
 }
 
 bool capability_has_ticket_mods(const YKP_CONFIG *cfg)
 {
-	return vcheck_all(cfg);
+	return (cfg->capabilities & CAP_TICKET_MODS) != 0;
 }
 
 bool capability_has_update(const YKP_CONFIG *cfg)
 {
-	return vcheck_v23_or_greater(cfg);
+	return (cfg->capabilities & CAP_UPDATE) != 0;
 }
 
 bool capability_has_fast(const YKP_CONFIG *cfg)
 {
-	return vcheck_v23_or_greater(cfg);
+	return (cfg->capabilities & CAP_FAST) != 0;
 }
 
 bool capability_has_numeric(const YKP_CONFIG *cfg)
 {
-	return vcheck_v23_or_greater(cfg);
+	return (cfg->capabilities & CAP_NUMERIC) != 0;
 }
 
 bool capability_has_dormant(const YKP_CONFIG *cfg)
 {
-	return vcheck_v23_or_greater(cfg);
+	return (cfg->capabilities & CAP_DORMANT) != 0;
 }
 
 bool capability_has_led_inv(const YKP_CONFIG *cfg)
 {
-	return (vcheck_v24_or_greater(cfg) && !vcheck_v30(cfg));
+	return (cfg->capabilities & CAP_LED_INV) != 0;
 }
 
 int ykp_set_oath_imf(YKP_CONFIG *cfg, unsigned long imf)
@@ -749,25 +751,22 @@ int ykp_set_oath_imf(YKP_CONFIG *cfg, unsigned long imf)
 
 unsigned long ykp_get_oath_imf(const YKP_CONFIG *cfg)
 {
+	struct ykp_view_st view;
+
 	if (!capability_has_oath_imf(cfg)) {
 		return 0;
 	}
 
-	/* we can't do a simple cast due to alignment issues */
-	return ((cfg->ykcore_config.uid[4] << 8)
-		| cfg->ykcore_config.uid[5]) << 4;
+	_ykp_config_view(cfg, &view);
+	return view.oath_imf;
 }
 
-#define def_set_charfield(fnname,fieldname,size,extra,capability)	\
+#define def_set_charfield(fnname,fieldname,size,extra)	\
 int ykp_set_ ## fnname(YKP_CONFIG *cfg, unsigned char *input, size_t len)	\
 {								\
 	if (cfg) {						\
 		size_t max_chars = len;				\
 								\
-		if (!capability(cfg)) {				\
-			ykp_errno = YKP_EYUBIKEYVER;		\
-			return 0;				\
-		}						\
 		if (max_chars > (size))				\
 			max_chars = (size);			\
 								\
@@ -782,15 +781,15 @@ int ykp_set_ ## fnname(YKP_CONFIG *cfg, unsigned char *input, size_t len)	\
 	return 0;						\
 }
 
-def_set_charfield(access_code,accCode,ACC_CODE_SIZE,,vcheck_all)
-def_set_charfield(fixed,fixed,FIXED_SIZE,cfg->ykcore_config.fixedSize = max_chars,vcheck_all)
-def_set_charfield(uid,uid,UID_SIZE,,vcheck_all)
+def_set_charfield(access_code,accCode,ACC_CODE_SIZE,)
+def_set_charfield(fixed,fixed,FIXED_SIZE,cfg->ykcore_config.fixedSize = max_chars)
+def_set_charfield(uid,uid,UID_SIZE,)
 
 #define def_set_tktflag(type,capability)			\
 int ykp_set_tktflag_ ## type(YKP_CONFIG *cfg, bool state)	\
 {								\
 	if (cfg) {						\
-		if (!capability(cfg)) {				\
+		if (!(cfg->capabilities & (capability))) {	\
 			ykp_errno = YKP_EYUBIKEYVER;		\
 			return 0;				\
 		}						\
@@ -820,7 +819,7 @@ bool ykp_get_tktflag_ ## type(const YKP_CONFIG *cfg)		\
 int ykp_set_cfgflag_ ## type(YKP_CONFIG *cfg, bool state)	\
 {								\
 	if (cfg) {						\
-		if (!capability(cfg)) {				\
+		if (!(cfg->capabilities & (capability))) {	\
 			ykp_errno = YKP_EYUBIKEYVER;		\
 			return 0;				\
 		}						\
@@ -849,7 +848,7 @@ bool ykp_get_cfgflag_ ## type(const YKP_CONFIG *cfg)		\
 int ykp_set_extflag_ ## type(YKP_CONFIG *cfg, bool state)	\
 {								\
 	if (cfg) {						\
-		if (!capability(cfg)) {				\
+		if (!(cfg->capabilities & (capability))) {	\
 			ykp_errno = YKP_EYUBIKEYVER;		\
 			return 0;				\
 		}						\
@@ -873,43 +872,43 @@ bool ykp_get_extflag_ ## type(const YKP_CONFIG *cfg)		\
 	return false;						\
 }
 
-def_set_tktflag(TAB_FIRST,capability_has_ticket_mods)
-def_set_tktflag(APPEND_TAB1,capability_has_ticket_mods)
-def_set_tktflag(APPEND_TAB2,capability_has_ticket_mods)
-def_set_tktflag(APPEND_DELAY1,capability_has_ticket_mods)
-def_set_tktflag(APPEND_DELAY2,capability_has_ticket_mods)
-def_set_tktflag(APPEND_CR,capability_has_ticket_mods)
-def_set_tktflag(PROTECT_CFG2,capability_has_slot_two)
-def_set_tktflag(OATH_HOTP,capability_has_oath)
-def_set_tktflag(CHAL_RESP,capability_has_chal_resp)
-
-def_set_cfgflag(SEND_REF,capability_has_ticket_mods)
-def_set_cfgflag(TICKET_FIRST,capability_has_ticket_first)
-def_set_cfgflag(PACING_10MS,capability_has_ticket_mods)
-def_set_cfgflag(PACING_20MS,capability_has_ticket_mods)
-def_set_cfgflag(ALLOW_HIDTRIG,capability_has_hidtrig)
-def_set_cfgflag(STATIC_TICKET,capability_has_static)
-def_set_cfgflag(SHORT_TICKET,capability_has_static_extras)
-def_set_cfgflag(STRONG_PW1,capability_has_static_extras)
-def_set_cfgflag(STRONG_PW2,capability_has_static_extras)
-def_set_cfgflag(MAN_UPDATE,capability_has_static_extras)
-def_set_cfgflag(OATH_HOTP8,capability_has_oath)
-def_set_cfgflag(OATH_FIXED_MODHEX1,capability_has_oath)
-def_set_cfgflag(OATH_FIXED_MODHEX2,capability_has_oath)
-def_set_cfgflag(OATH_FIXED_MODHEX,capability_has_oath)
-def_set_cfgflag(CHAL_YUBICO,capability_has_chal_resp)
-def_set_cfgflag(CHAL_HMAC,capability_has_chal_resp)
-def_set_cfgflag(HMAC_LT64,capability_has_chal_resp)
-def_set_cfgflag(CHAL_BTN_TRIG,capability_has_chal_resp)
-
-def_set_extflag(SERIAL_BTN_VISIBLE,capability_has_serial)
-def_set_extflag(SERIAL_USB_VISIBLE,capability_has_serial)
-def_set_extflag(SERIAL_API_VISIBLE,capability_has_serial_api)
-def_set_extflag(USE_NUMERIC_KEYPAD,capability_has_numeric)
-def_set_extflag(FAST_TRIG,capability_has_fast)
-def_set_extflag(ALLOW_UPDATE,capability_has_update)
-def_set_extflag(DORMANT,capability_has_dormant)
-def_set_extflag(LED_INV,capability_has_led_inv)
+def_set_tktflag(TAB_FIRST,CAP_TICKET_MODS)
+def_set_tktflag(APPEND_TAB1,CAP_TICKET_MODS)
+def_set_tktflag(APPEND_TAB2,CAP_TICKET_MODS)
+def_set_tktflag(APPEND_DELAY1,CAP_TICKET_MODS)
+def_set_tktflag(APPEND_DELAY2,CAP_TICKET_MODS)
+def_set_tktflag(APPEND_CR,CAP_TICKET_MODS)
+def_set_tktflag(PROTECT_CFG2,CAP_SLOT_TWO)
+def_set_tktflag(OATH_HOTP,CAP_OATH)
+def_set_tktflag(CHAL_RESP,CAP_CHAL_RESP)
+
+def_set_cfgflag(SEND_REF,CAP_TICKET_MODS)
+def_set_cfgflag(TICKET_FIRST,CAP_TICKET_FIRST)
+def_set_cfgflag(PACING_10MS,CAP_TICKET_MODS)
+def_set_cfgflag(PACING_20MS,CAP_TICKET_MODS)
+def_set_cfgflag(ALLOW_HIDTRIG,CAP_HIDTRIG)
+def_set_cfgflag(STATIC_TICKET,CAP_STATIC)
+def_set_cfgflag(SHORT_TICKET,CAP_STATIC_EXTRAS)
+def_set_cfgflag(STRONG_PW1,CAP_STATIC_EXTRAS)
+def_set_cfgflag(STRONG_PW2,CAP_STATIC_EXTRAS)
+def_set_cfgflag(MAN_UPDATE,CAP_STATIC_EXTRAS)
+def_set_cfgflag(OATH_HOTP8,CAP_OATH)
+def_set_cfgflag(OATH_FIXED_MODHEX1,CAP_OATH)
+def_set_cfgflag(OATH_FIXED_MODHEX2,CAP_OATH)
+def_set_cfgflag(OATH_FIXED_MODHEX,CAP_OATH)
+def_set_cfgflag(CHAL_YUBICO,CAP_CHAL_RESP)
+def_set_cfgflag(CHAL_HMAC,CAP_CHAL_RESP)
+def_set_cfgflag(HMAC_LT64,CAP_CHAL_RESP)
+def_set_cfgflag(CHAL_BTN_TRIG,CAP_CHAL_RESP)
+
+def_set_extflag(SERIAL_BTN_VISIBLE,CAP_SERIAL)
+def_set_extflag(SERIAL_USB_VISIBLE,CAP_SERIAL)
+def_set_extflag(SERIAL_API_VISIBLE,CAP_SERIAL_API)
+def_set_extflag(USE_NUMERIC_KEYPAD,CAP_NUMERIC)
+def_set_extflag(FAST_TRIG,CAP_FAST)
+def_set_extflag(ALLOW_UPDATE,CAP_UPDATE)
+def_set_extflag(DORMANT,CAP_DORMANT)
+def_set_extflag(LED_INV,CAP_LED_INV)
 
 static const char str_key_value_separator[] = ": ";
 static const char str_hex_prefix[] = "h:";
@@ -928,177 +927,417 @@ static const char str_config_flags[] = "config_flags";
 static const char str_extended_flags[] = "extended_flags";
 
 
-static int _ykp_legacy_export_config(const YKP_CONFIG *cfg, char *buf, size_t len) {
-	if (cfg) {
-		char buffer[256];
-		struct map_st *p;
-		unsigned char t_flags;
-		bool key_bits_in_uid = false;
-		YK_CONFIG ycfg = cfg->ykcore_config;
-		int mode = MODE_OTP_YUBICO;
-
-		int pos = 0;
-		int written;
-
-		if((ycfg.tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP){
-			if((ycfg.cfgFlags & CFGFLAG_CHAL_HMAC) == CFGFLAG_CHAL_HMAC) {
-				mode = MODE_CHAL_HMAC;
-			} else if((ycfg.cfgFlags & CFGFLAG_CHAL_YUBICO) == CFGFLAG_CHAL_YUBICO) {
-				mode = MODE_CHAL_YUBICO;
-			} else {
-				mode = MODE_OATH_HOTP;
-			}
+static const char str_na[] = "n/a";
+static const char hex_map[] = "0123456789abcdef";
+static const char modhex_map[] = "cbdefghijklnrtuv";
+
+/* Where _ykp_legacy_export_config() writes to, everything goes straight
+ * into buf.  full is set, and nothing more written, once something
+ * doesn't fit with room left for the terminating NUL.
+ */
+struct legacy_out {
+	char *buf;
+	size_t len;
+	size_t pos;
+	bool full;
+};
+
+static void _ykp_legacy_put(struct legacy_out *o, const char *s, size_t n)
+{
+	if (o->full || n >= o->len - o->pos) {
+		o->full = true;
+		return;
+	}
+	memcpy(o->buf + o->pos, s, n);
+	o->pos += n;
+}
+
+static void _ykp_legacy_puts(struct legacy_out *o, const char *s)
+{
+	_ykp_legacy_put(o, s, strlen(s));
+}
+
+static void _ykp_legacy_key(struct legacy_out *o, const char *key,
+			    const char *prefix)
+{
+	_ykp_legacy_puts(o, key);
+	_ykp_legacy_put(o, str_key_value_separator,
+			sizeof(str_key_value_separator) - 1);
+	if (prefix) {
+		_ykp_legacy_put(o, prefix, 2);
+	}
+}
+
+/* Encode len bytes with map, hex_map or modhex_map. */
+static void _ykp_legacy_encode(struct legacy_out *o, const unsigned char *src,
+			       size_t len, const char *map)
+{
+	size_t i;
+
+	if (o->full || 2 * len >= o->len - o->pos) {
+		o->full = true;
+		return;
+	}
+	for (i = 0; i < len; i++) {
+		o->buf[o->pos++] = map[src[i] >> 4];
+		o->buf[o->pos++] = map[src[i] & 0xf];
+	}
+}
+
+/* Write the names of the flags set in flags that the mode and firmware
+ * have, "|" separated.  With once, a bit is only named once, for config
+ * flags that share a value in different modes. */
+static void _ykp_legacy_flags(struct legacy_out *o, const char *key,
+			      const struct map_st *map, unsigned char flags,
+			      int mode, unsigned int caps, bool once)
+{
+	const struct map_st *p;
+	bool first = true;
+
+	_ykp_legacy_key(o, key, NULL);
+	for (p = map; p->flag; p++) {
+		if ((flags & p->flag) != p->flag ||
+		    !(caps & p->capability) || (mode & p->mode) != mode) {
+			continue;
+		}
+		if (!first) {
+			_ykp_legacy_put(o, str_flags_separator, 1);
 		}
-		else if((ycfg.cfgFlags & CFGFLAG_STATIC_TICKET) == CFGFLAG_STATIC_TICKET) {
-			mode = MODE_STATIC_TICKET;
+		_ykp_legacy_puts(o, p->flag_text);
+		first = false;
+		if (once) {
+			flags -= p->flag;
 		}
+	}
+	_ykp_legacy_put(o, "\n", 1);
+}
+
+static int _ykp_legacy_export_config(const YKP_CONFIG *cfg, char *buf, size_t len) {
+	if (cfg) {
+		struct legacy_out o = { buf, len, 0, len == 0 };
+		const YK_CONFIG *ycfg = &cfg->ykcore_config;
+		struct ykp_view_st view;
+		int mode;
+		unsigned int caps = cfg->capabilities;
+		bool key_bits_in_uid;
+
+		_ykp_config_view(cfg, &view);
+		mode = view.mode;
 
 		/* for OATH-HOTP and HMAC-SHA1 challenge response, there is four bytes
 		 *  additional key data in the uid field
 		 */
-		key_bits_in_uid = (ykp_get_supported_key_length(cfg) == 20);
+		key_bits_in_uid = (view.key_length == 20);
 
 		/* fixed: or OATH id: */
-		if ((ycfg.tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP &&
-		    ycfg.fixedSize) {
+		if ((ycfg->tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP &&
+		    ycfg->fixedSize) {
+			int modhex = view.oath_id_modhex;
+
+			_ykp_legacy_key(&o, str_oath_id, NULL);
 			/* First byte (vendor id) */
-			if ((ycfg.cfgFlags & CFGFLAG_OATH_FIXED_MODHEX1) == CFGFLAG_OATH_FIXED_MODHEX1 ||
-			    (ycfg.cfgFlags & CFGFLAG_OATH_FIXED_MODHEX2) == CFGFLAG_OATH_FIXED_MODHEX2 ||
-			    (ycfg.cfgFlags & CFGFLAG_OATH_FIXED_MODHEX) == CFGFLAG_OATH_FIXED_MODHEX) {
-				yubikey_modhex_encode(buffer, (const char *)ycfg.fixed, 1);
-			} else {
-				yubikey_hex_encode(buffer, (const char *)ycfg.fixed, 1);
-			}
+			_ykp_legacy_encode(&o, ycfg->fixed, 1,
+					   (modhex & VIEW_FIXED_VENDOR) ? modhex_map : hex_map);
 			/* Second byte (token type) */
-			if ((ycfg.cfgFlags & CFGFLAG_OATH_FIXED_MODHEX2) == CFGFLAG_OATH_FIXED_MODHEX2 ||
-			    (ycfg.cfgFlags & CFGFLAG_OATH_FIXED_MODHEX) == CFGFLAG_OATH_FIXED_MODHEX) {
-				yubikey_modhex_encode(buffer + 2, (const char *)ycfg.fixed + 1, 1);
-			} else {
-				yubikey_hex_encode(buffer + 2, (const char *)ycfg.fixed + 1, 1);
-			}
-			/* bytes 3-12 - MUI */
-			if ((ycfg.cfgFlags & CFGFLAG_OATH_FIXED_MODHEX) == CFGFLAG_OATH_FIXED_MODHEX) {
-				yubikey_modhex_encode(buffer + 4, (const char *)ycfg.fixed + 2, 8);
-			} else {
-				yubikey_hex_encode(buffer + 4, (const char *)ycfg.fixed + 2, 8);
-			}
-			buffer[12] = 0;
-			written = snprintf(buf, len - (size_t)pos, "%s%s%s\n", str_oath_id, str_key_value_separator, buffer);
-			if (written < 0 || pos + written > len) {
-				return -1;
-			}
-			pos += written;
+			_ykp_legacy_encode(&o, ycfg->fixed + 1, 1,
+					   (modhex & VIEW_FIXED_TYPE) ? modhex_map : hex_map);
+			/* bytes 3-6, the MUI */
+			_ykp_legacy_encode(&o, ycfg->fixed + 2, 4,
+					   (modhex & VIEW_FIXED_MUI) ? modhex_map : hex_map);
 		} else {
-			yubikey_modhex_encode(buffer, (const char *)ycfg.fixed, ycfg.fixedSize);
-			written = snprintf(buf, len - (size_t)pos, "%s%s%s%s\n", str_fixed, str_key_value_separator, str_modhex_prefix, buffer);
-			if (written < 0 || pos + written > len) {
-				return -1;
-			}
-			pos += written;
+			_ykp_legacy_key(&o, str_fixed, str_modhex_prefix);
+			_ykp_legacy_encode(&o, ycfg->fixed,
+					   ycfg->fixedSize < FIXED_SIZE ? ycfg->fixedSize : FIXED_SIZE,
+					   modhex_map);
 		}
+		_ykp_legacy_put(&o, "\n", 1);
 
 		/* uid: */
+		_ykp_legacy_key(&o, str_uid, NULL);
 		if (key_bits_in_uid) {
-			strncpy(buffer, "n/a", 4);
+			_ykp_legacy_put(&o, str_na, sizeof(str_na) - 1);
 		} else {
-			yubikey_hex_encode(buffer, (const char *)ycfg.uid, UID_SIZE);
-		}
-		written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s\n", str_uid, str_key_value_separator, buffer);
-		if (written < 0 || pos + written > len) {
-			return -1;
+			_ykp_legacy_encode(&o, ycfg->uid, UID_SIZE, hex_map);
 		}
-		pos += written;
+		_ykp_legacy_put(&o, "\n", 1);
 
 		/* key: */
-		yubikey_hex_encode(buffer, (const char *)ycfg.key, KEY_SIZE);
+		_ykp_legacy_key(&o, str_key, str_hex_prefix);
+		_ykp_legacy_encode(&o, ycfg->key, KEY_SIZE, hex_map);
 		if (key_bits_in_uid) {
-			yubikey_hex_encode(buffer + KEY_SIZE * 2, (const char *)ycfg.uid, 4);
-		}
-		written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s%s\n", str_key, str_key_value_separator, str_hex_prefix, buffer);
-		if (written < 0 || pos + written > len) {
-			return -1;
+			_ykp_legacy_encode(&o, ycfg->uid, 4, hex_map);
 		}
-		pos += written;
+		_ykp_legacy_put(&o, "\n", 1);
 
 		/* acc_code: */
-		yubikey_hex_encode(buffer, (const char*)ycfg.accCode, ACC_CODE_SIZE);
-		written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s%s\n", str_acc_code, str_key_value_separator, str_hex_prefix, buffer);
-		if (written < 0 || pos + written > len) {
+		_ykp_legacy_key(&o, str_acc_code, str_hex_prefix);
+		_ykp_legacy_encode(&o, ycfg->accCode, ACC_CODE_SIZE, hex_map);
+		_ykp_legacy_put(&o, "\n", 1);
+
+		/* OATH IMF: */
+		if ((ycfg->tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP &&
+		    (caps & CAP_OATH_IMF)) {
+			char imf[24];
+			int n = snprintf(imf, sizeof(imf), "%lx\n", view.oath_imf);
+
+			_ykp_legacy_key(&o, str_oath_imf, str_hex_prefix);
+			_ykp_legacy_put(&o, imf, (size_t)n);
+		}
+
+		_ykp_legacy_flags(&o, str_ticket_flags, _ticket_flags_map,
+				  ycfg->tktFlags, mode, caps, false);
+		/* make sure we don't show more than one cfgFlag per value -
+		   some cfgflags share value in different contexts
+		*/
+		_ykp_legacy_flags(&o, str_config_flags, _config_flags_map,
+				  ycfg->cfgFlags, mode, caps, true);
+		_ykp_legacy_flags(&o, str_extended_flags, _extended_flags_map,
+				  ycfg->extFlags, mode, caps, false);
+
+		if (o.full) {
 			return -1;
 		}
-		pos += written;
+		buf[o.pos] = '\0';
+		return (int)o.pos;
+	}
+	return 0;
+}
 
-		/* OATH IMF: */
-		if ((ycfg.tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP &&
-		    capability_has_oath_imf(cfg)) {
-			written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s%lx\n", str_oath_imf, str_key_value_separator, str_hex_prefix, ykp_get_oath_imf(cfg));
-			if (written < 0 || pos + written > len) {
-				return -1;
-			}
-			pos += written;
+static bool _ykp_legacy_is(const char *s, size_t len, const char *str)
+{
+	return strncmp(s, str, len) == 0 && str[len] == '\0';
+}
+
+/* Decode len hex or modhex characters (depending on map) from src into
+ * dst.  src need not be NUL terminated.
+ */
+static int _ykp_legacy_decode(unsigned char *dst, const char *src, size_t len,
+			      const char *map)
+{
+	size_t i;
+
+	if (len % 2) {
+		return 0;
+	}
+	for (i = 0; i < len; i += 2) {
+		const char *hi = memchr(map, tolower((unsigned char)src[i]), 16);
+		const char *lo = memchr(map, tolower((unsigned char)src[i + 1]), 16);
+		if (!hi || !lo) {
+			return 0;
 		}
+		dst[i / 2] = (unsigned char)(((hi - map) << 4) | (lo - map));
+	}
+	return 1;
+}
 
-		/* ticket_flags: */
-		buffer[0] = '\0';
-		for (p = _ticket_flags_map; p->flag; p++) {
-			if ((ycfg.tktFlags & p->flag) == p->flag
-			    && p->capability(cfg)
-			    && (mode & p->mode) == mode) {
-				if (*buffer) {
-					strncat(buffer, str_flags_separator, 256 - strlen(buffer));
-				}
-				strncat(buffer, p->flag_text, 256 - strlen(buffer));
+/* Strip the "h:" or "m:" prefix off a value, fail if it isn't there. */
+static int _ykp_legacy_prefix(const char **val, size_t *len, const char *prefix)
+{
+	if (*len < 2 || memcmp(*val, prefix, 2) != 0) {
+		return 0;
+	}
+	*val += 2;
+	*len -= 2;
+	return 1;
+}
+
+/* Set the flags in a "|" separated list of flag names from map. */
+static int _ykp_legacy_set_flags(YKP_CONFIG *cfg, struct map_st *map,
+				 const char *val, size_t len)
+{
+	while (len) {
+		const char *sep = memchr(val, str_flags_separator[0], len);
+		size_t n = sep ? (size_t)(sep - val) : len;
+		struct map_st *p;
+
+		for (p = map; p->flag; p++) {
+			if (_ykp_legacy_is(val, n, p->flag_text)) {
+				break;
 			}
 		}
-		written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s\n", str_ticket_flags, str_key_value_separator, buffer);
-		if (written < 0 || pos + written > len) {
-			return -1;
+		if (!p->flag) {
+			ykp_errno = YKP_EINVAL;
+			return 0;
 		}
-		pos += written;
-
-		/* config_flags: */
-		buffer[0] = '\0';
-		t_flags = ycfg.cfgFlags;
-		for (p = _config_flags_map; p->flag; p++) {
-			if ((t_flags & p->flag) == p->flag
-			    && p->capability(cfg)
-			    && (mode & p->mode) == mode) {
-				if (*buffer) {
-					strncat(buffer, str_flags_separator, 256 - strlen(buffer));
-				}
-				strncat(buffer, p->flag_text, 256 - strlen(buffer));
-				/* make sure we don't show more than one cfgFlag per value -
-				   some cfgflags share value in different contexts
-				*/
-				t_flags -= p->flag;
-			}
+		if (!p->setter(cfg, true)) {
+			return 0;
 		}
-		written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s\n", str_config_flags, str_key_value_separator, buffer);
-		if (written < 0 || pos + written > len) {
-			return -1;
+		if (!sep) {
+			break;
+		}
+		val = sep + 1;
+		len -= n + 1;
+	}
+	return 1;
+}
+
+/* Parse what _ykp_legacy_export_config() writes, in a single pass over buf
+ * and without allocating.  The configuration is replaced by the one in buf,
+ * flags are set through their setters so cfg must have the version of the
+ * key configured for the flags to be accepted.
+ */
+static int _ykp_legacy_import_config(YKP_CONFIG *cfg, const char *buf, size_t len)
+{
+	YK_CONFIG *ycfg;
+	const char *end;
+	const char *oath_id = NULL;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	ycfg = &cfg->ykcore_config;
+	memset(ycfg, 0, sizeof(YK_CONFIG));
+
+	end = memchr(buf, '\0', len);
+	if (!end) {
+		end = buf + len;
+	}
+
+	while (buf < end) {
+		const char *eol = memchr(buf, '\n', (size_t)(end - buf));
+		const char *next = eol ? eol + 1 : end;
+		const char *sep;
+		const char *val;
+		size_t name_len, val_len;
+
+		if (!eol) {
+			eol = end;
 		}
-		pos += written;
-
-		/* extended_flags: */
-		buffer[0] = '\0';
-		for (p = _extended_flags_map; p->flag; p++) {
-			if ((ycfg.extFlags & p->flag) == p->flag
-			    && p->capability(cfg)
-			    && (mode & p->mode) == mode) {
-				if (*buffer) {
-					strncat(buffer, str_flags_separator, 256 - strlen(buffer));
+		if (eol > buf && eol[-1] == '\r') {
+			eol--;
+		}
+		if (eol == buf) {
+			buf = next;
+			continue;
+		}
+
+		sep = memchr(buf, str_key_value_separator[0], (size_t)(eol - buf));
+		if (!sep || sep + 1 >= eol || sep[1] != str_key_value_separator[1]) {
+			goto invalid;
+		}
+		name_len = (size_t)(sep - buf);
+		val = sep + 2;
+		val_len = (size_t)(eol - val);
+
+		if (_ykp_legacy_is(buf, name_len, str_fixed)) {
+			if (!_ykp_legacy_prefix(&val, &val_len, str_modhex_prefix) ||
+			    val_len > FIXED_SIZE * 2 ||
+			    !_ykp_legacy_decode(ycfg->fixed, val, val_len, modhex_map)) {
+				goto invalid;
+			}
+			ycfg->fixedSize = (unsigned char)(val_len / 2);
+		} else if (_ykp_legacy_is(buf, name_len, str_oath_id)) {
+			/* the encoding of each part depends on the
+			 * config_flags, decode when we have them */
+			if (val_len != 12) {
+				goto invalid;
+			}
+			oath_id = val;
+		} else if (_ykp_legacy_is(buf, name_len, str_uid)) {
+			if (!_ykp_legacy_is(val, val_len, str_na) &&
+			    (val_len != UID_SIZE * 2 ||
+			     !_ykp_legacy_decode(ycfg->uid, val, val_len, hex_map))) {
+				goto invalid;
+			}
+		} else if (_ykp_legacy_is(buf, name_len, str_key)) {
+			if (!_ykp_legacy_prefix(&val, &val_len, str_hex_prefix)) {
+				goto invalid;
+			}
+			if (val_len == KEY_SIZE * 2) {
+				if (!_ykp_legacy_decode(ycfg->key, val, val_len, hex_map)) {
+					goto invalid;
 				}
-				strncat(buffer, p->flag_text, 256 - strlen(buffer));
+			} else if (val_len == (KEY_SIZE + 4) * 2) {
+				/* the last four bytes of a 20 byte key are in the uid */
+				if (!_ykp_legacy_decode(ycfg->key, val, KEY_SIZE * 2, hex_map) ||
+				    !_ykp_legacy_decode(ycfg->uid, val + KEY_SIZE * 2, 8, hex_map)) {
+					goto invalid;
+				}
+			} else {
+				goto invalid;
 			}
+		} else if (_ykp_legacy_is(buf, name_len, str_acc_code)) {
+			if (!_ykp_legacy_prefix(&val, &val_len, str_hex_prefix) ||
+			    val_len != ACC_CODE_SIZE * 2 ||
+			    !_ykp_legacy_decode(ycfg->accCode, val, val_len, hex_map)) {
+				goto invalid;
+			}
+		} else if (_ykp_legacy_is(buf, name_len, str_oath_imf)) {
+			unsigned long imf = 0;
+			size_t i;
+
+			if (!_ykp_legacy_prefix(&val, &val_len, str_hex_prefix) ||
+			    val_len == 0 || val_len > 8) {
+				goto invalid;
+			}
+			for (i = 0; i < val_len; i++) {
+				const char *c = memchr(hex_map, tolower((unsigned char)val[i]), 16);
+				if (!c) {
+					goto invalid;
+				}
+				imf = (imf << 4) | (unsigned long)(c - hex_map);
+			}
+			if (!ykp_set_oath_imf(cfg, imf)) {
+				return 0;
+			}
+		} else if (_ykp_legacy_is(buf, name_len, str_ticket_flags)) {
+			if (!_ykp_legacy_set_flags(cfg, _ticket_flags_map, val, val_len)) {
+				return 0;
+			}
+		} else if (_ykp_legacy_is(buf, name_len, str_config_flags)) {
+			if (!_ykp_legacy_set_flags(cfg, _config_flags_map, val, val_len)) {
+				return 0;
+			}
+		} else if (_ykp_legacy_is(buf, name_len, str_extended_flags)) {
+			if (!_ykp_legacy_set_flags(cfg, _extended_flags_map, val, val_len)) {
+				return 0;
+			}
+		} else {
+			goto invalid;
 		}
-		written = snprintf(buf + pos, len - (size_t)pos, "%s%s%s\n", str_extended_flags, str_key_value_separator, buffer);
-		if (written < 0 || pos + written > len) {
-			return -1;
-		}
-		pos += written;
 
-		return pos;
+		buf = next;
 	}
+
+	if (oath_id) {
+		const char *map;
+
+		/* same choice of encoding per part as in the export */
+		if ((ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX1) == CFGFLAG_OATH_FIXED_MODHEX1 ||
+		    (ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX2) == CFGFLAG_OATH_FIXED_MODHEX2 ||
+		    (ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX) == CFGFLAG_OATH_FIXED_MODHEX) {
+			map = modhex_map;
+		} else {
+			map = hex_map;
+		}
+		if (!_ykp_legacy_decode(ycfg->fixed, oath_id, 2, map)) {
+			goto invalid;
+		}
+		if ((ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX2) == CFGFLAG_OATH_FIXED_MODHEX2 ||
+		    (ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX) == CFGFLAG_OATH_FIXED_MODHEX) {
+			map = modhex_map;
+		} else {
+			map = hex_map;
+		}
+		if (!_ykp_legacy_decode(ycfg->fixed + 1, oath_id + 2, 2, map)) {
+			goto invalid;
+		}
+		if ((ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX) == CFGFLAG_OATH_FIXED_MODHEX) {
+			map = modhex_map;
+		} else {
+			map = hex_map;
+		}
+		if (!_ykp_legacy_decode(ycfg->fixed + 2, oath_id + 4, 8, map)) {
+			goto invalid;
+		}
+		ycfg->fixedSize = 6;
+	}
+
+	return 1;
+
+invalid:
+	ykp_errno = YKP_EINVAL;
 	return 0;
 }
 
@@ -1119,7 +1358,7 @@ int ykp_import_config(YKP_CONFIG *cfg, const char *buf, size_t len,
 	if(format == YKP_FORMAT_YCFG) {
 		return _ykp_json_import_cfg(cfg, buf, len);
 	} else if(format == YKP_FORMAT_LEGACY) {
-		ykp_errno = YKP_ENOTYETIMPL;
+		return _ykp_legacy_import_config(cfg, buf, len);
 	} else {
 		ykp_errno = YKP_EINVAL;
 	}
@@ -1142,12 +1381,67 @@ int ykp_write_config(const YKP_CONFIG *cfg,
 	return 0;
 }
 
+/* Like ykp_export_config() but hands the output to writer, which returns
+ * the number of bytes it wrote.  YKP_FORMAT_YCFG is streamed out without
+ * being put together in memory first.
+ */
+int ykp_write_config_format(const YKP_CONFIG *cfg, int format,
+			    int (*writer)(const char *buf, size_t count,
+					  void *userdata),
+			    void *userdata)
+{
+	if(!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	if(format == YKP_FORMAT_YCFG) {
+		return _ykp_json_write_cfg(cfg, writer, userdata);
+	} else if(format == YKP_FORMAT_LEGACY) {
+		char buffer[1024];
+		int ret = _ykp_legacy_export_config(cfg, buffer, sizeof(buffer));
+		if(ret <= 0) {
+			ykp_errno = YKP_EINVAL;
+			return 0;
+		}
+		if(writer(buffer, (size_t)ret, userdata) != ret) {
+			ykp_errno = YKP_EIO;
+			return 0;
+		}
+		return 1;
+	}
+	ykp_errno = YKP_EINVAL;
+	return 0;
+}
+
 int ykp_read_config(YKP_CONFIG *cfg,
 		    int (*reader)(char *buf, size_t count,
 				  void *userdata),
 		    void *userdata)
 {
-	ykp_errno = YKP_ENOTYETIMPL;
+	if(cfg) {
+		char buffer[1024];
+		size_t pos = 0;
+		int ret;
+
+		while((ret = reader(buffer + pos, sizeof(buffer) - pos, userdata)) > 0) {
+			pos += (size_t)ret;
+			if(pos >= sizeof(buffer)) {
+				/* larger than anything ykp_write_config() writes */
+				insecure_memzero(buffer, sizeof(buffer));
+				ykp_errno = YKP_EINVAL;
+				return 0;
+			}
+		}
+		if(ret < 0) {
+			insecure_memzero(buffer, sizeof(buffer));
+			ykp_errno = YKP_EIO;
+			return 0;
+		}
+		ret = _ykp_legacy_import_config(cfg, buffer, pos);
+		insecure_memzero(buffer, sizeof(buffer));
+		return ret;
+	}
+	ykp_errno = YKP_ENOCFG;
 	return 0;
 }
 
@@ -1190,6 +1484,265 @@ unsigned int ykp_get_acccode_type(const YKP_CONFIG *cfg)
 	return cfg->ykp_acccode_type;
 }
 
+/* Work out the cheapest write that turns the configuration current,
+ * which is what the key holds, into target.  If only flags within the
+ * update masks (and possibly the access code) differ, and the key
+ * allows updates, that is a SLOT_UPDATE1/SLOT_UPDATE2 which leaves the
+ * secrets alone, otherwise it is a full SLOT_CONFIG/SLOT_CONFIG2.
+ *
+ * plan gets the configuration to write with ykp_core_config(plan) and
+ * ykp_command(plan), and acc_code (ACC_CODE_SIZE bytes) the access code
+ * the write has to be done with, that of current.
+ */
+int ykp_plan_update(const YKP_CONFIG *current, const YKP_CONFIG *target,
+		    YKP_CONFIG *plan, unsigned char *acc_code)
+{
+	YK_CONFIG cur_cfg, tgt_cfg;
+	const YK_CONFIG *cur = &cur_cfg;
+	const YK_CONFIG *tgt = &tgt_cfg;
+	int confnum;
+	int ret;
+
+	if (!current || !target || !plan || !acc_code) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	if ((current->command == SLOT_CONFIG || current->command == SLOT_UPDATE1) &&
+	    (target->command == SLOT_CONFIG || target->command == SLOT_UPDATE1)) {
+		confnum = 1;
+	} else if ((current->command == SLOT_CONFIG2 || current->command == SLOT_UPDATE2) &&
+		   (target->command == SLOT_CONFIG2 || target->command == SLOT_UPDATE2)) {
+		confnum = 2;
+	} else {
+		ykp_errno = YKP_EINVCONFNUM;
+		return 0;
+	}
+
+	/* plan may be current or target, work from copies of both. */
+	memcpy(&cur_cfg, &current->ykcore_config, sizeof(YK_CONFIG));
+	memcpy(&tgt_cfg, &target->ykcore_config, sizeof(YK_CONFIG));
+	memcpy(acc_code, cur->accCode, ACC_CODE_SIZE);
+	if (plan != target)
+		memcpy(plan, target, sizeof(YKP_CONFIG));
+
+	if (memcmp(cur, tgt, offsetof(YK_CONFIG, crc)) == 0) {
+		plan->command = confnum == 1 ? SLOT_CONFIG : SLOT_CONFIG2;
+		ret = YKP_PLAN_NONE;
+		goto out;
+	}
+
+	if (capability_has_update(target) &&
+	    (cur->extFlags & EXTFLAG_ALLOW_UPDATE) &&
+	    memcmp(cur->fixed, tgt->fixed, FIXED_SIZE) == 0 &&
+	    memcmp(cur->uid, tgt->uid, UID_SIZE) == 0 &&
+	    memcmp(cur->key, tgt->key, KEY_SIZE) == 0 &&
+	    cur->fixedSize == tgt->fixedSize &&
+	    memcmp(cur->rfu, tgt->rfu, sizeof(cur->rfu)) == 0 &&
+	    ((cur->tktFlags ^ tgt->tktFlags) & ~TKTFLAG_UPDATE_MASK) == 0 &&
+	    ((cur->cfgFlags ^ tgt->cfgFlags) & ~CFGFLAG_UPDATE_MASK) == 0 &&
+	    ((cur->extFlags ^ tgt->extFlags) & ~EXTFLAG_UPDATE_MASK) == 0) {
+		YK_CONFIG *ycfg = &plan->ykcore_config;
+
+		/* An update only carries the updatable flags, the key keeps
+		 * the rest and the secrets. */
+		memset(ycfg, 0, sizeof(YK_CONFIG));
+		memcpy(ycfg->accCode, tgt->accCode, ACC_CODE_SIZE);
+		ycfg->tktFlags = tgt->tktFlags & TKTFLAG_UPDATE_MASK;
+		ycfg->cfgFlags = tgt->cfgFlags & CFGFLAG_UPDATE_MASK;
+		ycfg->extFlags = tgt->extFlags & EXTFLAG_UPDATE_MASK;
+		plan->command = confnum == 1 ? SLOT_UPDATE1 : SLOT_UPDATE2;
+		ret = YKP_PLAN_UPDATE;
+		goto out;
+	}
+
+	plan->command = confnum == 1 ? SLOT_CONFIG : SLOT_CONFIG2;
+	ret = YKP_PLAN_CONFIG;
+out:
+	insecure_memzero(&cur_cfg, sizeof(cur_cfg));
+	insecure_memzero(&tgt_cfg, sizeof(tgt_cfg));
+	return ret;
+}
+
+/* The flags of map that may be set in mode on firmware with caps. */
+static unsigned char _ykp_allowed_flags(const struct map_st *map, int mode,
+					unsigned int caps)
+{
+	const struct map_st *p;
+	unsigned char allowed = 0;
+
+	for (p = map; p->flag; p++) {
+		if ((caps & p->capability) && (mode & p->mode) == mode)
+			allowed |= p->flag;
+	}
+	return allowed;
+}
+
+static bool _ykp_all_zero(const unsigned char *buf, size_t len)
+{
+	unsigned char acc = 0;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		acc |= buf[i];
+	return acc == 0;
+}
+
+/* Check all of a slot configuration against its command, mode and
+ * firmware, collecting every problem found rather than stopping at the
+ * first, for checking configurations before they are written.
+ */
+int ykp_validate_config(const YKP_CONFIG *cfg, unsigned int *report)
+{
+	const YK_CONFIG *ycfg;
+	unsigned int caps;
+	unsigned int r = 0;
+	bool update;
+	int key_len;
+	int mode;
+
+	if (report)
+		*report = 0;
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	ycfg = &cfg->ykcore_config;
+	caps = cfg->capabilities;
+	mode = _ykp_config_mode(cfg);
+	update = cfg->command == SLOT_UPDATE1 || cfg->command == SLOT_UPDATE2;
+
+	switch (cfg->command) {
+	case SLOT_CONFIG:
+		break;
+	case SLOT_CONFIG2:
+		if (!(caps & CAP_SLOT_TWO))
+			r |= YKP_VALIDATE_COMMAND;
+		break;
+	case SLOT_UPDATE1:
+	case SLOT_UPDATE2:
+		if (!(caps & CAP_UPDATE))
+			r |= YKP_VALIDATE_COMMAND;
+		break;
+	default:
+		r |= YKP_VALIDATE_COMMAND;
+	}
+
+	if ((mode == MODE_OATH_HOTP && !(caps & CAP_OATH)) ||
+	    ((mode & (MODE_CHAL_RESP)) && !(caps & CAP_CHAL_RESP)) ||
+	    (mode == MODE_STATIC_TICKET && !(caps & CAP_STATIC)))
+		r |= YKP_VALIDATE_MODE;
+
+	if (ycfg->tktFlags & ~_ykp_allowed_flags(_ticket_flags_map, mode, caps))
+		r |= YKP_VALIDATE_TKTFLAGS;
+	if (ycfg->cfgFlags & ~_ykp_allowed_flags(_config_flags_map, mode, caps))
+		r |= YKP_VALIDATE_CFGFLAGS;
+	if (ycfg->extFlags & ~_ykp_allowed_flags(_extended_flags_map, mode, caps))
+		r |= YKP_VALIDATE_EXTFLAGS;
+
+	if (update) {
+		if ((ycfg->tktFlags & ~TKTFLAG_UPDATE_MASK) ||
+		    (ycfg->cfgFlags & ~CFGFLAG_UPDATE_MASK) ||
+		    (ycfg->extFlags & ~EXTFLAG_UPDATE_MASK))
+			r |= YKP_VALIDATE_UPDATE;
+	} else {
+		/* an update leaves the fixed part, uid and key alone */
+		if (ycfg->fixedSize > FIXED_SIZE)
+			r |= YKP_VALIDATE_FIXED;
+		/* the packed key has no length of its own, so check that
+		 * one of the supported length is set; past KEY_SIZE bytes
+		 * an HMAC key goes on in the uid */
+		key_len = ykp_get_supported_key_length(cfg);
+		if (_ykp_all_zero(ycfg->key, KEY_SIZE) &&
+		    (key_len <= KEY_SIZE ||
+		     _ykp_all_zero(ycfg->uid, key_len - KEY_SIZE)))
+			r |= YKP_VALIDATE_KEY;
+		/* the moving factor is kept as IMF / 16 in uid[4..5] */
+		if (mode == MODE_OATH_HOTP && !(caps & CAP_OATH_IMF) &&
+		    (ycfg->uid[4] || ycfg->uid[5]))
+			r |= YKP_VALIDATE_OATH_IMF;
+	}
+
+	switch (cfg->ykp_acccode_type) {
+	case 0:
+		break;
+	case YKP_ACCCODE_NONE:
+		if (!_ykp_all_zero(ycfg->accCode, ACC_CODE_SIZE))
+			r |= YKP_VALIDATE_ACC_CODE;
+		break;
+	case YKP_ACCCODE_RANDOM:
+	case YKP_ACCCODE_SERIAL:
+		if (_ykp_all_zero(ycfg->accCode, ACC_CODE_SIZE))
+			r |= YKP_VALIDATE_ACC_CODE;
+		break;
+	default:
+		r |= YKP_VALIDATE_ACC_CODE;
+	}
+
+	if (report)
+		*report = r;
+	if (r) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	return 1;
+}
+
+/* The fingerprint is a SHA-1 over a fixed serialisation of the command
+ * and the configuration fields, so that it does not depend on struct
+ * layout or on the crc.  Unless YKP_FINGERPRINT_SECRETS is given the
+ * key, private uid and access code are left out (the OATH moving factor
+ * in uid[4..5] is kept, it is not secret). */
+#define FINGERPRINT_FORMAT	0x01
+
+int ykp_config_fingerprint(const YKP_CONFIG *cfg, int flags,
+			   unsigned char *fp, size_t len)
+{
+	const YK_CONFIG *ycfg;
+	unsigned char buf[2 + FIXED_SIZE + UID_SIZE + KEY_SIZE + ACC_CODE_SIZE + 6];
+	unsigned char *p = buf;
+	SHA1Context ctx;
+
+	if (!cfg) {
+		ykp_errno = YKP_ENOCFG;
+		return 0;
+	}
+	if (len < YKP_FINGERPRINT_SIZE) {
+		ykp_errno = YKP_EINVAL;
+		return 0;
+	}
+	ycfg = &cfg->ykcore_config;
+
+	memset(buf, 0, sizeof(buf));
+	*p++ = FINGERPRINT_FORMAT;
+	*p++ = cfg->command;
+	memcpy(p, ycfg->fixed, FIXED_SIZE);
+	p += FIXED_SIZE;
+	if (flags & YKP_FINGERPRINT_SECRETS) {
+		memcpy(p, ycfg->uid, UID_SIZE);
+	} else if ((ycfg->tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP) {
+		memcpy(p + 4, ycfg->uid + 4, UID_SIZE - 4);
+	}
+	p += UID_SIZE;
+	if (flags & YKP_FINGERPRINT_SECRETS) {
+		memcpy(p, ycfg->key, KEY_SIZE);
+		memcpy(p + KEY_SIZE, ycfg->accCode, ACC_CODE_SIZE);
+	}
+	p += KEY_SIZE + ACC_CODE_SIZE;
+	*p++ = ycfg->fixedSize;
+	*p++ = ycfg->extFlags;
+	*p++ = ycfg->tktFlags;
+	*p++ = ycfg->cfgFlags;
+	*p++ = ycfg->rfu[0];
+	*p++ = ycfg->rfu[1];
+
+	SHA1Reset(&ctx);
+	SHA1Input(&ctx, buf, sizeof(buf));
+	SHA1Result(&ctx, fp);
+
+	insecure_memzero(buf, sizeof(buf));
+	return 1;
+}
+
 int * _ykp_errno_location(void)
 {
 	static int tsd_init = 0;
@@ -1228,6 +1781,7 @@ static const char *errtext[] = {
 	"invalid configuration number (this is a programming error)",
 	"invalid option/argument value",
 	"no randomness source available",
+	"input/output error",
 };
 const char *ykp_strerror(int errnum)
 {
@@ -35,6 +35,7 @@
 #include <stdbool.h>
 #include <ykstatus.h>
 #include <ykdef.h>
+#include <ykpbkdf2.h>
 
 # ifdef __cplusplus
 extern "C" {
@@ -51,6 +52,13 @@ int ykp_free_config(YKP_CONFIG *cfg);
    version information. */
 YKP_CONFIG *ykp_alloc(void);
 
+/* The same in storage of the caller, of at least ykp_config_sizeof()
+   bytes aligned as by malloc().  These are not to be passed to
+   ykp_free_config(), the memory stays the caller's. */
+size_t ykp_config_sizeof(void);
+YKP_CONFIG *ykp_config_init(void *mem);		/* as ykp_alloc() */
+YKP_CONFIG *ykp_config_init_default(void *mem);	/* as ykp_create_config() */
+
 /* Set the version information in st in cfg. */
 void ykp_configure_version(YKP_CONFIG *cfg, YK_STATUS *st);
 
@@ -65,12 +73,20 @@ int ykp_AES_key_from_hex(YKP_CONFIG *cfg, const char *hexkey);
 int ykp_AES_key_from_raw(YKP_CONFIG *cfg, const char *key);
 int ykp_AES_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
 				const char *salt);
+/* With a PBKDF2 PRF other than yk_hmac_sha1 and an iteration count other
+   than 1024, see yk_pbkdf2_calibrate(); NULL and 0 for those. */
+int ykp_key_from_passphrase(YKP_CONFIG *cfg, const char *passphrase,
+			    const char *salt,
+			    const YK_PRF_METHOD *prf_method,
+			    unsigned int iterations);
 int ykp_HMAC_key_from_hex(YKP_CONFIG *cfg, const char *hexkey);
 int ykp_HMAC_key_from_raw(YKP_CONFIG *cfg, const char *key);
 
 /* Functions for constructing the YK_NDEF struct before writing it to a neo */
 YK_NDEF *ykp_alloc_ndef(void);
 int ykp_free_ndef(YK_NDEF *ndef);
+size_t ykp_ndef_sizeof(void);
+YK_NDEF *ykp_ndef_init(void *mem);
 int ykp_construct_ndef_uri(YK_NDEF *ndef, const char *uri);
 int ykp_construct_ndef_text(YK_NDEF *ndef, const char *text, const char *lang, bool isutf16);
 int ykp_set_ndef_access_code(YK_NDEF *ndef, unsigned char *access_code);
@@ -78,6 +94,8 @@ int ykp_ndef_as_text(YK_NDEF *ndef, char *text, size_t len);
 
 YK_DEVICE_CONFIG *ykp_alloc_device_config(void);
 int ykp_free_device_config(YK_DEVICE_CONFIG *device_config);
+size_t ykp_device_config_sizeof(void);
+YK_DEVICE_CONFIG *ykp_device_config_init(void *mem);
 int ykp_set_device_mode(YK_DEVICE_CONFIG *device_config, unsigned char mode);
 int ykp_set_device_chalresp_timeout(YK_DEVICE_CONFIG *device_config, unsigned char timeout);
 int ykp_set_device_autoeject_time(YK_DEVICE_CONFIG *device_config, unsigned short eject_time);
@@ -170,6 +188,10 @@ int ykp_write_config(const YKP_CONFIG *cfg,
 		     int (*writer)(const char *buf, size_t count,
 				   void *userdata),
 		     void *userdata);
+int ykp_write_config_format(const YKP_CONFIG *cfg, int format,
+			    int (*writer)(const char *buf, size_t count,
+					  void *userdata),
+			    void *userdata);
 int ykp_read_config(YKP_CONFIG *cfg,
 		    int (*reader)(char *buf, size_t count,
 				  void *userdata),
@@ -185,6 +207,29 @@ int ykp_import_config(YKP_CONFIG *cfg, const char *buf, size_t len, int format);
 #define YKP_FORMAT_LEGACY	0x01
 #define YKP_FORMAT_YCFG		0x02
 
+/* Streaming export of configurations, secrets included, in formats that
+   validation servers import.  Call ykp_export_server_config() once per
+   configuration between begin and end.  The writer returns the number
+   of bytes it wrote. */
+int ykp_export_server_begin(int format,
+			    int (*writer)(const char *buf, size_t count,
+					  void *userdata),
+			    void *userdata);
+int ykp_export_server_config(int format, const YKP_CONFIG *cfg,
+			     unsigned int serial,
+			     int (*writer)(const char *buf, size_t count,
+					   void *userdata),
+			     void *userdata);
+int ykp_export_server_end(int format,
+			  int (*writer)(const char *buf, size_t count,
+					void *userdata),
+			  void *userdata);
+
+/* yubikey-ksm CSV, Yubico OTP configurations only */
+#define YKP_FORMAT_KSM		0x03
+/* RFC 6030 PSKC, OATH-HOTP and HMAC-SHA1 challenge-response only */
+#define YKP_FORMAT_PSKC		0x04
+
 void ykp_set_acccode_type(YKP_CONFIG *cfg, unsigned int type);
 unsigned int ykp_get_acccode_type(const YKP_CONFIG *cfg);
 
@@ -194,6 +239,128 @@ unsigned int ykp_get_acccode_type(const YKP_CONFIG *cfg);
 
 int ykp_get_supported_key_length(const YKP_CONFIG *cfg);
 
+/* Plan the cheapest write from the configuration current in a slot to
+   target, a SLOT_UPDATE if only updatable flags change.  The write is
+   left in plan, to be done with the access code put in acc_code,
+   which must not be NULL.  plan may be current or target.  Returns
+   one of YKP_PLAN_*, 0 on error. */
+int ykp_plan_update(const YKP_CONFIG *current, const YKP_CONFIG *target,
+		    YKP_CONFIG *plan, unsigned char *acc_code);
+
+#define YKP_PLAN_NONE		0x01	/* nothing to write */
+#define YKP_PLAN_UPDATE		0x02	/* SLOT_UPDATE1 / SLOT_UPDATE2 */
+#define YKP_PLAN_CONFIG		0x03	/* SLOT_CONFIG / SLOT_CONFIG2 */
+
+/* Check a slot configuration (SLOT_CONFIG, SLOT_CONFIG2 or an update)
+   against its firmware version.  Returns 1 if it is fine, otherwise 0
+   and, if report is given, YKP_VALIDATE_* bits for everything wrong. */
+int ykp_validate_config(const YKP_CONFIG *cfg, unsigned int *report);
+
+#define YKP_VALIDATE_COMMAND	0x0001	/* not a slot write the key can do */
+#define YKP_VALIDATE_MODE	0x0002	/* mode not supported by the key */
+#define YKP_VALIDATE_TKTFLAGS	0x0004	/* ticket flag not for mode or key */
+#define YKP_VALIDATE_CFGFLAGS	0x0008	/* config flag not for mode or key */
+#define YKP_VALIDATE_EXTFLAGS	0x0010	/* extended flag not for the key */
+#define YKP_VALIDATE_UPDATE	0x0020	/* flag an update can't change */
+#define YKP_VALIDATE_FIXED	0x0040	/* fixed part too long */
+#define YKP_VALIDATE_KEY	0x0080	/* no key of the supported length */
+#define YKP_VALIDATE_OATH_IMF	0x0100	/* OATH IMF the key can't take */
+#define YKP_VALIDATE_ACC_CODE	0x0200	/* access code and its type differ */
+
+/* Stable fingerprint of a configuration, YKP_FINGERPRINT_SIZE bytes.
+   Secrets (key, uid and access code) are only covered if
+   YKP_FINGERPRINT_SECRETS is given. */
+int ykp_config_fingerprint(const YKP_CONFIG *cfg, int flags,
+			   unsigned char *fp, size_t len);
+
+#define YKP_FINGERPRINT_SIZE	20
+#define YKP_FINGERPRINT_SECRETS	0x01
+
+/* Provisioning journal, recording by serial number what was written to
+   which slot, secrets included, so that an interrupted batch run can be
+   resumed.  Records are appended and an incomplete record left by a
+   crash is dropped when the journal is opened. */
+typedef struct ykp_journal_t YKP_JOURNAL;
+
+YKP_JOURNAL *ykp_journal_open(const char *filename);
+int ykp_journal_close(YKP_JOURNAL *journal);
+/* Sync the journal to disk every records records, 0 to only sync on
+   ykp_journal_sync() and ykp_journal_close().  The default is 1. */
+int ykp_journal_set_sync_interval(YKP_JOURNAL *journal, unsigned int records);
+int ykp_journal_sync(YKP_JOURNAL *journal);
+/* Record cfg as written to the key with serial, st is the status read
+   back from the key after the write. */
+int ykp_journal_record(YKP_JOURNAL *journal, unsigned int serial,
+		       const YKP_CONFIG *cfg, const YK_STATUS *st);
+size_t ykp_journal_count(const YKP_JOURNAL *journal);
+/* Read back record index, oldest first, into cfg. */
+int ykp_journal_get(const YKP_JOURNAL *journal, size_t index,
+		    unsigned int *serial, YKP_CONFIG *cfg);
+/* True if the journal says the key with serial already holds cfg and the
+   key has not been reprogrammed since. */
+bool ykp_journal_is_current(const YKP_JOURNAL *journal, unsigned int serial,
+			    const YKP_CONFIG *cfg, const YK_STATUS *st,
+			    int flags);
+
+/* A bundle of YKP_FORMAT_YCFG configurations in one file, either one
+   JSON object after the other or the elements of a JSON array.  The
+   file is mapped and a configuration is only parsed when fetched. */
+typedef struct ykp_bundle_t YKP_BUNDLE;
+
+YKP_BUNDLE *ykp_bundle_open(const char *filename);
+int ykp_bundle_close(YKP_BUNDLE *bundle);
+/* Number of configurations, up to the first thing that isn't one. */
+size_t ykp_bundle_count(YKP_BUNDLE *bundle);
+/* Import configuration index, counting from 0, into cfg. */
+int ykp_bundle_get(YKP_BUNDLE *bundle, size_t index, YKP_CONFIG *cfg);
+
+/* Fixed size binary record of a configuration, the YK_CONFIG together
+   with the firmware version, command, access code type and a serial
+   number, for keeping the configurations of many keys. */
+#define YKP_RECORD_SIZE		64
+
+int ykp_export_record(const YKP_CONFIG *cfg, unsigned int serial,
+		      unsigned char *rec, size_t len);
+int ykp_import_record(YKP_CONFIG *cfg, unsigned int *serial,
+		      const unsigned char *rec, size_t len);
+
+/* Append only file of records, record index is at index *
+   YKP_RECORD_SIZE.  Reads go through a mapping of the file. */
+typedef struct ykp_record_file_t YKP_RECORD_FILE;
+
+YKP_RECORD_FILE *ykp_record_file_open(const char *filename);
+int ykp_record_file_close(YKP_RECORD_FILE *file);
+int ykp_record_file_sync(YKP_RECORD_FILE *file);
+int ykp_record_file_append(YKP_RECORD_FILE *file, const YKP_CONFIG *cfg,
+			   unsigned int serial);
+size_t ykp_record_file_count(const YKP_RECORD_FILE *file);
+int ykp_record_file_get(YKP_RECORD_FILE *file, size_t index,
+			unsigned int *serial, YKP_CONFIG *cfg);
+
+/* OATH-HOTP (RFC 4226) and TOTP (RFC 6238) codes of 6 to 8 digits,
+   from the HMAC-SHA1 secret of a slot.  Windows of counters
+   are computed together, several at a time in SIMD lanes. */
+/* Dynamic truncation of a 20 byte HMAC-SHA1 into code. */
+int ykp_oath_truncate(const unsigned char *hmac, int digits,
+		      unsigned int *code);
+/* The codes of counters counter to counter + count - 1. */
+int ykp_oath_hotp_codes(const unsigned char *secret, size_t secret_len,
+			uint64_t counter, size_t count, int digits,
+			unsigned int *codes);
+/* Look for code among counters counter to counter + window - 1,
+   returning 1 with the first match in *matched, or 0 with ykp_errno
+   0 if there is none. */
+int ykp_oath_hotp_validate(const unsigned char *secret, size_t secret_len,
+			   uint64_t counter, size_t window, int digits,
+			   unsigned int code, uint64_t *matched);
+/* Look for code among the time steps up to drift steps either side of
+   the one of now, nearest first, returning 1 with the step offset in
+   *offset, or 0 with ykp_errno 0 if there is none. */
+int ykp_oath_totp_validate(const unsigned char *secret, size_t secret_len,
+			   uint64_t now, unsigned int step,
+			   unsigned int drift, int digits,
+			   unsigned int code, int *offset);
+
 extern int * _ykp_errno_location(void);
 #define ykp_errno (*_ykp_errno_location())
 const char *ykp_strerror(int errnum);
@@ -205,6 +372,7 @@ const char *ykp_strerror(int errnum);
 #define YKP_EINVCONFNUM	0x05
 #define YKP_EINVAL	0x06
 #define YKP_ENORANDOM	0x07
+#define YKP_EIO		0x08
 
 # ifdef __cplusplus
 }
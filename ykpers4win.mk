@@ -27,7 +27,6 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 LIBYUBIKEYVERSION=1.13
-LIBJSONVERSION=0.11
 PROJECT=yubikey-personalization
 PACKAGE=ykpers
 
@@ -46,14 +45,6 @@ usage:
 ykpers4win:
 	rm -rf tmp && mkdir tmp && cd tmp && \
 	mkdir -p root/licenses && \
-	cp ../json-c-$(LIBJSONVERSION) . \
-		||	wget --no-check-certificate https://s3.amazonaws.com/json-c_releases/releases/json-c-$(LIBJSONVERSION).tar.gz && \
-	tar xfa json-c-$(LIBJSONVERSION).tar.gz && \
-	cd json-c-$(LIBJSONVERSION) && \
-	CFLAGS="-Wno-error" ac_cv_func_realloc_0_nonnull=yes ac_cv_func_malloc_0_nonnull=yes ./configure --host=$(HOST) --build=x86_64-unknown-linux-gnu --prefix=$(PWD)/tmp/root && \
-	make install && \
-	cp COPYING $(PWD)/tmp/root/licenses/json-c.txt && \
-	cd .. && \
 	cp ../libyubikey-$(LIBYUBIKEYVERSION).tar.gz . \
 		||	wget https://developers.yubico.com/yubico-c/releases/libyubikey-$(LIBYUBIKEYVERSION).tar.gz && \
 	tar xfa libyubikey-$(LIBYUBIKEYVERSION).tar.gz && \
@@ -30,50 +30,57 @@
 
 #include "ykpers_lcl.h"
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
 struct map_st _ticket_flags_map[] = {
-	{ TKTFLAG_TAB_FIRST,	"TAB_FIRST",	"tabFirst",	capability_has_ticket_mods,	MODE_OUTPUT,	ykp_set_tktflag_TAB_FIRST },
-	{ TKTFLAG_APPEND_TAB1,	"APPEND_TAB1",	"tabBetween",	capability_has_ticket_mods,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_TAB1 },
-	{ TKTFLAG_APPEND_TAB2,	"APPEND_TAB2",	"tabLast",	capability_has_ticket_mods,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_TAB2 },
-	{ TKTFLAG_APPEND_DELAY1,"APPEND_DELAY1","appendDelay1",	capability_has_ticket_mods,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_DELAY1 },
-	{ TKTFLAG_APPEND_DELAY2,"APPEND_DELAY2","appendDelay2",	capability_has_ticket_mods,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_DELAY2 },
-	{ TKTFLAG_APPEND_CR,	"APPEND_CR",	"appendCR",	capability_has_ticket_mods,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_CR },
-	{ TKTFLAG_PROTECT_CFG2,	"PROTECT_CFG2",	"protectSecond",capability_has_slot_two,	MODE_ALL,	ykp_set_tktflag_PROTECT_CFG2 },
-	{ TKTFLAG_OATH_HOTP,	"OATH_HOTP",	0,		capability_has_oath,		MODE_OATH_HOTP,	ykp_set_tktflag_OATH_HOTP },
-	{ TKTFLAG_CHAL_RESP,	"CHAL_RESP",	0,		capability_has_chal_resp,	MODE_CHAL_RESP, ykp_set_tktflag_CHAL_RESP },
+	{ TKTFLAG_TAB_FIRST,	"TAB_FIRST",	"tabFirst",	CAP_TICKET_MODS,	MODE_OUTPUT,	ykp_set_tktflag_TAB_FIRST },
+	{ TKTFLAG_APPEND_TAB1,	"APPEND_TAB1",	"tabBetween",	CAP_TICKET_MODS,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_TAB1 },
+	{ TKTFLAG_APPEND_TAB2,	"APPEND_TAB2",	"tabLast",	CAP_TICKET_MODS,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_TAB2 },
+	{ TKTFLAG_APPEND_DELAY1,"APPEND_DELAY1","appendDelay1",	CAP_TICKET_MODS,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_DELAY1 },
+	{ TKTFLAG_APPEND_DELAY2,"APPEND_DELAY2","appendDelay2",	CAP_TICKET_MODS,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_DELAY2 },
+	{ TKTFLAG_APPEND_CR,	"APPEND_CR",	"appendCR",	CAP_TICKET_MODS,	MODE_OUTPUT,	ykp_set_tktflag_APPEND_CR },
+	{ TKTFLAG_PROTECT_CFG2,	"PROTECT_CFG2",	"protectSecond",CAP_SLOT_TWO,		MODE_ALL,	ykp_set_tktflag_PROTECT_CFG2 },
+	{ TKTFLAG_OATH_HOTP,	"OATH_HOTP",	0,		CAP_OATH,		MODE_OATH_HOTP,	ykp_set_tktflag_OATH_HOTP },
+	{ TKTFLAG_CHAL_RESP,	"CHAL_RESP",	0,		CAP_CHAL_RESP,		MODE_CHAL_RESP, ykp_set_tktflag_CHAL_RESP },
 	{ 0, 0, 0, 0, 0, 0 }
 };
 
 struct map_st _config_flags_map[] = {
-	{ CFGFLAG_CHAL_YUBICO,		"CHAL_YUBICO",		0,		capability_has_chal_resp,	MODE_CHAL_YUBICO,	ykp_set_cfgflag_CHAL_YUBICO },
-	{ CFGFLAG_CHAL_HMAC,		"CHAL_HMAC",		0,		capability_has_chal_resp,	MODE_CHAL_HMAC,		ykp_set_cfgflag_CHAL_HMAC },
-	{ CFGFLAG_HMAC_LT64,		"HMAC_LT64",		"hmacLt64",	capability_has_chal_resp,	MODE_CHAL_HMAC,		ykp_set_cfgflag_HMAC_LT64 },
-	{ CFGFLAG_CHAL_BTN_TRIG,	"CHAL_BTN_TRIG",	"buttonReqd",	capability_has_chal_resp,	MODE_CHAL_RESP,		ykp_set_cfgflag_CHAL_BTN_TRIG },
-	{ CFGFLAG_OATH_HOTP8,		"OATH_HOTP8",		0,		capability_has_oath,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_HOTP8 },
-	{ CFGFLAG_OATH_FIXED_MODHEX1,	"OATH_FIXED_MODHEX1",	0,		capability_has_oath,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_FIXED_MODHEX1 },
-	{ CFGFLAG_OATH_FIXED_MODHEX2,	"OATH_FIXED_MODHEX2",	0,		capability_has_oath,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_FIXED_MODHEX2 },
-	{ CFGFLAG_OATH_FIXED_MODHEX,	"OATH_FIXED_MODHEX",	0,		capability_has_oath,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_FIXED_MODHEX },
-	{ CFGFLAG_SEND_REF,		"SEND_REF",		"sendRef",	capability_has_ticket_mods,	MODE_OUTPUT,		ykp_set_cfgflag_SEND_REF },
-	{ CFGFLAG_TICKET_FIRST,		"TICKET_FIRST",		0,		capability_has_ticket_first,	MODE_OUTPUT,		ykp_set_cfgflag_TICKET_FIRST },
-	{ CFGFLAG_PACING_10MS,		"PACING_10MS",		"pacing10ms",	capability_has_ticket_mods,	MODE_OUTPUT,		ykp_set_cfgflag_PACING_10MS },
-	{ CFGFLAG_PACING_20MS,		"PACING_20MS",		"pacing20ms",	capability_has_ticket_mods,	MODE_OUTPUT,		ykp_set_cfgflag_PACING_20MS },
-	{ CFGFLAG_ALLOW_HIDTRIG,	"ALLOW_HIDTRIG",	0,		capability_has_hidtrig,		MODE_OUTPUT,		ykp_set_cfgflag_ALLOW_HIDTRIG },
-	{ CFGFLAG_STATIC_TICKET,        "STATIC_TICKET",        "staticTicket", capability_has_static,		MODE_STATIC_TICKET,     ykp_set_cfgflag_STATIC_TICKET },
-	{ CFGFLAG_SHORT_TICKET,		"SHORT_TICKET",		"shortTicket",	capability_has_static_extras,	MODE_OUTPUT,		ykp_set_cfgflag_SHORT_TICKET },
-	{ CFGFLAG_STRONG_PW1,		"STRONG_PW1",		"strongPw1",	capability_has_static_extras,	MODE_STATIC_TICKET,	ykp_set_cfgflag_STRONG_PW1 },
-	{ CFGFLAG_STRONG_PW2,		"STRONG_PW2",		"strongPw2",	capability_has_static_extras,	MODE_STATIC_TICKET,	ykp_set_cfgflag_STRONG_PW2 },
-	{ CFGFLAG_MAN_UPDATE,		"MAN_UPDATE",		"manUpdate",	capability_has_static_extras,	MODE_STATIC_TICKET,	ykp_set_cfgflag_MAN_UPDATE },
+	{ CFGFLAG_CHAL_YUBICO,		"CHAL_YUBICO",		0,		CAP_CHAL_RESP,		MODE_CHAL_YUBICO,	ykp_set_cfgflag_CHAL_YUBICO },
+	{ CFGFLAG_CHAL_HMAC,		"CHAL_HMAC",		0,		CAP_CHAL_RESP,		MODE_CHAL_HMAC,		ykp_set_cfgflag_CHAL_HMAC },
+	{ CFGFLAG_HMAC_LT64,		"HMAC_LT64",		"hmacLt64",	CAP_CHAL_RESP,		MODE_CHAL_HMAC,		ykp_set_cfgflag_HMAC_LT64 },
+	{ CFGFLAG_CHAL_BTN_TRIG,	"CHAL_BTN_TRIG",	"buttonReqd",	CAP_CHAL_RESP,		MODE_CHAL_RESP,		ykp_set_cfgflag_CHAL_BTN_TRIG },
+	{ CFGFLAG_OATH_HOTP8,		"OATH_HOTP8",		0,		CAP_OATH,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_HOTP8 },
+	{ CFGFLAG_OATH_FIXED_MODHEX1,	"OATH_FIXED_MODHEX1",	0,		CAP_OATH,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_FIXED_MODHEX1 },
+	{ CFGFLAG_OATH_FIXED_MODHEX2,	"OATH_FIXED_MODHEX2",	0,		CAP_OATH,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_FIXED_MODHEX2 },
+	{ CFGFLAG_OATH_FIXED_MODHEX,	"OATH_FIXED_MODHEX",	0,		CAP_OATH,		MODE_OATH_HOTP,		ykp_set_cfgflag_OATH_FIXED_MODHEX },
+	{ CFGFLAG_SEND_REF,		"SEND_REF",		"sendRef",	CAP_TICKET_MODS,	MODE_OUTPUT,		ykp_set_cfgflag_SEND_REF },
+	{ CFGFLAG_TICKET_FIRST,		"TICKET_FIRST",		0,		CAP_TICKET_FIRST,	MODE_OUTPUT,		ykp_set_cfgflag_TICKET_FIRST },
+	{ CFGFLAG_PACING_10MS,		"PACING_10MS",		"pacing10ms",	CAP_TICKET_MODS,	MODE_OUTPUT,		ykp_set_cfgflag_PACING_10MS },
+	{ CFGFLAG_PACING_20MS,		"PACING_20MS",		"pacing20ms",	CAP_TICKET_MODS,	MODE_OUTPUT,		ykp_set_cfgflag_PACING_20MS },
+	{ CFGFLAG_ALLOW_HIDTRIG,	"ALLOW_HIDTRIG",	0,		CAP_HIDTRIG,		MODE_OUTPUT,		ykp_set_cfgflag_ALLOW_HIDTRIG },
+	{ CFGFLAG_STATIC_TICKET,        "STATIC_TICKET",        "staticTicket", CAP_STATIC,		MODE_STATIC_TICKET,     ykp_set_cfgflag_STATIC_TICKET },
+	{ CFGFLAG_SHORT_TICKET,		"SHORT_TICKET",		"shortTicket",	CAP_STATIC_EXTRAS,	MODE_OUTPUT,		ykp_set_cfgflag_SHORT_TICKET },
+	{ CFGFLAG_STRONG_PW1,		"STRONG_PW1",		"strongPw1",	CAP_STATIC_EXTRAS,	MODE_STATIC_TICKET,	ykp_set_cfgflag_STRONG_PW1 },
+	{ CFGFLAG_STRONG_PW2,		"STRONG_PW2",		"strongPw2",	CAP_STATIC_EXTRAS,	MODE_STATIC_TICKET,	ykp_set_cfgflag_STRONG_PW2 },
+	{ CFGFLAG_MAN_UPDATE,		"MAN_UPDATE",		"manUpdate",	CAP_STATIC_EXTRAS,	MODE_STATIC_TICKET,	ykp_set_cfgflag_MAN_UPDATE },
 	{ 0, 0, 0, 0, 0, 0 }
 };
 
 struct map_st _extended_flags_map[] = {
-	{ EXTFLAG_SERIAL_BTN_VISIBLE,	"SERIAL_BTN_VISIBLE",	"serialBtnVisible",	capability_has_serial,		MODE_ALL,	ykp_set_extflag_SERIAL_BTN_VISIBLE },
-	{ EXTFLAG_SERIAL_USB_VISIBLE,	"SERIAL_USB_VISIBLE",	"serialUsbVisible",	capability_has_serial,		MODE_ALL,	ykp_set_extflag_SERIAL_USB_VISIBLE },
-	{ EXTFLAG_SERIAL_API_VISIBLE,	"SERIAL_API_VISIBLE",	"serialApiVisible",	capability_has_serial_api,	MODE_ALL,	ykp_set_extflag_SERIAL_API_VISIBLE },
-	{ EXTFLAG_USE_NUMERIC_KEYPAD,	"USE_NUMERIC_KEYPAD",	"useNumericKeypad",	capability_has_numeric,		MODE_ALL,	ykp_set_extflag_USE_NUMERIC_KEYPAD },
-	{ EXTFLAG_FAST_TRIG,		"FAST_TRIG",		"fastTrig",		capability_has_fast,		MODE_ALL,	ykp_set_extflag_FAST_TRIG },
-	{ EXTFLAG_ALLOW_UPDATE,		"ALLOW_UPDATE",		"allowUpdate",		capability_has_update,		MODE_ALL,	ykp_set_extflag_ALLOW_UPDATE },
-	{ EXTFLAG_DORMANT,		"DORMANT",		"dormant",		capability_has_dormant,		MODE_ALL,	ykp_set_extflag_DORMANT },
-	{ EXTFLAG_LED_INV,		"LED_INV",		"ledInverted",		capability_has_led_inv,		MODE_ALL,	ykp_set_extflag_LED_INV },
+	{ EXTFLAG_SERIAL_BTN_VISIBLE,	"SERIAL_BTN_VISIBLE",	"serialBtnVisible",	CAP_SERIAL,	MODE_ALL,	ykp_set_extflag_SERIAL_BTN_VISIBLE },
+	{ EXTFLAG_SERIAL_USB_VISIBLE,	"SERIAL_USB_VISIBLE",	"serialUsbVisible",	CAP_SERIAL,	MODE_ALL,	ykp_set_extflag_SERIAL_USB_VISIBLE },
+	{ EXTFLAG_SERIAL_API_VISIBLE,	"SERIAL_API_VISIBLE",	"serialApiVisible",	CAP_SERIAL_API,	MODE_ALL,	ykp_set_extflag_SERIAL_API_VISIBLE },
+	{ EXTFLAG_USE_NUMERIC_KEYPAD,	"USE_NUMERIC_KEYPAD",	"useNumericKeypad",	CAP_NUMERIC,	MODE_ALL,	ykp_set_extflag_USE_NUMERIC_KEYPAD },
+	{ EXTFLAG_FAST_TRIG,		"FAST_TRIG",		"fastTrig",		CAP_FAST,	MODE_ALL,	ykp_set_extflag_FAST_TRIG },
+	{ EXTFLAG_ALLOW_UPDATE,		"ALLOW_UPDATE",		"allowUpdate",		CAP_UPDATE,	MODE_ALL,	ykp_set_extflag_ALLOW_UPDATE },
+	{ EXTFLAG_DORMANT,		"DORMANT",		"dormant",		CAP_DORMANT,	MODE_ALL,	ykp_set_extflag_DORMANT },
+	{ EXTFLAG_LED_INV,		"LED_INV",		"ledInverted",		CAP_LED_INV,	MODE_ALL,	ykp_set_extflag_LED_INV },
 	{ 0, 0, 0, 0, 0, 0 }
 };
 
@@ -86,3 +93,146 @@ struct map_st _modes_map[] = {
 	{ MODE_OTP_YUBICO,	0,	"yubicoOTP",	0, 0, 0 },
 	{ 0, 0, 0, 0, 0, 0 }
 };
+
+#define CAPS_2_2	(CAP_STATIC | CAP_STATIC_EXTRAS | CAP_SLOT_TWO | \
+			 CAP_CHAL_RESP | CAP_OATH_IMF | CAP_SERIAL_API | \
+			 CAP_SERIAL | CAP_OATH | CAP_TICKET_MODS)
+#define CAPS_2_3	(CAPS_2_2 | CAP_UPDATE | CAP_FAST | CAP_NUMERIC | \
+			 CAP_DORMANT)
+
+const struct firmware_st _firmware_map[] = {
+	{ 3, 1, 0,	CAPS_2_3 | CAP_LED_INV },
+	{ 3, 0, 0,	CAPS_2_3 },
+	{ 2, 4, 0,	CAPS_2_3 | CAP_LED_INV },
+	{ 2, 3, 0,	CAPS_2_3 },
+	{ 2, 2, 0,	CAPS_2_2 },
+	/* the NEO is 2.1.4 and up, the beta (2.1.4) without static */
+	{ 2, 1, 7,	CAP_STATIC | CAP_STATIC_EXTRAS | CAP_OATH_IMF |
+			CAP_SERIAL_API | CAP_OATH | CAP_TICKET_MODS },
+	{ 2, 1, 5,	CAP_STATIC | CAP_STATIC_EXTRAS | CAP_SERIAL_API |
+			CAP_OATH | CAP_TICKET_MODS },
+	{ 2, 1, 4,	CAP_SERIAL_API | CAP_OATH | CAP_TICKET_MODS },
+	{ 2, 1, 0,	CAP_STATIC | CAP_STATIC_EXTRAS | CAP_SLOT_TWO |
+			CAP_OATH | CAP_TICKET_MODS },
+	{ 2, 0, 0,	CAP_STATIC | CAP_STATIC_EXTRAS | CAP_SLOT_TWO |
+			CAP_TICKET_MODS },
+	{ 1, 0, 0,	CAP_HIDTRIG | CAP_TICKET_FIRST | CAP_STATIC |
+			CAP_TICKET_MODS },
+	{ 0, 0, 0,	CAP_STATIC | CAP_TICKET_MODS },
+	{ 0, 0, 0, 0 }
+};
+
+static int _ykp_decode_mode(const YK_CONFIG *ycfg)
+{
+	if ((ycfg->tktFlags & TKTFLAG_OATH_HOTP) == TKTFLAG_OATH_HOTP) {
+		if ((ycfg->cfgFlags & CFGFLAG_CHAL_HMAC) == CFGFLAG_CHAL_HMAC)
+			return MODE_CHAL_HMAC;
+		if ((ycfg->cfgFlags & CFGFLAG_CHAL_YUBICO) == CFGFLAG_CHAL_YUBICO)
+			return MODE_CHAL_YUBICO;
+		return MODE_OATH_HOTP;
+	}
+	if ((ycfg->cfgFlags & CFGFLAG_STATIC_TICKET) == CFGFLAG_STATIC_TICKET)
+		return MODE_STATIC_TICKET;
+	return MODE_OTP_YUBICO;
+}
+
+/* Decode the flags and uid of a configuration into view.  It is
+ * decoded on every call, so it always matches the configuration and
+ * cfg is only read. */
+void _ykp_config_view(const YKP_CONFIG *cfg, struct ykp_view_st *view)
+{
+	const YK_CONFIG *ycfg = &cfg->ykcore_config;
+	int modhex;
+
+	view->mode = _ykp_decode_mode(ycfg);
+	/* OATH-HOTP and HMAC-SHA1 challenge response support 20 byte (160
+	 * bits) keys, holding the last four bytes in the uid field. */
+	view->key_length = (view->mode == MODE_OATH_HOTP ||
+			    view->mode == MODE_CHAL_HMAC) ? 20 : 16;
+
+	modhex = ycfg->cfgFlags & CFGFLAG_OATH_FIXED_MODHEX;
+	view->oath_id_modhex = 0;
+	if (modhex)
+		view->oath_id_modhex |= VIEW_FIXED_VENDOR;
+	if (modhex & CFGFLAG_OATH_FIXED_MODHEX2)
+		view->oath_id_modhex |= VIEW_FIXED_TYPE;
+	if (modhex == CFGFLAG_OATH_FIXED_MODHEX)
+		view->oath_id_modhex |= VIEW_FIXED_MUI;
+
+	/* IMF/16 is 16 bits stored big-endian in uid[4] */
+	view->oath_imf =
+		(unsigned long)((ycfg->uid[4] << 8) | ycfg->uid[5]) << 4;
+}
+
+/* The mode a configuration is in, one of the MODE_* values. */
+int _ykp_config_mode(const YKP_CONFIG *cfg)
+{
+	return _ykp_decode_mode(&cfg->ykcore_config);
+}
+
+/* yubikey_crc16() a byte at a time rather than a bit, the crc is most of
+ * the cost of reading a journal entry or record. */
+static const unsigned short _crc16_table[256] = {
+	0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+	0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+	0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+	0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+	0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+	0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+	0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+	0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+	0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+	0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+	0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+	0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+	0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+	0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+	0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+	0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+	0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+	0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+	0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+	0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+	0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+	0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+	0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+	0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+	0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+	0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+	0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+	0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+	0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+	0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+	0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+	0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78,
+};
+
+unsigned short _ykp_crc16(const unsigned char *buf, size_t len)
+{
+	unsigned short crc = 0xffff;
+
+	while (len--)
+		crc = (crc >> 8) ^ _crc16_table[(crc ^ *buf++) & 0xff];
+	return crc;
+}
+
+/* Flush fd to disk, the data at least. */
+int _ykp_file_sync(int fd)
+{
+#ifdef _WIN32
+	return _commit(fd);
+#elif defined(HAVE_FDATASYNC)
+	return fdatasync(fd);
+#else
+	return fsync(fd);
+#endif
+}
+
+int _ykp_file_truncate(int fd, size_t size)
+{
+#ifdef _WIN32
+	return _chsize_s(fd, (__int64)size) == 0 ? 0 : -1;
+#else
+	return ftruncate(fd, (off_t)size);
+#endif
+}
@@ -38,6 +38,19 @@
 extern "C" {
 # endif
 
+/* What the flags and uid of a configuration decode to, see
+ * _ykp_config_view(). */
+struct ykp_view_st {
+	unsigned char mode;		/* MODE_* */
+	unsigned char key_length;	/* 16, or 20 with four bytes in uid */
+	unsigned char oath_id_modhex;	/* VIEW_FIXED_* parts of the OATH id in modhex */
+	unsigned long oath_imf;		/* whatever the firmware */
+};
+
+#define VIEW_FIXED_VENDOR	0x01	/* fixed[0] */
+#define VIEW_FIXED_TYPE		0x02	/* fixed[1] */
+#define VIEW_FIXED_MUI		0x04	/* fixed[2..5] */
+
 struct ykp_config_t {
 	unsigned int yk_major_version;
 	unsigned int yk_minor_version;
@@ -47,6 +60,9 @@ struct ykp_config_t {
 	YK_CONFIG ykcore_config;
 
 	unsigned int ykp_acccode_type;
+
+	/* CAP_* bits for the firmware version, see _ykp_set_capabilities() */
+	unsigned int capabilities;
 };
 
 extern bool capability_has_hidtrig(const YKP_CONFIG *cfg);
@@ -66,11 +82,33 @@ extern bool capability_has_numeric(const YKP_CONFIG *cfg);
 extern bool capability_has_dormant(const YKP_CONFIG *cfg);
 extern bool capability_has_led_inv(const YKP_CONFIG *cfg);
 
+/* What the firmware a configuration is for can do, one CAP_* bit for
+ * each capability_has_*().  Set from _firmware_map whenever the version
+ * of a configuration is set. */
+extern void _ykp_set_capabilities(YKP_CONFIG *cfg);
+
+#define CAP_HIDTRIG		0x0001
+#define CAP_TICKET_FIRST	0x0002
+#define CAP_STATIC		0x0004
+#define CAP_STATIC_EXTRAS	0x0008
+#define CAP_SLOT_TWO		0x0010
+#define CAP_CHAL_RESP		0x0020
+#define CAP_OATH_IMF		0x0040
+#define CAP_SERIAL_API		0x0080
+#define CAP_SERIAL		0x0100
+#define CAP_OATH		0x0200
+#define CAP_TICKET_MODS		0x0400
+#define CAP_UPDATE		0x0800
+#define CAP_FAST		0x1000
+#define CAP_NUMERIC		0x2000
+#define CAP_DORMANT		0x4000
+#define CAP_LED_INV		0x8000
+
 struct map_st {
 	uint8_t flag;
 	const char *flag_text;
 	const char *json_text;
-	bool (*capability)(const YKP_CONFIG *cfg);
+	unsigned int capability;	/* CAP_* */
 	unsigned char mode;
 	int (*setter)(YKP_CONFIG *cfg, bool state);
 };
@@ -80,6 +118,18 @@ extern struct map_st _config_flags_map[];
 extern struct map_st _extended_flags_map[];
 extern struct map_st _modes_map[];
 
+/* The capabilities of firmware versions, newest first, each entry
+ * holding from its version up to the one before it.  Supporting a new
+ * firmware is adding an entry. */
+struct firmware_st {
+	unsigned int major;
+	unsigned int minor;
+	unsigned int build;
+	unsigned int capabilities;
+};
+
+extern const struct firmware_st _firmware_map[];
+
 #define MODE_CHAL_HMAC		0x01
 #define MODE_OATH_HOTP		0x02
 #define MODE_OTP_YUBICO		0x04
@@ -90,6 +140,14 @@ extern struct map_st _modes_map[];
 #define MODE_OUTPUT 		MODE_STATIC_TICKET | MODE_OTP_YUBICO | MODE_OATH_HOTP
 #define MODE_ALL		0xff
 
+extern void _ykp_config_view(const YKP_CONFIG *cfg, struct ykp_view_st *view);
+extern int _ykp_config_mode(const YKP_CONFIG *cfg);
+
+/* Shared by the journal and the record files. */
+extern unsigned short _ykp_crc16(const unsigned char *buf, size_t len);
+extern int _ykp_file_sync(int fd);
+extern int _ykp_file_truncate(int fd, size_t size);
+
 # ifdef __cplusplus
 }
 # endif
@@ -45,7 +45,12 @@
 int main(int argc, char **argv)
 {
 	FILE *inf = NULL; const char *infname = NULL;
+	YKP_BUNDLE *bundle = NULL; unsigned long bundle_index = 0;
+	bool bundle_index_set = false;
 	FILE *outf = NULL; const char *outfname = NULL;
+	YKP_JOURNAL *journal = NULL; const char *journalname = NULL;
+	int journal_flags = 0;
+	unsigned int serial = 0;
 	int data_format = YKP_FORMAT_LEGACY;
 	bool verbose = false;
 	unsigned char access_code[256];
@@ -89,6 +94,23 @@ int main(int argc, char **argv)
 			case 'N':
 				key_index = atoi(optarg);
 				break;
+			case 'j':
+				journalname = optarg;
+				break;
+			case 'I': {
+				char *end;
+				bundle_index = strtoul(optarg, &end, 10);
+				if (*optarg == '\0' || *optarg == '-' || *end != '\0') {
+					fprintf(stderr, "Invalid configuration index: %s\n", optarg);
+					exit(1);
+				}
+				bundle_index_set = true;
+				break;
+			}
+			case 'a':
+				/* compare secrets only when they are not random */
+				journal_flags = YKP_FINGERPRINT_SECRETS;
+				break;
 			case 'V':
 				fputs(YKPERS_VERSION_STRING "\n", stderr);
 				return 0;
@@ -97,6 +119,7 @@ int main(int argc, char **argv)
 					case 'S':
 						continue;
 					case 'a':
+						journal_flags = YKP_FINGERPRINT_SECRETS;
 						continue;
 					case 'c':
 						continue;
@@ -214,14 +237,52 @@ int main(int argc, char **argv)
 		}
 	}
 
+	if (journalname) {
+		if (zap || (ykp_command(cfg) != SLOT_CONFIG &&
+			    ykp_command(cfg) != SLOT_CONFIG2)) {
+			fprintf(stderr, "Journal (-j) can only be used when configuring a slot (-1 / -2).\n");
+			exit_code = 1;
+			goto err;
+		}
+		if (!yk_get_serial(yk, 0, 0, &serial)) {
+			fprintf(stderr, "Failed to read serial number, needed for journal (-j).\n");
+			exit_code = 1;
+			goto err;
+		}
+		if (!(journal = ykp_journal_open(journalname))) {
+			fprintf(stderr,
+				"Couldn't open journal %s: %s\n",
+				journalname,
+				strerror(errno));
+			exit_code = 1;
+			goto err;
+		}
+	}
+
 	printf ("\n");
 
+	if (bundle_index_set && (!infname || strcmp(infname, "-") == 0 ||
+				 data_format != YKP_FORMAT_YCFG)) {
+		fprintf(stderr, "Configuration index (-I) needs a ycfg file (-i, -fycfg).\n");
+		exit_code = 1;
+		goto err;
+	}
+
 	if (infname) {
 		if (strcmp(infname, "-") == 0)
 			inf = stdin;
-		else
+		else if (data_format == YKP_FORMAT_YCFG) {
+			if (!(bundle = ykp_bundle_open(infname))) {
+				fprintf(stderr,
+					"Couldn't open %s for reading: %s\n",
+					infname,
+					strerror(errno));
+				exit_code = 1;
+				goto err;
+			}
+		} else
 			inf = fopen(infname, "r");
-		if (inf == NULL) {
+		if (inf == NULL && bundle == NULL) {
 			fprintf(stderr,
 				"Couldn't open %s for reading: %s\n",
 				infname,
@@ -245,12 +306,24 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (inf) {
+	if (bundle) {
+		if(!ykp_clear_config(cfg))
+			goto err;
+		if (!ykp_bundle_get(bundle, bundle_index, cfg)) {
+			if (bundle_index >= ykp_bundle_count(bundle))
+				fprintf(stderr, "%s holds %lu configuration(s), no index %lu\n",
+					infname, (unsigned long)ykp_bundle_count(bundle),
+					bundle_index);
+			goto err;
+		}
+	} else if (inf) {
+		size_t n;
 		if(!ykp_clear_config(cfg))
 			goto err;
-		if(!fread(data, 1, 1024, inf))
+		if(!(n = fread(data, 1, sizeof(data) - 1, inf)))
 			goto err;
-		if (!ykp_import_config(cfg, data, strlen(data), data_format))
+		data[n] = '\0';
+		if (!ykp_import_config(cfg, data, n, data_format))
 			goto err;
 	}
 	if (outf) {
@@ -263,6 +336,15 @@ int main(int argc, char **argv)
 	} else {
 		char commitbuf[256]; size_t commitlen;
 
+		if (journal && ykp_journal_is_current(journal, serial, cfg, st,
+						      journal_flags)) {
+			fprintf(stderr, "Configuration %d of key %u is already up to date according to the journal\n",
+				ykp_config_num(cfg), serial);
+			exit_code = 0;
+			error = false;
+			goto err;
+		}
+
 		if (ykp_command(cfg) == SLOT_SWAP) {
 			fprintf(stderr, "Configuration in slot 1 and 2 will be swapped\n");
 		} else if(ykp_command(cfg) == SLOT_NDEF || ykp_command(cfg) == SLOT_NDEF2) {
@@ -412,6 +494,14 @@ int main(int argc, char **argv)
 						printf(" failure\n");
 					goto err;
 				}
+				if (journal) {
+					if (!yk_get_status(yk, st) ||
+					    !ykp_journal_record(journal, serial, cfg, st)) {
+						if (verbose)
+							printf(" failure to record in journal\n");
+						goto err;
+					}
+				}
 			}
 
 			if (verbose && !dry_run)
@@ -431,8 +521,14 @@ err:
 		free(st);
 	if (inf)
 		fclose(inf);
+	if (bundle)
+		ykp_bundle_close(bundle);
 	if (outf)
 		fclose(outf);
+	if (journal && !ykp_journal_close(journal)) {
+		report_yk_error();
+		exit_code = 2;
+	}
 
 	if (yk && !yk_close_key(yk)) {
 		report_yk_error();